@@ -0,0 +1,269 @@
+// Scene layout benchmark: the CPU side of a frame for N objects, once with
+// objects stored the way Scene stored them before EntityPool (a vector of
+// individually allocated objects, each holding its model path string, model
+// pointer and transform, allocated between other heap blocks as they are when
+// models load over time) and once with EntityPool. Both run the passes
+// Scene::render runs before issuing GL calls: transform (TransformBatch),
+// visibility and level of detail, and draw-list build (stable sort by
+// shader permutation). The old layout had no object culling; EntityPool
+// culls world bounds against the frustum, so each size is measured with the
+// camera seeing every object and with a close camera seeing a fraction.
+// No GPU needed.
+//
+// Usage: EntityBench [--frames <f>] [--objects <n>]
+
+#include "scene/EntityPool.hpp"
+#include "scene/SceneObject.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int MODEL_COUNT = 8;
+const float WORLD_SIZE = 2000.0f;
+
+// Stand-in for Model: bounds and the permutations its sub-meshes need
+struct BenchModel {
+    EntityBounds bounds;
+    std::vector<uint32_t> features;
+};
+
+// SceneObject's members as Scene held them
+struct LegacyObject {
+    std::string modelPath;
+    std::shared_ptr<BenchModel> model;
+    bool compactVertices = false;
+    bool meshletsEnabled = false;
+    float position[3];
+    float scale[3];
+    float rotation[4];
+    size_t lod = 0;
+};
+
+struct PassTimes {
+    double transform = 0.0;
+    double visibility = 0.0;
+    double drawList = 0.0;
+    size_t visible = 0;
+};
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Column-major perspective looking from eye towards the world origin, projection * view
+void makeViewProjection(const float* eye, float* out) {
+    float forward[3] = {-eye[0], -eye[1], -eye[2]};
+    float length = std::sqrt(forward[0] * forward[0] + forward[1] * forward[1] + forward[2] * forward[2]);
+    for (float& f : forward) f /= length;
+    float right[3] = {-forward[2], 0.0f, forward[0]};
+    length = std::sqrt(right[0] * right[0] + right[2] * right[2]);
+    right[0] /= length;
+    right[2] /= length;
+    float up[3] = {right[1] * forward[2] - right[2] * forward[1], right[2] * forward[0] - right[0] * forward[2],
+                   right[0] * forward[1] - right[1] * forward[0]};
+    float view[16] = {right[0], up[0], -forward[0], 0, right[1], up[1], -forward[1], 0,
+                      right[2], up[2], -forward[2], 0, 0, 0, 0, 1};
+    for (int row = 0; row < 3; row++) {
+        view[12 + row] = -(view[row] * eye[0] + view[4 + row] * eye[1] + view[8 + row] * eye[2]);
+    }
+    float f = 1.0f / std::tan(0.5f * 45.0f * 3.14159265359f / 180.0f);
+    float nearPlane = 0.1f, farPlane = 5000.0f;
+    float projection[16] = {f / (4.0f / 3.0f), 0, 0, 0, 0, f, 0, 0,
+                            0, 0, (farPlane + nearPlane) / (nearPlane - farPlane), -1,
+                            0, 0, 2.0f * farPlane * nearPlane / (nearPlane - farPlane), 0};
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; k++) {
+                sum += projection[k * 4 + row] * view[col * 4 + k];
+            }
+            out[col * 4 + row] = sum;
+        }
+    }
+}
+
+void sortDrawItems(std::vector<std::pair<uint32_t, size_t>>& items) {
+    std::stable_sort(items.begin(), items.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+}
+
+// The frame as Scene ran it over std::vector<std::unique_ptr<SceneObject>>
+PassTimes runLegacy(const std::vector<std::unique_ptr<LegacyObject>>& objects, const float* viewProjection,
+                    const float* eye, TransformBatch& batch, std::vector<std::pair<uint32_t, size_t>>& items) {
+    PassTimes times;
+    auto start = std::chrono::steady_clock::now();
+    batch.clear();
+    for (const auto& obj : objects) {
+        float rotation[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+        batch.add(obj->position, rotation, obj->scale);
+    }
+    batch.compute(viewProjection);
+    times.transform = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    for (const auto& obj : objects) {
+        // The world bounds SceneObject computed: the model's bounds moved by the object's scale and position
+        const EntityBounds& local = obj->model->bounds;
+        float worldMin[3], worldMax[3];
+        for (int k = 0; k < 3; k++) {
+            float center = (local.min[k] + local.max[k]) * 0.5f;
+            float half = (local.max[k] - local.min[k]) * 0.5f * obj->scale[k];
+            worldMin[k] = center * obj->scale[k] + obj->position[k] - half;
+            worldMax[k] = center * obj->scale[k] + obj->position[k] + half;
+        }
+        float maxScale = std::max({std::fabs(obj->scale[0]), std::fabs(obj->scale[1]), std::fabs(obj->scale[2])});
+        float pixelsPerUnit = SceneObject::getPixelsPerUnit(worldMin, worldMax, maxScale, eye, 480.0f);
+        obj->lod = pixelsPerUnit < 1.0f ? 1 : 0;
+    }
+    times.visibility = elapsedMs(start);
+    times.visible = objects.size();
+
+    start = std::chrono::steady_clock::now();
+    items.clear();
+    for (size_t i = 0; i < objects.size(); i++) {
+        for (uint32_t features : objects[i]->model->features) {
+            items.emplace_back(features, i);
+        }
+    }
+    sortDrawItems(items);
+    times.drawList = elapsedMs(start);
+    return times;
+}
+
+// The same frame over EntityPool
+PassTimes runPool(EntityPool& pool, const std::vector<std::shared_ptr<BenchModel>>& models,
+                  const float* viewProjection, const float* eye, std::vector<uint32_t>& visible,
+                  std::vector<std::pair<uint32_t, size_t>>& items) {
+    PassTimes times;
+    auto start = std::chrono::steady_clock::now();
+    // Every object moves each frame, so the whole pool is dirty, as the old layout assumed
+    const float noRotation[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    for (size_t i = 0; i < pool.size(); i++) {
+        float position[3], rotation[4], scale[3];
+        EntityHandle handle = pool.getHandle(i);
+        pool.getTransform(handle, position, rotation, scale);
+        pool.setTransform(handle, position, noRotation, scale);
+    }
+    pool.updateWorld();
+    times.transform = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    pool.cull(viewProjection, visible);
+    pool.updateClipMatrices(viewProjection, visible);
+    for (uint32_t i : visible) {
+        const EntityBounds& bounds = pool.getWorldBounds(i);
+        float pixelsPerUnit = SceneObject::getPixelsPerUnit(bounds.min, bounds.max, pool.getMaxScale(i), eye,
+                                                            480.0f);
+        pool.setLod(i, pixelsPerUnit < 1.0f ? 1 : 0);
+    }
+    times.visibility = elapsedMs(start);
+    times.visible = visible.size();
+
+    start = std::chrono::steady_clock::now();
+    items.clear();
+    for (size_t v = 0; v < visible.size(); v++) {
+        for (uint32_t features : models[pool.getRenderId(visible[v])]->features) {
+            items.emplace_back(features, v);
+        }
+    }
+    sortDrawItems(items);
+    times.drawList = elapsedMs(start);
+    return times;
+}
+
+void printTimes(const char* label, const PassTimes& times, int frames) {
+    double transform = times.transform / frames;
+    double visibility = times.visibility / frames;
+    double drawList = times.drawList / frames;
+    std::printf("    %-12s %9.3f ms/frame  (transform %8.3f, visibility+LOD %8.3f, draw list %8.3f)  %zu visible\n",
+                label, transform + visibility + drawList, transform, visibility, drawList, times.visible);
+}
+
+void addTimes(PassTimes& total, const PassTimes& frame) {
+    total.transform += frame.transform;
+    total.visibility += frame.visibility;
+    total.drawList += frame.drawList;
+    total.visible = frame.visible;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int frames = 10;
+    std::vector<size_t> counts = {10000, 100000, 1000000};
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--objects") == 0 && i + 1 < argc) {
+            counts = {static_cast<size_t>(std::atoll(argv[++i]))};
+        }
+    }
+
+    std::mt19937 rng(11);
+    std::vector<std::shared_ptr<BenchModel>> models;
+    for (int m = 0; m < MODEL_COUNT; m++) {
+        auto model = std::make_shared<BenchModel>();
+        model->bounds = {{-1.0f, -0.5f, -1.0f}, {1.0f, 0.5f + m * 0.25f, 1.0f}};
+        model->features = {static_cast<uint32_t>(m % 4)};
+        if (m % 3 == 0) {
+            model->features.push_back(static_cast<uint32_t>((m + 1) % 4));
+        }
+        models.push_back(model);
+    }
+
+    for (size_t count : counts) {
+        std::uniform_real_distribution<float> spread(-WORLD_SIZE * 0.5f, WORLD_SIZE * 0.5f);
+        std::uniform_real_distribution<float> size(0.5f, 3.0f);
+        std::uniform_int_distribution<int> pick(0, MODEL_COUNT - 1);
+        std::uniform_int_distribution<size_t> fillerSize(16, 512);
+
+        // Objects interleaved with other allocations, as when models and their buffers load between them
+        std::vector<std::unique_ptr<LegacyObject>> objects;
+        std::vector<std::unique_ptr<char[]>> filler;
+        EntityPool pool;
+        const float noRotation[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+        for (size_t i = 0; i < count; i++) {
+            filler.emplace_back(new char[fillerSize(rng)]);
+            auto obj = std::make_unique<LegacyObject>();
+            int m = pick(rng);
+            obj->modelPath = "models/props/prop_" + std::to_string(m) + "/prop.blend1.obj";
+            obj->model = models[m];
+            float s = size(rng);
+            obj->position[0] = spread(rng);
+            obj->position[1] = 0.0f;
+            obj->position[2] = spread(rng);
+            obj->scale[0] = obj->scale[1] = obj->scale[2] = s;
+            std::memcpy(obj->rotation, noRotation, sizeof(noRotation));
+            pool.create(obj->position, noRotation, obj->scale, models[m]->bounds, static_cast<uint32_t>(m));
+            objects.push_back(std::move(obj));
+        }
+
+        std::printf("%zu objects, %d frames\n", count, frames);
+        const float eyes[2][3] = {{0.0f, WORLD_SIZE * 1.2f, WORLD_SIZE * 1.2f}, {0.0f, 40.0f, 400.0f}};
+        const char* views[2] = {"every object in view", "close camera"};
+        TransformBatch batch;
+        std::vector<uint32_t> visible;
+        std::vector<std::pair<uint32_t, size_t>> items;
+        for (int v = 0; v < 2; v++) {
+            float viewProjection[16];
+            makeViewProjection(eyes[v], viewProjection);
+            PassTimes legacy, pooled;
+            for (int frame = 0; frame < frames; frame++) {
+                addTimes(legacy, runLegacy(objects, viewProjection, eyes[v], batch, items));
+                addTimes(pooled, runPool(pool, models, viewProjection, eyes[v], visible, items));
+            }
+            std::printf("  %s\n", views[v]);
+            printTimes("pointers", legacy, frames);
+            printTimes("EntityPool", pooled, frames);
+        }
+    }
+    return 0;
+}
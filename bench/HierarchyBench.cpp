@@ -0,0 +1,105 @@
+// Transform hierarchy benchmark: N rigs of RIG_SIZE entities (a root with
+// three chains of bones below it) in an EntityPool. Each frame a fraction of
+// the rigs moves their root, and EntityPool::updateWorld recomputes only
+// those rigs, parents before children. The same frame with every rig marked
+// dirty is what a pool without dirty tracking pays whether or not anything
+// moved. No GPU needed.
+//
+// Usage: HierarchyBench [--rigs <n>] [--frames <f>]
+
+#include "scene/EntityPool.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+const int CHAINS = 3;
+const int CHAIN_LENGTH = 5;
+const int RIG_SIZE = 1 + CHAINS * CHAIN_LENGTH;
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Turns a rig's root about Y by the frame's angle
+void moveRoot(EntityPool& pool, EntityHandle root, int frame) {
+    float position[3], rotation[4], scale[3];
+    pool.getTransform(root, position, rotation, scale);
+    float halfAngle = 0.01f * frame;
+    rotation[0] = rotation[2] = 0.0f;
+    rotation[1] = std::sin(halfAngle);
+    rotation[3] = std::cos(halfAngle);
+    pool.setTransform(root, position, rotation, scale);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int rigCount = 20000;
+    int frames = 20;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--rigs") == 0 && i + 1 < argc) {
+            rigCount = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        }
+    }
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> spread(-500.0f, 500.0f);
+    EntityPool pool;
+    std::vector<EntityHandle> roots;
+    const EntityBounds bounds = {{-0.1f, 0.0f, -0.1f}, {0.1f, 1.0f, 0.1f}};
+    const float noRotation[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    const float unitScale[3] = {1.0f, 1.0f, 1.0f};
+    for (int r = 0; r < rigCount; r++) {
+        float position[3] = {spread(rng), 0.0f, spread(rng)};
+        EntityHandle root = pool.create(position, noRotation, unitScale, bounds, 0);
+        roots.push_back(root);
+        for (int c = 0; c < CHAINS; c++) {
+            // Each bone sits at the end of its parent, bent a little about Z
+            float halfAngle = 0.2f * (c - 1);
+            float bend[4] = {0.0f, 0.0f, std::sin(halfAngle), std::cos(halfAngle)};
+            float offset[3] = {0.0f, 1.0f, 0.0f};
+            EntityHandle parent = root;
+            for (int b = 0; b < CHAIN_LENGTH; b++) {
+                parent = pool.create(offset, bend, unitScale, bounds, 0, parent);
+            }
+        }
+    }
+    pool.updateWorld();
+    std::printf("%d rigs of %d entities (%zu entities), %d frames\n", rigCount, RIG_SIZE, pool.size(), frames);
+
+    const float fractions[] = {0.0f, 0.01f, 0.1f, 1.0f};
+    double allDirtyMs = 0.0;
+    for (int pass = -1; pass < 4; pass++) {
+        // Pass -1 marks every rig dirty, as a pool without dirty tracking would treat them
+        float fraction = pass < 0 ? 1.0f : fractions[pass];
+        size_t moving = static_cast<size_t>(rigCount * fraction);
+        size_t updated = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++) {
+            size_t first = (static_cast<size_t>(frame) * moving) % roots.size();
+            for (size_t m = 0; m < moving; m++) {
+                moveRoot(pool, roots[(first + m) % roots.size()], frame);
+            }
+            updated += pool.updateWorld();
+        }
+        double ms = elapsedMs(start) / frames;
+        if (pass < 0) {
+            allDirtyMs = ms;
+            std::printf("  %-18s %8.3f ms/frame, %9zu entities updated/frame\n", "all dirty", ms, updated / frames);
+        } else {
+            char label[32];
+            std::snprintf(label, sizeof(label), "%g%% of rigs move", fraction * 100.0f);
+            std::printf("  %-18s %8.3f ms/frame, %9zu entities updated/frame", label, ms, updated / frames);
+            std::printf(updated > 0 ? ", %.1fx vs all dirty\n" : "\n", allDirtyMs / ms);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+// Parallel OBJ loading benchmark: parse + weld with 1..16 threads, checking
+// that every run produces exactly the same vertices and indices as the
+// serial loader.
+//
+// Usage: ObjParallelBench [file.obj] [--grid <megabytes>]
+
+#include "core/ThreadPool.hpp"
+#include "models/ObjParser.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string generateGrid(size_t megabytes) {
+    const char* tmp = std::getenv("TMPDIR");
+    std::string path = std::string(tmp ? tmp : "/tmp") + "/objparallelbench_grid.obj";
+
+    // Each grid vertex costs roughly 150 bytes of text (v, vt, vn and one quad)
+    size_t side = 2;
+    while ((side + 1) * (side + 1) * 150 < megabytes * 1024 * 1024) side++;
+
+    std::ofstream out(path);
+    char buffer[256];
+    for (size_t z = 0; z < side; z++) {
+        for (size_t x = 0; x < side; x++) {
+            float height = 0.5f * static_cast<float>((x * 7 + z * 13) % 17) / 17.0f;
+            std::snprintf(buffer, sizeof(buffer), "v %f %f %f\nvt %f %f\nvn 0.000000 1.000000 0.000000\n",
+                          static_cast<float>(x), height, static_cast<float>(z),
+                          static_cast<float>(x) / side, static_cast<float>(z) / side);
+            out << buffer;
+        }
+    }
+    // Use relative indices on odd rows to exercise the prefix-sum fix-up
+    for (size_t z = 0; z + 1 < side; z++) {
+        for (size_t x = 0; x + 1 < side; x++) {
+            size_t a = z * side + x + 1;
+            size_t b = a + 1;
+            size_t c = a + side + 1;
+            size_t d = a + side;
+            if (z % 2 == 0) {
+                std::snprintf(buffer, sizeof(buffer), "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n",
+                              a, a, a, b, b, b, c, c, c, d, d, d);
+            } else {
+                long long count = static_cast<long long>(side * side) + 1;
+                long long ra = static_cast<long long>(a) - count, rb = static_cast<long long>(b) - count;
+                long long rc = static_cast<long long>(c) - count, rd = static_cast<long long>(d) - count;
+                std::snprintf(buffer, sizeof(buffer), "f %lld/%lld/%lld %lld/%lld/%lld %lld/%lld/%lld %lld/%lld/%lld\n",
+                              ra, ra, ra, rb, rb, rb, rc, rc, rc, rd, rd, rd);
+            }
+            out << buffer;
+        }
+    }
+    return path;
+}
+
+struct Result {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    double parseMs = 0.0;
+    double weldMs = 0.0;
+};
+
+Result load(const std::string& path, ThreadPool* pool) {
+    Result result;
+    ObjData data;
+    if (pool) {
+        ObjParser::parseFileParallel(path, data, *pool);
+    } else {
+        ObjParser::parseFile(path, data);
+    }
+    result.parseMs = data.parseTimeMs;
+    result.weldMs = ObjParser::buildMesh(data, result.vertices, result.indices, pool).timeMs;
+    return result;
+}
+
+bool identical(const Result& a, const Result& b) {
+    return a.vertices.size() == b.vertices.size() && a.indices == b.indices &&
+           std::memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(Vertex)) == 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string path = "models/mountain/mount.blend1.obj";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--grid" && i + 1 < argc) {
+            path = generateGrid(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            path = arg;
+        }
+    }
+
+    Result serial = load(path, nullptr);
+    double serialMs = serial.parseMs + serial.weldMs;
+    std::cout << path << ": " << serial.vertices.size() << " vertices, "
+              << serial.indices.size() << " indices" << std::endl;
+    std::cout << "  serial:     parse " << serial.parseMs << " ms, weld " << serial.weldMs << " ms" << std::endl;
+
+    for (size_t threads : {1, 2, 4, 8, 16}) {
+        ThreadPool pool(threads);
+        Result parallel = load(path, &pool);
+        double totalMs = parallel.parseMs + parallel.weldMs;
+        std::cout << "  " << threads << " threads: parse " << parallel.parseMs << " ms, weld "
+                  << parallel.weldMs << " ms, speedup " << serialMs / totalMs << "x, "
+                  << (identical(serial, parallel) ? "identical" : "MISMATCH") << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,175 @@
+// Parse-throughput benchmark: compares the original getline/istringstream OBJ
+// parsing with the mapped ObjParser tokenizer.
+//
+// Usage: ObjParseBench [file.obj ...] [--grid <megabytes>]
+//   --grid generates a synthetic terrain grid OBJ of roughly the given size
+//   in the system temp directory and benchmarks it as well.
+
+#include "models/ObjParser.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The parsing half of the original Model::parseOBJ, kept as the baseline
+size_t parseLegacy(const std::string& filepath) {
+    std::ifstream file(filepath);
+    if (!file.is_open()) return 0;
+
+    std::vector<float> positions;
+    std::vector<float> normals;
+    std::vector<float> texCoords;
+    std::vector<std::string> faces;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream iss(line);
+        std::string type;
+        iss >> type;
+
+        if (type == "v") {
+            float x, y, z;
+            if (iss >> x >> y >> z) {
+                positions.push_back(x);
+                positions.push_back(y);
+                positions.push_back(z);
+            }
+        } else if (type == "vn") {
+            float x, y, z;
+            if (iss >> x >> y >> z) {
+                normals.push_back(x);
+                normals.push_back(y);
+                normals.push_back(z);
+            }
+        } else if (type == "vt") {
+            float u, v;
+            if (iss >> u >> v) {
+                texCoords.push_back(u);
+                texCoords.push_back(v);
+            }
+        } else if (type == "f") {
+            faces.push_back(line);
+        }
+    }
+
+    size_t corners = 0;
+    for (const auto& face : faces) {
+        std::istringstream iss(face);
+        std::string type;
+        iss >> type;
+
+        std::string vertex;
+        size_t faceCorners = 0;
+        while (iss >> vertex) {
+            unsigned int posIdx = 0, texIdx = 0, normIdx = 0;
+            size_t firstSlash = vertex.find('/');
+            if (firstSlash != std::string::npos) {
+                posIdx = std::stoul(vertex.substr(0, firstSlash)) - 1;
+                size_t secondSlash = vertex.find('/', firstSlash + 1);
+                if (secondSlash != std::string::npos) {
+                    if (secondSlash > firstSlash + 1) {
+                        texIdx = std::stoul(vertex.substr(firstSlash + 1, secondSlash - firstSlash - 1)) - 1;
+                    }
+                    normIdx = std::stoul(vertex.substr(secondSlash + 1)) - 1;
+                } else {
+                    texIdx = std::stoul(vertex.substr(firstSlash + 1)) - 1;
+                }
+            } else {
+                posIdx = std::stoul(vertex) - 1;
+            }
+            (void)posIdx; (void)texIdx; (void)normIdx;
+            faceCorners++;
+        }
+        if (faceCorners >= 3) {
+            corners += (faceCorners - 2) * 3;
+        }
+    }
+    return corners;
+}
+
+std::string generateGrid(size_t megabytes) {
+    const char* tmp = std::getenv("TMPDIR");
+    std::string path = std::string(tmp ? tmp : "/tmp") + "/objparsebench_grid.obj";
+
+    // Each grid vertex costs roughly 130 bytes of text (v, vt, vn and one quad)
+    size_t side = 2;
+    while ((side + 1) * (side + 1) * 130 < megabytes * 1024 * 1024) side++;
+
+    std::ofstream out(path);
+    char buffer[256];
+    for (size_t z = 0; z < side; z++) {
+        for (size_t x = 0; x < side; x++) {
+            float height = 0.5f * static_cast<float>((x * 7 + z * 13) % 17) / 17.0f;
+            std::snprintf(buffer, sizeof(buffer), "v %f %f %f\nvt %f %f\nvn 0.000000 1.000000 0.000000\n",
+                          static_cast<float>(x), height, static_cast<float>(z),
+                          static_cast<float>(x) / side, static_cast<float>(z) / side);
+            out << buffer;
+        }
+    }
+    for (size_t z = 0; z + 1 < side; z++) {
+        for (size_t x = 0; x + 1 < side; x++) {
+            size_t a = z * side + x + 1;
+            size_t b = a + 1;
+            size_t c = a + side + 1;
+            size_t d = a + side;
+            std::snprintf(buffer, sizeof(buffer), "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n",
+                          a, a, a, b, b, b, c, c, c, d, d, d);
+            out << buffer;
+        }
+    }
+    return path;
+}
+
+void benchmark(const std::string& path) {
+    auto start = std::chrono::steady_clock::now();
+    size_t legacyCorners = parseLegacy(path);
+    double legacyMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+
+    ObjData data;
+    start = std::chrono::steady_clock::now();
+    if (!ObjParser::parseFile(path, data)) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return;
+    }
+    double mappedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+
+    double megabytes = data.bytes / (1024.0 * 1024.0);
+    std::cout << path << " (" << megabytes << " MB)" << std::endl;
+    std::cout << "  legacy:  " << legacyMs << " ms, " << megabytes / (legacyMs / 1000.0) << " MB/s, "
+              << legacyCorners << " corners" << std::endl;
+    std::cout << "  mapped:  " << mappedMs << " ms, " << megabytes / (mappedMs / 1000.0) << " MB/s, "
+              << data.corners.size() << " corners" << std::endl;
+    std::cout << "  speedup: " << legacyMs / mappedMs << "x" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--grid" && i + 1 < argc) {
+            files.push_back(generateGrid(std::strtoul(argv[++i], nullptr, 10)));
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty()) {
+        files.push_back("models/mountain/mount.blend1.obj");
+    }
+
+    for (const auto& file : files) {
+        benchmark(file);
+    }
+    return 0;
+}
@@ -0,0 +1,195 @@
+// Texture bind benchmark: draws N small objects, each using one of K
+// textures, the way Model::render did before atlases (bind, draw, unbind per
+// object) and with every texture merged into a TextureAtlas (one bind per
+// frame, per-object layer and UV transform uniforms). Reports the bind calls
+// and CPU submission time per frame. Textures are the same size unless
+// --mixed is given, which exercises the packed fallback. Needs a GL 3.3
+// context; the window stays hidden.
+//
+// Usage: TextureBindBench [--objects <n>] [--textures <k>] [--frames <f>] [--mixed]
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include "core/MipGenerator.hpp"
+#include "core/Shader.hpp"
+#include "core/Texture.hpp"
+#include "core/TextureAtlas.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+
+const char* VERTEX_SHADER = R"(
+#version 330 core
+layout (location = 0) in vec2 aPos;
+uniform vec3 offset;
+out vec2 TexCoord;
+void main() {
+    TexCoord = aPos * 4.0;
+    gl_Position = vec4(offset.xy + aPos * 0.02, 0.0, 1.0);
+}
+)";
+
+const char* FRAGMENT_SHADER = R"(
+#version 330 core
+out vec4 FragColor;
+in vec2 TexCoord;
+uniform sampler2D texture_diffuse1;
+uniform sampler2DArray textureLayers;
+uniform bool useTextureLayers;
+uniform float textureLayer;
+uniform vec4 layerTransform;
+void main() {
+    if (useTextureLayers) {
+        vec2 uv = layerTransform.zw + fract(TexCoord) * layerTransform.xy;
+        FragColor = textureGrad(textureLayers, vec3(uv, textureLayer),
+                                dFdx(TexCoord) * layerTransform.xy, dFdy(TexCoord) * layerTransform.xy);
+    } else {
+        FragColor = texture(texture_diffuse1, TexCoord);
+    }
+}
+)";
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::shared_ptr<Texture> makeTexture(int size, uint32_t seed) {
+    TextureImage image;
+    image.width = image.height = size;
+    image.channels = 4;
+    image.pixels.resize(static_cast<size_t>(size) * size * 4);
+    for (unsigned char& byte : image.pixels) {
+        seed = seed * 1664525u + 1013904223u;
+        byte = static_cast<unsigned char>(seed >> 24);
+    }
+    MipGenerator::generate(image.pixels.data(), size, size, 4, image.mips);
+    auto texture = std::make_shared<Texture>();
+    texture->upload(image);
+    return texture;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int objectCount = 2000;
+    int textureCount = 16;
+    int frames = 100;
+    bool mixed = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--objects") == 0 && i + 1 < argc) {
+            objectCount = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--textures") == 0 && i + 1 < argc) {
+            textureCount = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--mixed") == 0) {
+            mixed = true;
+        }
+    }
+
+    if (!glfwInit()) {
+        return 1;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(640, 480, "TextureBindBench", nullptr, nullptr);
+    if (!window) {
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    glewExperimental = GL_TRUE;
+    if (glewInit() != GLEW_OK) {
+        return 1;
+    }
+
+    {
+        Shader shader;
+        shader.loadFromSource(VERTEX_SHADER, FRAGMENT_SHADER);
+        const float quad[] = {0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1};
+        GLuint vao, vbo;
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+        glEnableVertexAttribArray(0);
+
+        std::vector<std::shared_ptr<Texture>> textures;
+        for (int i = 0; i < textureCount; i++) {
+            int size = mixed ? 128 << (i % 3) : 256;
+            textures.push_back(makeTexture(size, 1234u + i));
+        }
+        TextureAtlas atlas;
+        auto buildStart = std::chrono::steady_clock::now();
+        atlas.build(textures);
+        double buildMs = elapsedMs(buildStart);
+        std::printf("%d objects, %d textures (%s): atlas of %d %s, %zu KB, built in %.1f ms\n", objectCount,
+                    textureCount, mixed ? "mixed sizes" : "same size", atlas.getLayerCount(),
+                    atlas.isPacked() ? "packed pages" : "layers", atlas.getMemoryBytes() / 1024, buildMs);
+
+        // Objects in scene order, not grouped by texture
+        std::vector<int> objectTextures(objectCount);
+        std::vector<AtlasRegion> regions(textureCount);
+        for (int i = 0; i < objectCount; i++) {
+            objectTextures[i] = (i * 7) % textureCount;
+        }
+        for (int i = 0; i < textureCount; i++) {
+            atlas.getRegion(*textures[i], regions[i]);
+        }
+
+        shader.use();
+        shader.setInt("texture_diffuse1", 0);
+        shader.setInt("textureLayers", 1);
+        for (int pass = 0; pass < 2; pass++) {
+            bool useAtlas = pass == 1;
+            size_t binds = 0;
+            glFinish();
+            auto start = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < frames; frame++) {
+                glClear(GL_COLOR_BUFFER_BIT);
+                shader.setBool("useTextureLayers", useAtlas);
+                if (useAtlas) {
+                    atlas.bind(1);
+                    binds++;
+                }
+                for (int i = 0; i < objectCount; i++) {
+                    shader.setVec3("offset", -1.0f + (i % 50) * 0.04f, -1.0f + (i / 50 % 50) * 0.04f, 0.0f);
+                    const std::shared_ptr<Texture>& texture = textures[objectTextures[i]];
+                    if (useAtlas) {
+                        const AtlasRegion& region = regions[objectTextures[i]];
+                        shader.setFloat("textureLayer", static_cast<float>(region.layer));
+                        shader.setVec4("layerTransform", region.uvScale[0], region.uvScale[1],
+                                       region.uvOffset[0], region.uvOffset[1]);
+                        glDrawArrays(GL_TRIANGLES, 0, 6);
+                    } else {
+                        texture->bind(0);
+                        glDrawArrays(GL_TRIANGLES, 0, 6);
+                        texture->unbind();
+                        binds += 2;
+                    }
+                }
+            }
+            glFinish();
+            double totalMs = elapsedMs(start);
+            std::printf("  %-16s %8zu binds/frame, %.3f ms/frame\n", useAtlas ? "atlas" : "per-object bind",
+                        binds / frames, totalMs / frames);
+        }
+
+        glDeleteBuffers(1, &vbo);
+        glDeleteVertexArrays(1, &vao);
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,112 @@
+// Block compression benchmark: encodes an image's mip chain to BC1/BC3 (or
+// BC4/BC5 for 1 and 2 channel images), reports encode time, size against the
+// uncompressed chain and PSNR of the base level, then compares a cold
+// Texture::decodeFile (decode + mips + encode + cache write) with a warm one
+// that maps the .texcache. No GPU is needed.
+//
+// Usage: TextureCompressBench [image]
+
+#include "core/BlockCompressor.hpp"
+#include "core/MipGenerator.hpp"
+#include "core/Texture.hpp"
+#include "core/TextureCache.hpp"
+#include "core/ThreadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+double computePsnr(const TextureImage& image, const std::vector<unsigned char>& decoded, int channels) {
+    double squaredError = 0.0;
+    size_t pixelCount = static_cast<size_t>(image.width) * image.height;
+    for (size_t p = 0; p < pixelCount; p++) {
+        for (int k = 0; k < channels; k++) {
+            double difference = image.pixels[p * image.channels + k] - decoded[p * 4 + k];
+            squaredError += difference * difference;
+        }
+    }
+    double mse = squaredError / (pixelCount * channels);
+    return mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : INFINITY;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "models/mountain/ground_grass_3264_4062_Small.jpg";
+
+    // Decode without the cache so the encoder sees the source pixels
+    Texture::setCompressionEnabled(false);
+    TextureImage image;
+    if (!Texture::decodeFile(path, image)) {
+        return 1;
+    }
+    std::printf("%s: %dx%d, %d channels, %zu levels\n", path.c_str(), image.width, image.height, image.channels,
+                image.mips.size() + 1);
+
+    std::vector<ImageLevel> levels;
+    levels.push_back({image.pixels.data(), image.width, image.height});
+    size_t rawBytes = image.pixels.size();
+    int width = image.width, height = image.height;
+    for (const auto& mip : image.mips) {
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+        levels.push_back({mip.data(), width, height});
+        rawBytes += mip.size();
+    }
+
+    std::vector<BlockFormat> formats;
+    if (image.channels == 4) {
+        formats = {BlockFormat::BC1, BlockFormat::BC3};
+    } else {
+        formats = {BlockCompressor::chooseFormat(image.channels, image.hasAlpha)};
+    }
+
+    const char* names[] = {"", "BC1", "", "BC3", "BC4", "BC5"};
+    for (BlockFormat format : formats) {
+        std::vector<std::vector<unsigned char>> blocks;
+        auto start = std::chrono::steady_clock::now();
+        BlockCompressor::compress(levels, image.channels, format, blocks, nullptr);
+        double serialMs = elapsedMs(start);
+        start = std::chrono::steady_clock::now();
+        BlockCompressor::compress(levels, image.channels, format, blocks, &ThreadPool::shared());
+        double parallelMs = elapsedMs(start);
+
+        size_t compressedBytes = 0;
+        for (const auto& level : blocks) compressedBytes += level.size();
+        std::vector<unsigned char> decoded;
+        BlockCompressor::decompress(blocks[0].data(), image.width, image.height, format, decoded);
+        int measured = format == BlockFormat::BC1 ? 3 : format == BlockFormat::BC5 ? 2 : format == BlockFormat::BC4 ? 1 : 4;
+
+        std::printf("  %s: %zu KB (%.1fx smaller than %zu KB), encode %.1f ms serial, %.1f ms on %zu threads, PSNR %.2f dB\n",
+                    names[static_cast<int>(format)], compressedBytes / 1024,
+                    static_cast<double>(rawBytes) / compressedBytes, rawBytes / 1024, serialMs, parallelMs,
+                    ThreadPool::shared().getThreadCount(), computePsnr(image, decoded, measured));
+    }
+
+    // Cold load writes the cache; warm loads map it
+    Texture::setCompressionEnabled(true);
+    std::remove(TextureCache::getCachePath(path).c_str());
+    auto start = std::chrono::steady_clock::now();
+    TextureImage cold;
+    Texture::decodeFile(path, cold);
+    double coldMs = elapsedMs(start);
+    start = std::chrono::steady_clock::now();
+    TextureImage warm;
+    Texture::decodeFile(path, warm);
+    double warmMs = elapsedMs(start);
+    if (warm.compressedLevels.empty()) {
+        std::printf("Cold/warm: compression unsupported without a GL context exposing S3TC for this format\n");
+    } else {
+        std::printf("Cold load %.2f ms, warm load from %s %.3f ms\n", coldMs,
+                    TextureCache::getCachePath(path).c_str(), warmMs);
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+// Texture build benchmark: decodes an image with stb_image, then builds its
+// full mip chain with the scalar filter, the SSE2 filter, and the SSE2 filter
+// split into row bands on 1..N threads. Every variant must hash to the same
+// bytes. glGenerateMipmap (the previous path) needs a GL context, so the
+// baseline here is the scalar single-threaded chain.
+//
+// Usage: TextureMipBench [image] [--size <pixels>] [--channels <1|2|4>]
+
+#include "core/FileUtils.hpp"
+#include "core/MipGenerator.hpp"
+#include "core/Texture.hpp"
+#include "core/ThreadPool.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+uint64_t hashLevels(const std::vector<std::vector<unsigned char>>& levels) {
+    uint64_t hash = 0;
+    for (const auto& level : levels) {
+        hash = FileUtils::hashBytes(level.data(), level.size(), hash);
+    }
+    return hash;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string path = "models/mountain/ground_grass_3264_4062_Small.jpg";
+    int syntheticSize = 0;
+    int syntheticChannels = 4;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            syntheticSize = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--channels") == 0 && i + 1 < argc) {
+            syntheticChannels = std::atoi(argv[++i]);
+        } else {
+            path = argv[i];
+        }
+    }
+
+    TextureImage image;
+    if (syntheticSize > 0) {
+        image.width = image.height = syntheticSize;
+        image.channels = syntheticChannels;
+        image.pixels.resize(static_cast<size_t>(syntheticSize) * syntheticSize * syntheticChannels);
+        uint32_t state = 12345;
+        for (unsigned char& byte : image.pixels) {
+            state = state * 1664525u + 1013904223u;
+            byte = static_cast<unsigned char>(state >> 24);
+        }
+        std::printf("Synthetic %dx%d, %d channels\n", image.width, image.height, image.channels);
+    } else {
+        auto start = std::chrono::steady_clock::now();
+        if (!Texture::decodeFile(path, image, false)) {
+            return 1;
+        }
+        std::printf("%s: %dx%d, %d channels, decoded in %.2f ms\n", path.c_str(), image.width, image.height,
+                    image.channels, elapsedMs(start));
+    }
+    std::printf("%d levels\n", MipGenerator::getLevelCount(image.width, image.height));
+
+    const int runs = 5;
+    auto measure = [&](const char* label, ThreadPool* pool, bool useSimd, uint64_t& hash) {
+        std::vector<std::vector<unsigned char>> levels;
+        double best = 1e30;
+        for (int run = 0; run < runs; run++) {
+            auto start = std::chrono::steady_clock::now();
+            MipGenerator::generate(image.pixels.data(), image.width, image.height, image.channels, levels, pool, useSimd);
+            best = std::min(best, elapsedMs(start));
+        }
+        hash = hashLevels(levels);
+        std::printf("  %-22s %8.3f ms  hash %016llx\n", label, best, static_cast<unsigned long long>(hash));
+        return best;
+    };
+
+    uint64_t reference = 0;
+    uint64_t hash = 0;
+    bool identical = true;
+    double scalarMs = measure("scalar, 1 thread", nullptr, false, reference);
+    double simdMs = measure("SSE2, 1 thread", nullptr, true, hash);
+    identical = identical && hash == reference;
+    std::printf("  SSE2 speedup %.2fx\n", scalarMs / simdMs);
+
+    for (size_t threads = 2; threads <= 16; threads *= 2) {
+        ThreadPool pool(threads);
+        char label[64];
+        std::snprintf(label, sizeof(label), "SSE2, %zu threads", threads);
+        double ms = measure(label, &pool, true, hash);
+        identical = identical && hash == reference;
+        std::printf("  speedup vs scalar %.2fx\n", scalarMs / ms);
+    }
+
+    std::printf(identical ? "All variants bit-identical\n" : "MISMATCH between variants\n");
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+// Per-frame transform benchmark: computes the matrices Scene needs for N
+// objects, once the way Scene did before TransformBatch (the model matrix
+// rebuilt for the uniform block and again for the culler, which multiplied
+// it by view and projection; the normal matrix was left to the vertex
+// shader), and once through TransformBatch with the scalar loop and with
+// SSE2, which also produce the normal matrix. The two TransformBatch paths
+// must produce identical bytes. No GPU needed.
+//
+// Usage: TransformBench [--objects <n>] [--frames <f>]
+
+#include "scene/TransformBatch.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Transform {
+    float position[3];
+    float scale[3];
+    float angle;   // Degrees around Y, as SceneObject stores it
+};
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// SceneObject::buildModelMatrix before TransformBatch
+void legacyModelMatrix(const Transform& t, float* matrix) {
+    std::memset(matrix, 0, 16 * sizeof(float));
+    matrix[0] = t.scale[0];
+    matrix[5] = t.scale[1];
+    matrix[10] = t.scale[2];
+    matrix[15] = 1.0f;
+    if (t.angle != 0.0f) {
+        float angle = t.angle * 3.14159265359f / 180.0f;
+        float cosA = std::cos(angle);
+        float sinA = std::sin(angle);
+        float temp[16];
+        std::memcpy(temp, matrix, 16 * sizeof(float));
+        matrix[0] = temp[0] * cosA - temp[8] * sinA;
+        matrix[2] = temp[0] * sinA + temp[8] * cosA;
+        matrix[8] = temp[2] * cosA - temp[10] * sinA;
+        matrix[10] = temp[2] * sinA + temp[10] * cosA;
+    }
+    matrix[12] = t.position[0];
+    matrix[13] = t.position[1];
+    matrix[14] = t.position[2];
+}
+
+// ClusterCuller's column-major multiply before it took the model-view-projection
+void multiply(const float* a, const float* b, float* out) {
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; k++) {
+                sum += a[k * 4 + row] * b[col * 4 + k];
+            }
+            out[col * 4 + row] = sum;
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int objectCount = 100000;
+    int frames = 20;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--objects") == 0 && i + 1 < argc) {
+            objectCount = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        }
+    }
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> spread(-50.0f, 50.0f);
+    std::uniform_real_distribution<float> size(0.25f, 4.0f);
+    std::vector<Transform> transforms(objectCount);
+    for (Transform& t : transforms) {
+        t = {{spread(rng), spread(rng), spread(rng)}, {size(rng), size(rng), size(rng)}, spread(rng) * 3.6f};
+    }
+    float view[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, -2, -10, 1};
+    float projection[16] = {1.8f, 0, 0, 0, 0, 2.4f, 0, 0, 0, 0, -1.002f, -1, 0, 0, -0.2002f, 0};
+    float viewProjection[16];
+    multiply(projection, view, viewProjection);
+    std::printf("%d objects, %d frames\n", objectCount, frames);
+
+    // Before: two model matrix builds and two 4x4 multiplies per object
+    float checksum = 0.0f;
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+        for (const Transform& t : transforms) {
+            float blockModel[16], cullModel[16], viewModel[16], clip[16];
+            legacyModelMatrix(t, blockModel);
+            legacyModelMatrix(t, cullModel);
+            multiply(view, cullModel, viewModel);
+            multiply(projection, viewModel, clip);
+            checksum += blockModel[12] + clip[15];
+        }
+    }
+    double legacyMs = elapsedMs(start) / frames;
+    std::printf("  %-26s %8.3f ms/frame (normal matrix left to the vertex shader)\n", "per object", legacyMs);
+
+    TransformBatch batches[2];
+    batches[0].setSimdEnabled(false);
+    const char* labels[] = {"TransformBatch scalar", "TransformBatch SSE2"};
+    for (int pass = 0; pass < 2; pass++) {
+        TransformBatch& batch = batches[pass];
+        if (pass == 1 && !batch.isSimdEnabled()) {
+            std::printf("  %-26s not available in this build\n", labels[pass]);
+            break;
+        }
+        start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++) {
+            batch.clear();
+            for (const Transform& t : transforms) {
+                float halfAngle = t.angle * 3.14159265359f / 360.0f;
+                float rotation[4] = {0.0f, -std::sin(halfAngle), 0.0f, std::cos(halfAngle)};
+                batch.add(t.position, rotation, t.scale);
+            }
+            batch.compute(viewProjection);
+            checksum += batch.get(0).modelViewProjection[15];
+        }
+        double ms = elapsedMs(start) / frames;
+        std::printf("  %-26s %8.3f ms/frame, %.2fx vs per object\n", labels[pass], ms, legacyMs / ms);
+    }
+
+    bool identical = !batches[1].isSimdEnabled() ||
+                     std::memcmp(&batches[0].get(0), &batches[1].get(0), objectCount * sizeof(ObjectTransform)) == 0;
+    std::printf(identical ? "Scalar and SSE2 bit-identical\n" : "MISMATCH between scalar and SSE2\n");
+    std::printf("(checksum %g)\n", checksum);
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,259 @@
+// Uniform setter benchmark: sets the uniforms Scene and Model set for every
+// object (model matrix, dequantization, material) for N objects per frame,
+// once the way Shader did before reflection (a std::string per call and a
+// glGetUniformLocation per set), once through Shader's reflected table with
+// names hashed at compile time, and once the way Scene does now: transforms
+// written to a UniformRing as ObjectBlocks, uploaded once and selected per
+// object with glBindBufferRange, leaving only the material as uniforms.
+// Reports per frame the glUniform calls, GL location queries, heap
+// allocations and CPU time. Needs a GL 3.3 context; the window stays hidden.
+//
+// Usage: UniformBench [--objects <n>] [--frames <f>]
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include "core/Shader.hpp"
+#include "core/UniformRing.hpp"
+#include "scene/UniformBlocks.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<size_t> g_allocations{0};
+
+const char* VERTEX_SHADER = R"(
+#version 330 core
+layout (location = 0) in vec3 aPos;
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform bool quantizedVertex;
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+void main() {
+    vec3 position = quantizedVertex ? positionOffset + aPos * positionScale : aPos;
+    gl_Position = projection * view * model * vec4(position, 1.0);
+}
+)";
+
+const char* BLOCK_VERTEX_SHADER = R"(
+layout (location = 0) in vec3 aPos;
+void main() {
+    vec3 position = positionOffset.xyz + aPos * positionScale.xyz;
+    gl_Position = projection * view * model * vec4(position, 1.0);
+}
+)";
+
+const char* FRAGMENT_SHADER = R"(
+#version 330 core
+out vec4 FragColor;
+uniform bool useTexture;
+uniform bool useTextureLayers;
+uniform vec3 materialDiffuse;
+uniform vec3 materialSpecular;
+uniform float materialShininess;
+void main() {
+    vec3 color = useTexture ? materialDiffuse : materialSpecular * materialShininess;
+    FragColor = vec4(useTextureLayers ? color.bgr : color, 1.0);
+}
+)";
+
+constexpr UniformName UNIFORM_MODEL("model");
+constexpr UniformName UNIFORM_QUANTIZED_VERTEX("quantizedVertex");
+constexpr UniformName UNIFORM_POSITION_OFFSET("positionOffset");
+constexpr UniformName UNIFORM_POSITION_SCALE("positionScale");
+constexpr UniformName UNIFORM_USE_TEXTURE("useTexture");
+constexpr UniformName UNIFORM_USE_TEXTURE_LAYERS("useTextureLayers");
+constexpr UniformName UNIFORM_MATERIAL_DIFFUSE("materialDiffuse");
+constexpr UniformName UNIFORM_MATERIAL_SPECULAR("materialSpecular");
+constexpr UniformName UNIFORM_MATERIAL_SHININESS("materialShininess");
+
+// The setters as they were: a string per call and a location query per set
+size_t g_legacyCalls = 0;
+
+void legacySetBool(GLuint program, const std::string& name, bool value) {
+    glUniform1i(glGetUniformLocation(program, name.c_str()), (int)value);
+    g_legacyCalls++;
+}
+
+void legacySetFloat(GLuint program, const std::string& name, float value) {
+    glUniform1f(glGetUniformLocation(program, name.c_str()), value);
+    g_legacyCalls++;
+}
+
+void legacySetMat4(GLuint program, const std::string& name, const float* matrix) {
+    glUniformMatrix4fv(glGetUniformLocation(program, name.c_str()), 1, GL_FALSE, matrix);
+    g_legacyCalls++;
+}
+
+void legacySetVec3(GLuint program, const std::string& name, float x, float y, float z) {
+    glUniform3f(glGetUniformLocation(program, name.c_str()), x, y, z);
+    g_legacyCalls++;
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+    g_allocations++;
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+int main(int argc, char** argv) {
+    int objectCount = 5000;
+    int frames = 50;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--objects") == 0 && i + 1 < argc) {
+            objectCount = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        }
+    }
+
+    if (!glfwInit()) {
+        return 1;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(640, 480, "UniformBench", nullptr, nullptr);
+    if (!window) {
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    glewExperimental = GL_TRUE;
+    if (glewInit() != GLEW_OK) {
+        return 1;
+    }
+
+    {
+        Shader shader;
+        if (!shader.loadFromSource(VERTEX_SHADER, FRAGMENT_SHADER)) {
+            return 1;
+        }
+        shader.use();
+        std::printf("%d objects, %d frames, %zu active uniforms reflected with %zu location queries\n", objectCount,
+                    frames, shader.getUniformCount(), shader.getStats().locationQueries);
+
+        Shader blockShader;
+        std::string blockVertexShader = std::string("#version 330 core\n") + UNIFORM_BLOCKS_GLSL + BLOCK_VERTEX_SHADER;
+        if (!blockShader.loadFromSource(blockVertexShader, FRAGMENT_SHADER) ||
+            !blockShader.bindUniformBlock("FrameBlock", FRAME_BLOCK_BINDING) ||
+            !blockShader.bindUniformBlock("ObjectBlock", OBJECT_BLOCK_BINDING)) {
+            return 1;
+        }
+        UniformRing ring;
+        if (!ring.initialize(sizeof(FrameUniforms) + objectCount * ring.getAlignment() + 4096)) {
+            return 1;
+        }
+        std::vector<size_t> offsets(objectCount);
+        
+        float matrix[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+        GLuint program = shader.getID();
+        const char* passNames[] = {"by string", "reflected", "blocks"};
+        for (int pass = 0; pass < 3; pass++) {
+            bool reflected = pass == 1;
+            bool blocks = pass == 2;
+            g_legacyCalls = 0;
+            (blocks ? blockShader : shader).use();
+            shader.resetStats();
+            blockShader.resetStats();
+            glFinish();
+            size_t allocationsBefore = g_allocations;
+            auto start = std::chrono::steady_clock::now();
+
+            for (int frame = 0; frame < frames; frame++) {
+                if (blocks) {
+                    ring.beginFrame();
+                    FrameUniforms frameBlock = {};
+                    size_t frameOffset = ring.push(&frameBlock, sizeof(frameBlock));
+                    for (int i = 0; i < objectCount; i++) {
+                        ObjectUniforms block = {};
+                        std::memcpy(block.model, matrix, sizeof(matrix));
+                        block.model[12] = static_cast<float>(i);
+                        float shade = static_cast<float>(i % 7) / 7.0f;
+                        block.positionOffset[0] = shade;
+                        block.positionScale[0] = block.positionScale[1] = 1.0f;
+                        block.positionScale[2] = shade;
+                        offsets[i] = ring.push(&block, sizeof(block));
+                    }
+                    ring.upload();
+                    ring.bind(FRAME_BLOCK_BINDING, frameOffset, sizeof(FrameUniforms));
+                }
+                for (int i = 0; i < objectCount; i++) {
+                    matrix[12] = static_cast<float>(i);
+                    float shade = static_cast<float>(i % 7) / 7.0f;
+                    if (blocks) {
+                        ring.bind(OBJECT_BLOCK_BINDING, offsets[i], sizeof(ObjectUniforms));
+                        blockShader.setBool(UNIFORM_USE_TEXTURE, i % 2 == 0);
+                        blockShader.setBool(UNIFORM_USE_TEXTURE_LAYERS, false);
+                        blockShader.setVec3(UNIFORM_MATERIAL_DIFFUSE, shade, shade, shade);
+                        blockShader.setVec3(UNIFORM_MATERIAL_SPECULAR, 0.5f, 0.5f, 0.5f);
+                        blockShader.setFloat(UNIFORM_MATERIAL_SHININESS, 32.0f);
+                    } else if (reflected) {
+                        shader.setMat4(UNIFORM_MODEL, matrix);
+                        shader.setBool(UNIFORM_QUANTIZED_VERTEX, true);
+                        shader.setVec3(UNIFORM_POSITION_OFFSET, shade, 0.0f, 0.0f);
+                        shader.setVec3(UNIFORM_POSITION_SCALE, 1.0f, 1.0f, shade);
+                        shader.setBool(UNIFORM_USE_TEXTURE, i % 2 == 0);
+                        shader.setBool(UNIFORM_USE_TEXTURE_LAYERS, false);
+                        shader.setVec3(UNIFORM_MATERIAL_DIFFUSE, shade, shade, shade);
+                        shader.setVec3(UNIFORM_MATERIAL_SPECULAR, 0.5f, 0.5f, 0.5f);
+                        shader.setFloat(UNIFORM_MATERIAL_SHININESS, 32.0f);
+                    } else {
+                        legacySetMat4(program, "model", matrix);
+                        legacySetBool(program, "quantizedVertex", true);
+                        legacySetVec3(program, "positionOffset", shade, 0.0f, 0.0f);
+                        legacySetVec3(program, "positionScale", 1.0f, 1.0f, shade);
+                        legacySetBool(program, "useTexture", i % 2 == 0);
+                        legacySetBool(program, "useTextureLayers", false);
+                        legacySetVec3(program, "materialDiffuse", shade, shade, shade);
+                        legacySetVec3(program, "materialSpecular", 0.5f, 0.5f, 0.5f);
+                        legacySetFloat(program, "materialShininess", 32.0f);
+                    }
+                }
+                if (blocks) {
+                    ring.endFrame();
+                }
+            }
+            glFinish();
+            double totalMs = elapsedMs(start);
+            size_t allocations = g_allocations - allocationsBefore;
+
+            const UniformStats& stats = (blocks ? blockShader : shader).getStats();
+            size_t calls = reflected || blocks ? stats.uniformCalls : g_legacyCalls;
+            size_t queries = reflected || blocks ? stats.locationQueries : g_legacyCalls;
+            std::printf("  %-10s %8zu uniform calls, %8zu location queries, %8zu allocations per frame, "
+                        "%.3f ms/frame\n", passNames[pass], calls / frames, queries / frames,
+                        allocations / frames, totalMs / frames);
+        }
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,172 @@
+// Upload staging benchmark: every frame uploads N textures of S x S RGBA
+// pixels, once straight from client memory with glTexSubImage2D and once
+// through a StagingRing, where workers copy each frame's images into the
+// ring's slots and the next frame only issues the uploads from them. Reports
+// the GL thread's time per frame (mean, 99th percentile and worst frame);
+// the rest of each frame is simulated with a short sleep. Needs a GL 3.3
+// context; the window stays hidden.
+//
+// Usage: UploadStagingBench [--uploads <n>] [--size <s>] [--frames <f>]
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include "core/StagingRing.hpp"
+#include "core/ThreadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct PendingUpload {
+    GLuint texture;
+    int slot;
+    std::future<void> copy;
+};
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char* name, std::vector<double> frameMs) {
+    double total = 0.0;
+    for (double ms : frameMs) {
+        total += ms;
+    }
+    std::sort(frameMs.begin(), frameMs.end());
+    size_t p99 = std::min(frameMs.size() - 1, frameMs.size() * 99 / 100);
+    std::printf("  %-8s mean %6.2f ms, p99 %6.2f ms, worst %6.2f ms\n", name, total / frameMs.size(),
+                frameMs[p99], frameMs.back());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int uploads = 16;
+    int size = 512;
+    int frames = 200;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--uploads") == 0 && i + 1 < argc) {
+            uploads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            size = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        }
+    }
+
+    if (!glfwInit()) {
+        return 1;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(640, 480, "UploadStagingBench", nullptr, nullptr);
+    if (!window) {
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    glewExperimental = GL_TRUE;
+    if (glewInit() != GLEW_OK) {
+        return 1;
+    }
+
+    {
+        // Decoded images, as a loader would hand them over
+        size_t imageBytes = static_cast<size_t>(size) * size * 4;
+        std::vector<std::vector<unsigned char>> images(uploads);
+        uint32_t seed = 1234u;
+        for (auto& image : images) {
+            image.resize(imageBytes);
+            for (unsigned char& byte : image) {
+                seed = seed * 1664525u + 1013904223u;
+                byte = static_cast<unsigned char>(seed >> 24);
+            }
+        }
+        std::vector<GLuint> textures(uploads);
+        glGenTextures(uploads, textures.data());
+        for (GLuint texture : textures) {
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        // Two frames of slots: one being copied into while the other is transferred
+        StagingRing ring;
+        if (!ring.initialize(static_cast<size_t>(uploads) * 2 + 1, imageBytes)) {
+            return 1;
+        }
+        std::printf("%d uploads of %dx%d RGBA (%.1f MB) per frame, %d frames, %s staging slots\n", uploads, size,
+                    size, uploads * imageBytes / (1024.0 * 1024.0), frames,
+                    ring.isPersistent() ? "persistent" : "orphaned");
+
+        ThreadPool& pool = ThreadPool::shared();
+        for (int pass = 0; pass < 2; pass++) {
+            bool staged = pass == 1;
+            std::vector<double> frameMs;
+            std::deque<PendingUpload> pending;
+            glFinish();
+
+            for (int frame = 0; frame < frames; frame++) {
+                auto start = std::chrono::steady_clock::now();
+                if (staged) {
+                    // Last frame's copies are done by now; only the transfers are left
+                    while (!pending.empty()) {
+                        PendingUpload& upload = pending.front();
+                        upload.copy.wait();
+                        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring.beginTransfer(upload.slot));
+                        glBindTexture(GL_TEXTURE_2D, upload.texture);
+                        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size, size, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+                        ring.endTransfer(upload.slot);
+                        pending.pop_front();
+                    }
+                    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                    for (int i = 0; i < uploads; i++) {
+                        int slot = ring.acquire(imageBytes);
+                        if (slot < 0) break;
+                        unsigned char* destination = ring.getPointer(slot);
+                        const unsigned char* source = images[i].data();
+                        pending.push_back({textures[i], slot, pool.submit([destination, source, imageBytes]() {
+                                               std::memcpy(destination, source, imageBytes);
+                                           })});
+                    }
+                } else {
+                    for (int i = 0; i < uploads; i++) {
+                        glBindTexture(GL_TEXTURE_2D, textures[i]);
+                        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size, size, GL_RGBA, GL_UNSIGNED_BYTE,
+                                        images[i].data());
+                    }
+                }
+                glBindTexture(GL_TEXTURE_2D, 0);
+                glFlush();
+                frameMs.push_back(elapsedMs(start));
+
+                // The rest of the frame, during which the workers copy
+                std::this_thread::sleep_for(std::chrono::milliseconds(8));
+            }
+
+            for (PendingUpload& upload : pending) {
+                upload.copy.wait();
+                ring.release(upload.slot);
+            }
+            glFinish();
+            report(staged ? "staged" : "direct", frameMs);
+        }
+        std::printf("  ring: %zu transfers, %zu acquires refused\n", ring.getStats().transfers,
+                    ring.getStats().rejectedAcquires);
+        glDeleteTextures(uploads, textures.data());
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,165 @@
+#ifndef ASSETCACHE_HPP
+#define ASSETCACHE_HPP
+
+#include "core/FileUtils.hpp"
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @struct AssetCacheStats
+ * @brief Hit and miss counters of an AssetCache.
+ */
+struct AssetCacheStats {
+    size_t hits = 0;       ///< Requests served by an asset that was already loaded
+    size_t misses = 0;     ///< Requests that loaded the asset
+    size_t failures = 0;   ///< Requests whose file was missing or failed to load
+};
+
+/**
+ * @class AssetCache
+ * @brief Reference-counted cache that loads each distinct asset once.
+ *
+ * Assets are keyed by canonical path plus content hash, so different
+ * spellings of the same path share one asset, and a file whose contents
+ * changed is loaded again. A variant string distinguishes loads of the same
+ * file with different options.
+ *
+ * Callers hold std::shared_ptr handles while the cache only keeps weak
+ * references: the asset, and the GPU resources it owns, is destroyed as soon
+ * as the last handle drops. The content hash is recomputed only when the
+ * file's size or modification time changes. Not thread-safe; use it from the
+ * thread that owns the GL context.
+ */
+template <typename T>
+class AssetCache {
+public:
+    /// Loads a default-constructed asset in place; returns false on failure
+    using Loader = std::function<bool(T&)>;
+
+    /**
+     * @brief Gets the asset for a file, loading it if no live handle exists.
+     * @param filepath Path to the asset file.
+     * @param load Loader called on a new asset when the cache misses.
+     * @param variant Load options that must match for an asset to be shared.
+     * @return A handle to the asset, or nullptr if the file is missing or failed to load.
+     */
+    std::shared_ptr<T> acquire(const std::string& filepath, const Loader& load, const std::string& variant = "") {
+        std::string key;
+        if (!makeKey(filepath, variant, key)) {
+            m_stats.failures++;
+            return nullptr;
+        }
+
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            if (std::shared_ptr<T> asset = it->second.lock()) {
+                m_stats.hits++;
+                return asset;
+            }
+        }
+
+        purge();
+        auto asset = std::make_shared<T>();
+        if (!load(*asset)) {
+            m_stats.failures++;
+            return nullptr;
+        }
+        m_stats.misses++;
+        m_entries[key] = asset;
+        return asset;
+    }
+
+    /**
+     * @brief Removes an asset from the cache so the next acquire loads the file again.
+     *
+     * Existing handles stay valid. Used when an asset turns out to be unusable,
+     * e.g. after a failed or cancelled background load.
+     * @param asset The asset to forget.
+     */
+    void erase(const std::shared_ptr<T>& asset) {
+        for (auto it = m_entries.begin(); it != m_entries.end();) {
+            if (it->second.lock() == asset) {
+                it = m_entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    /**
+     * @brief Drops the entries of assets that no handle refers to anymore.
+     */
+    void purge() {
+        for (auto it = m_entries.begin(); it != m_entries.end();) {
+            if (it->second.expired()) {
+                it = m_entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    /**
+     * @brief Gets the number of assets currently alive.
+     * @return The number of cached assets with at least one handle.
+     */
+    size_t getLiveCount() const {
+        size_t count = 0;
+        for (const auto& entry : m_entries) {
+            if (!entry.second.expired()) count++;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Gets the hit and miss counters.
+     * @return Reference to the AssetCacheStats.
+     */
+    const AssetCacheStats& getStats() const { return m_stats; }
+
+    /**
+     * @brief Gets the process-wide cache for this asset type.
+     * @return Reference to the shared cache (created on first use).
+     */
+    static AssetCache& shared() {
+        static AssetCache cache;
+        return cache;
+    }
+
+private:
+    struct ContentHash {
+        FileStamp stamp;
+        uint64_t hash = 0;
+    };
+
+    std::unordered_map<std::string, std::weak_ptr<T>> m_entries;
+    std::unordered_map<std::string, ContentHash> m_hashes;
+    AssetCacheStats m_stats;
+
+    bool makeKey(const std::string& filepath, const std::string& variant, std::string& key) {
+        std::string canonical = FileUtils::canonicalPath(filepath);
+        FileStamp stamp = FileUtils::getStamp(canonical);
+        if (!stamp.valid) {
+            return false;
+        }
+
+        ContentHash& content = m_hashes[canonical];
+        if (content.stamp != stamp) {
+            if (!FileUtils::hashFile(canonical, content.hash)) {
+                m_hashes.erase(canonical);
+                return false;
+            }
+            content.stamp = stamp;
+        }
+
+        char hash[17];
+        std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(content.hash));
+        key = canonical + '#' + hash + '#' + variant;
+        return true;
+    }
+};
+
+#endif // ASSETCACHE_HPP
@@ -0,0 +1,95 @@
+#ifndef BLOCKCOMPRESSOR_HPP
+#define BLOCKCOMPRESSOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * @enum BlockFormat
+ * @brief GPU block compression formats produced by BlockCompressor.
+ */
+enum class BlockFormat : uint32_t {
+    BC1 = 1,   ///< Opaque RGB, 8 bytes per 4x4 block (DXT1)
+    BC3 = 3,   ///< RGBA with interpolated alpha, 16 bytes per block (DXT5)
+    BC4 = 4,   ///< Single channel, 8 bytes per block (RGTC1)
+    BC5 = 5    ///< Two channels, 16 bytes per block (RGTC2)
+};
+
+/**
+ * @struct ImageLevel
+ * @brief Read-only view of one uncompressed mip level, tightly packed rows.
+ */
+struct ImageLevel {
+    const unsigned char* pixels;
+    int width;
+    int height;
+};
+
+/**
+ * @class BlockCompressor
+ * @brief CPU encoder for BC1, BC3, BC4 and BC5 textures.
+ *
+ * Color endpoints start from the block's bounding box, inset and oriented
+ * along the green covariance, and are then refined once by least squares
+ * against the chosen indices. Single-channel blocks (BC4, and the alpha of
+ * BC3, and both channels of BC5) use the 8-value mode with the block's
+ * min and max as endpoints. Partial blocks at the right and bottom edges
+ * repeat the last column and row. Blocks are independent, so work is split
+ * into bands of block rows across every level of a chain at once.
+ */
+class BlockCompressor {
+public:
+    /// Block rows per parallel task
+    static constexpr int BAND_BLOCK_ROWS = 8;
+
+    /**
+     * @brief Picks the format for an image.
+     * @param channels Bytes per pixel (1, 2 or 4).
+     * @param hasAlpha True if the fourth channel carries real alpha.
+     * @return BC4 for 1 channel, BC5 for 2, BC3 for RGBA with alpha and BC1 otherwise.
+     */
+    static BlockFormat chooseFormat(int channels, bool hasAlpha);
+
+    /**
+     * @brief Gets the size of one 4x4 block.
+     * @param format The block format.
+     * @return 8 or 16 bytes.
+     */
+    static size_t getBlockBytes(BlockFormat format);
+
+    /**
+     * @brief Gets the compressed size of an image.
+     * @param format The block format.
+     * @param width Width in pixels.
+     * @param height Height in pixels.
+     * @return Size in bytes, counting partial blocks as whole ones.
+     */
+    static size_t getCompressedSize(BlockFormat format, int width, int height);
+
+    /**
+     * @brief Compresses every level of a mip chain.
+     * @param levels The levels to compress, base level first.
+     * @param channels Bytes per pixel of the levels (1, 2 or 4).
+     * @param format Output format; BC1 and BC3 need 4 channels, BC4 1 or more, BC5 2 or more.
+     * @param out Output receiving one compressed buffer per level.
+     * @param pool Pool for the block row bands, or nullptr to run on the calling thread.
+     */
+    static void compress(const std::vector<ImageLevel>& levels, int channels, BlockFormat format,
+                         std::vector<std::vector<unsigned char>>& out, ThreadPool* pool = nullptr);
+
+    /**
+     * @brief Decodes a compressed image, e.g. to measure the encoding error.
+     * @param data Compressed blocks.
+     * @param width Width in pixels.
+     * @param height Height in pixels.
+     * @param format The block format.
+     * @param out Output receiving RGBA pixels (BC4 fills red, BC5 red and green; alpha is 255 unless BC3).
+     */
+    static void decompress(const unsigned char* data, int width, int height, BlockFormat format,
+                           std::vector<unsigned char>& out);
+};
+
+#endif // BLOCKCOMPRESSOR_HPP
@@ -70,6 +70,12 @@ public:
      */
     const float* getProjectionMatrix() const { return m_projectionMatrix; }
     
+    /**
+     * @brief Computes the projection matrix times the view matrix.
+     * @param matrix Output receiving the 16-element matrix (column-major order).
+     */
+    void getViewProjectionMatrix(float* matrix) const;
+    
     /**
      * @brief Gets the X coordinate of the camera position.
      * @return The X coordinate.
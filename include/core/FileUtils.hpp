@@ -0,0 +1,77 @@
+#ifndef FILEUTILS_HPP
+#define FILEUTILS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @struct FileStamp
+ * @brief Size and modification time of a file, used to detect changes cheaply.
+ */
+struct FileStamp {
+    uint64_t size = 0;       ///< File size in bytes
+    int64_t mtimeNs = 0;     ///< Last modification time in nanoseconds since the epoch
+    bool valid = false;      ///< False if the file does not exist or could not be queried
+
+    bool operator==(const FileStamp& other) const {
+        return valid == other.valid && size == other.size && mtimeNs == other.mtimeNs;
+    }
+    bool operator!=(const FileStamp& other) const { return !(*this == other); }
+};
+
+/**
+ * @class FileUtils
+ * @brief Small file helpers shared by the asset caches.
+ */
+class FileUtils {
+public:
+    /**
+     * @brief Queries the size and modification time of a file.
+     * @param filepath Path to the file.
+     * @return The file stamp; valid is false if the file could not be queried.
+     */
+    static FileStamp getStamp(const std::string& filepath);
+
+    /**
+     * @brief Checks whether a file exists.
+     * @param filepath Path to the file.
+     * @return True if the file exists, false otherwise.
+     */
+    static bool exists(const std::string& filepath) { return getStamp(filepath).valid; }
+
+    /**
+     * @brief Resolves a path to its absolute form without ".", ".." or symlinks.
+     * @param filepath Path to the file.
+     * @return The canonical path, or the path unchanged if it cannot be resolved.
+     */
+    static std::string canonicalPath(const std::string& filepath);
+
+    /**
+     * @brief Computes a fast 64-bit hash of a block of memory.
+     * @param data Pointer to the data.
+     * @param size Number of bytes to hash.
+     * @param seed Initial hash value, allowing several blocks to be chained.
+     * @return The 64-bit hash.
+     */
+    static uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0xCBF29CE484222325ull);
+
+    /**
+     * @brief Computes the content hash of a whole file.
+     * @param filepath Path to the file.
+     * @param hash Output receiving the hash.
+     * @return True if the file could be read, false otherwise.
+     */
+    static bool hashFile(const std::string& filepath, uint64_t& hash);
+
+    /**
+     * @brief Writes a file atomically by writing a temporary file and renaming it.
+     * @param filepath Destination path.
+     * @param data Pointer to the contents.
+     * @param size Number of bytes to write.
+     * @return True if the file was written, false otherwise.
+     */
+    static bool writeAtomic(const std::string& filepath, const void* data, size_t size);
+};
+
+#endif // FILEUTILS_HPP
@@ -0,0 +1,61 @@
+#ifndef FILEWATCHER_HPP
+#define FILEWATCHER_HPP
+
+#include "core/FileUtils.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class FileWatcher
+ * @brief Reports files that were written since the last poll, without blocking.
+ *
+ * On Linux the directories of the watched files are watched with inotify,
+ * so a poll costs one non-blocking read; saves that replace the file (write
+ * to a temporary, then rename) are caught as well as in-place writes.
+ * Elsewhere, or if inotify is unavailable, each poll compares the files'
+ * size and modification time instead.
+ */
+class FileWatcher {
+public:
+    /**
+     * @brief Constructs a watcher with no files.
+     */
+    FileWatcher();
+
+    /**
+     * @brief Destructor that stops watching.
+     */
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    /**
+     * @brief Starts watching a file.
+     * @param filepath Path to an existing file.
+     * @return True if the file is watched, false if it does not exist.
+     */
+    bool addFile(const std::string& filepath);
+
+    /**
+     * @brief Collects the watched files changed since the last poll.
+     * @param changed Receives the canonical path of each changed file, once.
+     */
+    void poll(std::vector<std::string>& changed);
+
+    /**
+     * @brief Checks whether changes come from inotify rather than polling file stamps.
+     * @return True if inotify is in use.
+     */
+    bool isUsingInotify() const { return m_inotify >= 0; }
+
+private:
+    int m_inotify;
+    std::unordered_map<int, std::string> m_directories;   // Watch descriptor to canonical directory
+    std::unordered_map<std::string, FileStamp> m_files;   // Canonical path to last seen stamp
+
+    void addChanged(const std::string& path, std::vector<std::string>& changed);
+};
+
+#endif // FILEWATCHER_HPP
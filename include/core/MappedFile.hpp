@@ -0,0 +1,72 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @class MappedFile
+ * @brief Read-only view of a whole file, memory-mapped where the platform supports it.
+ *
+ * On POSIX systems the file is mapped with mmap so it can be scanned in place
+ * without copying. On other platforms (or if mapping fails) the contents are
+ * read into an internal buffer instead, so callers never need to care which
+ * path was taken.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Constructs an empty (unopened) mapping.
+     */
+    MappedFile();
+
+    /**
+     * @brief Destructor that unmaps the file if it is open.
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * @brief Opens and maps a file for reading.
+     * @param filepath Path to the file to map.
+     * @return True if the file was opened, false otherwise.
+     */
+    bool open(const std::string& filepath);
+
+    /**
+     * @brief Unmaps the file and releases all resources.
+     */
+    void close();
+
+    /**
+     * @brief Gets a pointer to the first byte of the file.
+     * @return Pointer to the file contents, or nullptr if not open or empty.
+     */
+    const char* data() const { return m_data; }
+
+    /**
+     * @brief Gets the size of the file in bytes.
+     * @return The file size.
+     */
+    size_t size() const { return m_size; }
+
+    /**
+     * @brief Checks if a file is currently open.
+     * @return True if open, false otherwise.
+     */
+    bool isOpen() const { return m_open; }
+
+private:
+    const char* m_data;
+    size_t m_size;
+    bool m_open;
+    bool m_mapped;
+    std::vector<char> m_buffer;
+};
+
+#endif // MAPPEDFILE_HPP
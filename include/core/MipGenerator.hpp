@@ -0,0 +1,62 @@
+#ifndef MIPGENERATOR_HPP
+#define MIPGENERATOR_HPP
+
+#include <cstddef>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * @class MipGenerator
+ * @brief Builds texture mip chains on the CPU with a 2x2 box filter.
+ *
+ * Each texel of a level is the rounded average (a + b + c + d + 2) / 4 of
+ * the 2x2 block below it, computed in integers, so the result is identical
+ * with or without SIMD and for any number of threads. Level sizes follow
+ * GL (max(1, size / 2)), so an odd size drops its last row or column, and a
+ * size of 1 averages each texel with itself. Levels are built one after the other,
+ * each split into row bands that run in parallel. The SSE2 path handles 1, 2
+ * and 4 channel images; other channel counts use the scalar path.
+ */
+class MipGenerator {
+public:
+    /// Destination rows per parallel band
+    static constexpr int BAND_ROWS = 32;
+
+    /**
+     * @brief Gets the number of levels in a full mip chain, including the base level.
+     * @param width Base level width in pixels.
+     * @param height Base level height in pixels.
+     * @return floor(log2(max(width, height))) + 1.
+     */
+    static int getLevelCount(int width, int height);
+
+    /**
+     * @brief Halves an image with the 2x2 box filter.
+     * @param src Source pixels, tightly packed rows.
+     * @param width Source width in pixels.
+     * @param height Source height in pixels.
+     * @param channels Bytes per pixel.
+     * @param dst Output of max(1, width / 2) x max(1, height / 2) pixels.
+     * @param pool Pool for row bands, or nullptr to run on the calling thread.
+     * @param useSimd False to force the scalar path (for verification and benchmarks).
+     */
+    static void downsample(const unsigned char* src, int width, int height, int channels,
+                           unsigned char* dst, ThreadPool* pool = nullptr, bool useSimd = true);
+
+    /**
+     * @brief Builds every level below the base level.
+     * @param base Base level pixels, tightly packed rows.
+     * @param width Base level width in pixels.
+     * @param height Base level height in pixels.
+     * @param channels Bytes per pixel.
+     * @param levels Output receiving levels 1 to getLevelCount() - 1.
+     * @param pool Pool for row bands, or nullptr to run on the calling thread.
+     * @param useSimd False to force the scalar path.
+     */
+    static void generate(const unsigned char* base, int width, int height, int channels,
+                         std::vector<std::vector<unsigned char>>& levels,
+                         ThreadPool* pool = nullptr, bool useSimd = true);
+};
+
+#endif // MIPGENERATOR_HPP
@@ -0,0 +1,75 @@
+#ifndef MPSCQUEUE_HPP
+#define MPSCQUEUE_HPP
+
+#include <atomic>
+#include <utility>
+
+/**
+ * @class MpscQueue
+ * @brief Lock-free unbounded queue with many producers and a single consumer.
+ *
+ * Producers link a new node with one atomic exchange and never wait on each
+ * other or on the consumer. Only one thread may call pop. A pushed value
+ * becomes visible to pop once its producer has finished linking it, so a pop
+ * racing a push may briefly report the queue as empty.
+ */
+template <typename T>
+class MpscQueue {
+public:
+    /**
+     * @brief Constructs an empty queue.
+     */
+    MpscQueue() : m_head(new Node()), m_tail(m_head.load()) {
+    }
+
+    /**
+     * @brief Destructor that frees any values still queued.
+     */
+    ~MpscQueue() {
+        T discarded;
+        while (pop(discarded)) {
+        }
+        delete m_tail;
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /**
+     * @brief Appends a value; safe to call from any thread.
+     * @param value The value to queue.
+     */
+    void push(T value) {
+        Node* node = new Node();
+        node->value = std::move(value);
+        Node* previous = m_head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * @brief Removes the oldest value; only the consumer thread may call this.
+     * @param value Output receiving the value.
+     * @return True if a value was removed, false if the queue was empty.
+     */
+    bool pop(T& value) {
+        Node* next = m_tail->next.load(std::memory_order_acquire);
+        if (!next) {
+            return false;
+        }
+        value = std::move(next->value);
+        delete m_tail;
+        m_tail = next;
+        return true;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value{};
+    };
+
+    std::atomic<Node*> m_head;   // Most recently pushed node, shared by producers
+    Node* m_tail;                // Consumed sentinel; its successor is the oldest value
+};
+
+#endif // MPSCQUEUE_HPP
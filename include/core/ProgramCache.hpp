@@ -0,0 +1,92 @@
+#ifndef PROGRAMCACHE_HPP
+#define PROGRAMCACHE_HPP
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <string>
+
+/**
+ * @class ProgramCache
+ * @brief Versioned cache of linked program binaries, one file per program in a cache directory.
+ *
+ * A program is keyed by a hash of its shader sources (which carry any
+ * defines) and of the GL vendor, renderer and version strings, so a driver
+ * update or another GPU misses the cache instead of loading a binary it
+ * cannot use. Binaries are read with glGetProgramBinary after a link and
+ * handed back with glProgramBinary; a binary the driver rejects is treated
+ * as a miss and the caller compiles from source.
+ *
+ * Needs ARB_get_program_binary (core since OpenGL 4.1) and at least one
+ * binary format; without them every call is a miss. Use it from the thread
+ * that owns the GL context.
+ */
+class ProgramCache {
+public:
+    /// Bumped whenever the file layout changes
+    static constexpr uint32_t VERSION = 1;
+
+    /**
+     * @brief Computes the cache key of a program for the current GL context.
+     * @param vertexSource Vertex shader source code.
+     * @param fragmentSource Fragment shader source code.
+     * @return The 64-bit key.
+     */
+    static uint64_t computeKey(const std::string& vertexSource, const std::string& fragmentSource);
+
+    /**
+     * @brief Loads a cached binary into a program.
+     * @param program A program object with no shaders attached.
+     * @param key Key from computeKey.
+     * @return True if the program was linked from the cache, false if the caller must compile it.
+     */
+    static bool load(GLuint program, uint64_t key);
+
+    /**
+     * @brief Writes the binary of a linked program to the cache.
+     *
+     * The program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+     * @param program The linked program.
+     * @param key Key from computeKey.
+     * @return True if the binary was written, false otherwise.
+     */
+    static bool store(GLuint program, uint64_t key);
+
+    /**
+     * @brief Gets the path of the cache file for a key.
+     * @param key Key from computeKey.
+     * @return The cache file path.
+     */
+    static std::string getCachePath(uint64_t key);
+
+    /**
+     * @brief Checks whether the GL context can save and restore program binaries.
+     * @return True if ARB_get_program_binary is available with at least one binary format.
+     */
+    static bool isSupported();
+
+    /**
+     * @brief Enables or disables the cache for programs linked afterwards.
+     * @param enabled True to load and store program binaries (default: true).
+     */
+    static void setEnabled(bool enabled);
+
+    /**
+     * @brief Checks whether programs are cached.
+     * @return True if the cache is enabled.
+     */
+    static bool isEnabled();
+
+    /**
+     * @brief Sets the directory holding the cache files; it is created on the first store.
+     * @param directory Directory path (default: ".shadercache").
+     */
+    static void setDirectory(const std::string& directory);
+
+    /**
+     * @brief Gets the directory holding the cache files.
+     * @return The directory path.
+     */
+    static const std::string& getDirectory();
+};
+
+#endif // PROGRAMCACHE_HPP
@@ -2,7 +2,71 @@
 #define SHADER_HPP
 
 #include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <string>
+#include <vector>
+
+/**
+ * @struct UniformName
+ * @brief A uniform name together with its 32-bit FNV-1a hash.
+ *
+ * Converts implicitly from a string literal or std::string, so the Shader
+ * setters accept either. Names declared as constexpr UniformName constants
+ * are hashed at compile time; the name must outlive the call it is passed to.
+ */
+struct UniformName {
+    uint32_t hash;       ///< FNV-1a hash of the name
+    const char* text;    ///< The name, used to confirm a match
+
+    /**
+     * @brief Hashes a null-terminated name.
+     * @param name The uniform name as it appears in the shader.
+     */
+    constexpr UniformName(const char* name) : hash(fnv1a(name)), text(name) {}
+
+    /**
+     * @brief Hashes a name held in a string.
+     * @param name The uniform name as it appears in the shader.
+     */
+    UniformName(const std::string& name) : UniformName(name.c_str()) {}
+
+    /**
+     * @brief Computes the 32-bit FNV-1a hash of a null-terminated string.
+     * @param text The string to hash.
+     * @return The hash.
+     */
+    static constexpr uint32_t fnv1a(const char* text) {
+        uint32_t hash = 2166136261u;
+        for (; *text != '\0'; text++) {
+            hash = (hash ^ static_cast<uint8_t>(*text)) * 16777619u;
+        }
+        return hash;
+    }
+};
+
+/**
+ * @struct UniformStats
+ * @brief Counters of a Shader's uniform traffic since the last reset.
+ */
+struct UniformStats {
+    size_t uniformCalls = 0;      ///< glUniform* calls issued
+    size_t lookups = 0;           ///< Names resolved through the reflected table
+    size_t unknownNames = 0;      ///< Lookups of names that are not active uniforms; their sets are skipped
+    size_t locationQueries = 0;   ///< glGetUniformLocation calls, made only while reflecting a program
+};
+
+/**
+ * @enum CompileStatus
+ * @brief State of a background program load started with Shader::beginLoadFromSource.
+ */
+enum class CompileStatus {
+    Idle,        ///< No load in progress
+    Compiling,   ///< The driver is still compiling or linking
+    Linked,      ///< The new program replaced the previous one
+    Failed       ///< Compilation or linking failed; the previous program is kept
+};
 
 /**
  * @class Shader
@@ -10,9 +74,26 @@
  * 
  * This class provides a convenient interface for loading, compiling, and using
  * vertex and fragment shaders. It also provides methods to set uniform values.
+ *
+ * After linking, the active uniforms are reflected once into a table sorted
+ * by name hash, so the setters find a location with a binary search and
+ * never allocate or query GL. Setting a uniform the program does not use
+ * (e.g. one the compiler optimized out) is skipped without a GL call.
+ *
+ * Linked programs are kept in a ProgramCache, so a later start with the same
+ * sources and driver loads the binary instead of compiling.
+ *
+ * A program can also be replaced in the background (beginLoadFromSource and
+ * pollLoad), e.g. when its files change: the previous program stays in use
+ * until the new one has linked, and is kept if it fails. Replacements use a
+ * cached binary when one matches but are not stored, so editing a file does
+ * not leave a cache entry behind for every save.
  */
 class Shader {
 public:
+    /// Called after each link, e.g. to bind uniform blocks and sampler units
+    using LinkCallback = std::function<bool(Shader&)>;
+
     /**
      * @brief Constructs an empty shader program.
      */
@@ -25,17 +106,89 @@ public:
 
     /**
      * @brief Loads and compiles shaders from files.
+     *
+     * The paths are remembered for reloadFromFiles.
      * @param vertexPath Path to the vertex shader source file.
      * @param fragmentPath Path to the fragment shader source file.
      * @return True if loading and compilation succeeded, false otherwise.
      */
     bool loadFromFiles(const std::string& vertexPath, const std::string& fragmentPath);
     
+    /**
+     * @brief Starts reloading the files given to loadFromFiles in the background.
+     * @return True if both files were read and a load was started, false otherwise.
+     */
+    bool reloadFromFiles();
+    
+    /**
+     * @brief Starts compiling and linking a replacement program without waiting for the result.
+     *
+     * With KHR_parallel_shader_compile the driver compiles on its own
+     * threads; otherwise the work happens when pollLoad first asks for the
+     * result. A load already in progress is abandoned. A program found in
+     * the ProgramCache is loaded right away.
+     * @param vertexSource Vertex shader source code.
+     * @param fragmentSource Fragment shader source code.
+     */
+    void beginLoadFromSource(const std::string& vertexSource, const std::string& fragmentSource);
+    
+    /**
+     * @brief Checks on a background load, swapping the new program in once it has linked.
+     *
+     * After Linked, the uniforms are reflected again and the link callback
+     * has run; other uniforms must be set again before drawing. If the
+     * callback rejects the new program, it is deleted and Failed is
+     * returned with the previous program still in place.
+     * @return The state of the load; Idle if none was started.
+     */
+    CompileStatus pollLoad();
+    
+    /**
+     * @brief Sets the function run after the program links, both on a load and on a background reload.
+     * @param callback Returns false if the setup failed; a reload then keeps the previous program.
+     */
+    void setLinkCallback(LinkCallback callback) { m_onLink = std::move(callback); }
+    
+    /**
+     * @brief Checks whether a background load is in progress.
+     * @return True between beginLoadFromSource and the pollLoad that finishes it.
+     */
+    bool isLoading() const { return m_pendingProgram != 0; }
+    
+    /**
+     * @brief Gets the vertex shader file given to loadFromFiles.
+     * @return The path, or an empty string if the shader was loaded from source.
+     */
+    const std::string& getVertexPath() const { return m_vertexPath; }
+    
+    /**
+     * @brief Gets the fragment shader file given to loadFromFiles.
+     * @return The path, or an empty string if the shader was loaded from source.
+     */
+    const std::string& getFragmentPath() const { return m_fragmentPath; }
+    
+    /**
+     * @brief Reads a shader source file.
+     * @param filepath Path to the file.
+     * @return The file contents, or an empty string if it could not be read.
+     */
+    static std::string readFile(const std::string& filepath);
+    
+    /**
+     * @brief Checks whether the driver can compile shaders on background threads.
+     * @return True if KHR_parallel_shader_compile or ARB_parallel_shader_compile is available.
+     */
+    static bool isParallelCompileSupported();
+    
     /**
      * @brief Loads and compiles shaders from source strings.
+     *
+     * Loads the program binary from the ProgramCache when one matches the
+     * sources and driver; otherwise compiles and stores the result. Logs how
+     * long either path took, then runs the link callback.
      * @param vertexSource Vertex shader source code.
      * @param fragmentSource Fragment shader source code.
-     * @return True if compilation succeeded, false otherwise.
+     * @return True if compilation and the link callback succeeded, false otherwise.
      */
     bool loadFromSource(const std::string& vertexSource, const std::string& fragmentSource);
     
@@ -49,28 +202,28 @@ public:
      * @param name Name of the uniform variable in the shader.
      * @param value The boolean value to set.
      */
-    void setBool(const std::string& name, bool value) const;
+    void setBool(UniformName name, bool value) const;
     
     /**
      * @brief Sets an integer uniform value.
      * @param name Name of the uniform variable in the shader.
      * @param value The integer value to set.
      */
-    void setInt(const std::string& name, int value) const;
+    void setInt(UniformName name, int value) const;
     
     /**
      * @brief Sets a float uniform value.
      * @param name Name of the uniform variable in the shader.
      * @param value The float value to set.
      */
-    void setFloat(const std::string& name, float value) const;
+    void setFloat(UniformName name, float value) const;
     
     /**
      * @brief Sets a 4x4 matrix uniform value.
      * @param name Name of the uniform variable in the shader.
      * @param matrix Pointer to a 16-element array representing the matrix (column-major order).
      */
-    void setMat4(const std::string& name, const float* matrix) const;
+    void setMat4(UniformName name, const float* matrix) const;
     
     /**
      * @brief Sets a 3D vector uniform value.
@@ -79,19 +232,76 @@ public:
      * @param y The Y component of the vector.
      * @param z The Z component of the vector.
      */
-    void setVec3(const std::string& name, float x, float y, float z) const;
+    void setVec3(UniformName name, float x, float y, float z) const;
+    
+    /**
+     * @brief Sets a 4D vector uniform value.
+     * @param name Name of the uniform variable in the shader.
+     * @param x The X component of the vector.
+     * @param y The Y component of the vector.
+     * @param z The Z component of the vector.
+     * @param w The W component of the vector.
+     */
+    void setVec4(UniformName name, float x, float y, float z, float w) const;
+    
+    /**
+     * @brief Attaches a uniform block of the program to a binding point.
+     * @param name Name of the uniform block in the shader.
+     * @param binding The binding point, as passed to glBindBufferRange.
+     * @return True if the program has an active block of that name, false otherwise.
+     */
+    bool bindUniformBlock(const char* name, GLuint binding) const;
 
     /**
      * @brief Gets the OpenGL shader program ID.
      * @return The OpenGL program ID.
      */
     GLuint getID() const { return m_programID; }
+    
+    /**
+     * @brief Gets the location of an active uniform from the reflected table.
+     * @param name Name of the uniform variable in the shader.
+     * @return The uniform location, or -1 if the program has no such active uniform.
+     */
+    GLint getUniformLocation(UniformName name) const;
+    
+    /**
+     * @brief Gets the number of names reflected after linking.
+     * @return The table size: one entry per active uniform, plus the base name and each element of arrays.
+     */
+    size_t getUniformCount() const { return m_uniforms.size(); }
+    
+    /**
+     * @brief Gets the uniform counters since the last reset.
+     * @return Reference to the UniformStats.
+     */
+    const UniformStats& getStats() const { return m_stats; }
+    
+    /**
+     * @brief Resets the uniform counters, e.g. at the start of a frame.
+     */
+    void resetStats() const { m_stats = UniformStats(); }
 
 private:
+    struct UniformEntry {
+        uint32_t hash;
+        GLint location;
+        std::string name;
+    };
+    
     GLuint m_programID;
-    std::string readFile(const std::string& filepath);
+    std::vector<UniformEntry> m_uniforms;   // Sorted by hash
+    mutable UniformStats m_stats;
+    std::string m_vertexPath;
+    std::string m_fragmentPath;
+    GLuint m_pendingProgram;
+    GLuint m_pendingShaders[2];
+    LinkCallback m_onLink;
+    
+    void cancelLoad();
     GLuint compileShader(GLenum type, const std::string& source);
     bool linkProgram(GLuint vertexShader, GLuint fragmentShader);
+    void reflectUniforms();
 };
 
 #endif // SHADER_HPP
@@ -0,0 +1,156 @@
+#ifndef SHADERPERMUTATIONS_HPP
+#define SHADERPERMUTATIONS_HPP
+
+#include "core/Shader.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class ShaderPermutations
+ * @brief Builds the variants of a shader for bitmasks of feature defines, on first use.
+ *
+ * The sources are written with #ifdef blocks around optional features. The
+ * variant for a mask is compiled with "#define NAME" for each set bit,
+ * inserted after the #version line, so disabled features cost nothing at
+ * run time. Every variant goes through Shader::loadFromSource and therefore
+ * the ProgramCache, whose key covers the defines.
+ *
+ * Sources read from files can be reloaded: every variant built so far is
+ * recompiled in the background and swapped in by update() once it links,
+ * keeping its previous program until then (or for good, if it fails).
+ *
+ * Use it from the thread that owns the GL context.
+ */
+class ShaderPermutations {
+public:
+    /// Called once after each variant links, e.g. to bind uniform blocks and sampler units
+    using LinkCallback = Shader::LinkCallback;
+
+    /**
+     * @brief Constructs an empty set of permutations.
+     */
+    ShaderPermutations();
+
+    /**
+     * @brief Sets the sources and features, dropping any variants built before.
+     * @param vertexSource Vertex shader source, starting with a #version line.
+     * @param fragmentSource Fragment shader source, starting with a #version line.
+     * @param features Define names, bit 0 first.
+     */
+    void setSource(const std::string& vertexSource, const std::string& fragmentSource,
+                   const std::vector<std::string>& features);
+
+    /**
+     * @brief Reads the sources from files, dropping any variants built before.
+     * @param vertexPath Path to the vertex shader source file.
+     * @param fragmentPath Path to the fragment shader source file.
+     * @param features Define names, bit 0 first.
+     * @return True if both files were read, false otherwise.
+     */
+    bool setSourceFiles(const std::string& vertexPath, const std::string& fragmentPath,
+                        const std::vector<std::string>& features);
+
+    /**
+     * @brief Sets code inserted after the #version line of both sources, before the defines.
+     *
+     * Lets every source share declarations such as uniform blocks. Applies to
+     * variants built afterwards.
+     * @param prelude GLSL code.
+     */
+    void setPrelude(const std::string& prelude) { m_prelude = prelude; }
+
+    /**
+     * @brief Reads the source files again and starts rebuilding every variant in the background.
+     * @return True if both files were read, false if there are none or they could not be read.
+     */
+    bool reloadFromFiles();
+
+    /**
+     * @brief Swaps in the variants whose background rebuild has linked; call once per frame.
+     * @return The number of variants swapped in.
+     */
+    size_t update();
+
+    /**
+     * @brief Checks whether any variant is still being rebuilt.
+     * @return True while a reload is in progress.
+     */
+    bool isReloading() const;
+
+    /**
+     * @brief Gets the vertex shader file given to setSourceFiles.
+     * @return The path, or an empty string if the sources were set directly.
+     */
+    const std::string& getVertexPath() const { return m_vertexPath; }
+
+    /**
+     * @brief Gets the fragment shader file given to setSourceFiles.
+     * @return The path, or an empty string if the sources were set directly.
+     */
+    const std::string& getFragmentPath() const { return m_fragmentPath; }
+
+    /**
+     * @brief Sets the function run on each variant after it links.
+     *
+     * It is handed to every variant's Shader, so a reload it rejects keeps
+     * the variant's previous program.
+     * @param callback Returns false to reject the variant.
+     */
+    void setLinkCallback(LinkCallback callback);
+
+    /**
+     * @brief Gets the variant for a feature mask, building it on first use.
+     * @param mask Bits of the features to enable.
+     * @return The variant, or nullptr if it failed to build (it is retried only by a reload).
+     */
+    const Shader* get(uint32_t mask);
+
+    /**
+     * @brief Inserts the defines of a feature mask after the #version line of a source.
+     * @param source Shader source code.
+     * @param features Define names, bit 0 first.
+     * @param mask Bits of the features to define.
+     * @param prelude Code to insert ahead of the defines.
+     * @return The source with the prelude and defines added.
+     */
+    static std::string addDefines(const std::string& source, const std::vector<std::string>& features,
+                                  uint32_t mask, const std::string& prelude = std::string());
+
+    /**
+     * @brief Gets the number of variants built so far.
+     * @return The variant count, including ones that failed.
+     */
+    size_t getVariantCount() const { return m_variants.size(); }
+
+    /**
+     * @brief Gets the uniform counters of all variants since the last reset.
+     * @return The summed UniformStats.
+     */
+    UniformStats getStats() const;
+
+    /**
+     * @brief Resets the uniform counters of all variants.
+     */
+    void resetStats() const;
+
+    /**
+     * @brief Deletes every variant.
+     */
+    void cleanup();
+
+private:
+    std::string m_vertexSource;
+    std::string m_fragmentSource;
+    std::string m_vertexPath;
+    std::string m_fragmentPath;
+    std::string m_prelude;
+    std::vector<std::string> m_features;
+    LinkCallback m_onLink;
+    std::unordered_map<uint32_t, std::unique_ptr<Shader>> m_variants;   // Program 0 for variants that failed
+};
+
+#endif // SHADERPERMUTATIONS_HPP
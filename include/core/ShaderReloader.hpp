@@ -0,0 +1,81 @@
+#ifndef SHADERRELOADER_HPP
+#define SHADERRELOADER_HPP
+
+#include "core/FileWatcher.hpp"
+#include "core/Shader.hpp"
+#include "core/ShaderPermutations.hpp"
+#include <string>
+#include <vector>
+
+/**
+ * @class ShaderReloader
+ * @brief Recompiles shaders loaded from files when the files change, without stalling a frame.
+ *
+ * update() polls a FileWatcher and starts a background reload of every
+ * registered Shader or ShaderPermutations that uses a changed file; later
+ * calls swap each program in once the driver has linked it. Until then,
+ * and for good if the new source fails to compile, the previous program
+ * keeps rendering.
+ *
+ * The registered shaders must outlive the reloader or be removed from it
+ * first. Use it from the thread that owns the GL context.
+ */
+class ShaderReloader {
+public:
+    /**
+     * @brief Constructs a reloader watching nothing.
+     */
+    ShaderReloader();
+
+    /**
+     * @brief Watches the files of a shader loaded with Shader::loadFromFiles.
+     *
+     * State set after loading (uniform block bindings, sampler units) belongs
+     * to the old program; set it in Shader::setLinkCallback so reloads get it too.
+     * @param shader The shader to reload.
+     * @return True if both files are watched, false otherwise.
+     */
+    bool add(Shader& shader);
+
+    /**
+     * @brief Watches the files of permutations set up with ShaderPermutations::setSourceFiles.
+     * @param permutations The permutations to reload.
+     * @return True if both files are watched, false otherwise.
+     */
+    bool add(ShaderPermutations& permutations);
+
+    /**
+     * @brief Stops reloading a shader.
+     * @param shader A shader passed to add.
+     */
+    void remove(const Shader& shader);
+
+    /**
+     * @brief Stops reloading permutations.
+     * @param permutations Permutations passed to add.
+     */
+    void remove(const ShaderPermutations& permutations);
+
+    /**
+     * @brief Starts reloads for changed files and swaps in programs that have linked; call once per frame.
+     * @return The number of programs swapped in.
+     */
+    size_t update();
+
+    /**
+     * @brief Gets the number of reloads started since construction.
+     * @return The count of file changes that triggered a recompile.
+     */
+    size_t getReloadCount() const { return m_reloadCount; }
+
+private:
+    FileWatcher m_watcher;
+    std::vector<Shader*> m_shaders;
+    std::vector<ShaderPermutations*> m_permutations;
+    std::vector<std::string> m_changed;
+    size_t m_reloadCount;
+
+    bool isChanged(const std::string& vertexPath, const std::string& fragmentPath) const;
+};
+
+#endif // SHADERRELOADER_HPP
@@ -0,0 +1,160 @@
+#ifndef STAGINGRING_HPP
+#define STAGINGRING_HPP
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @struct StagingStats
+ * @brief Counters of a StagingRing since it was initialized.
+ */
+struct StagingStats {
+    size_t acquiredSlots = 0;     ///< Slots handed out for copies
+    size_t transfers = 0;         ///< Slots whose contents were transferred and fenced
+    size_t rejectedAcquires = 0;  ///< Acquires refused because every slot was still in flight
+};
+
+/**
+ * @class StagingRing
+ * @brief Ring of mapped staging buffers for asynchronous uploads.
+ *
+ * A slot is a buffer of getSlotBytes() bytes. The GL thread acquires a free
+ * slot, any thread copies data through its pointer, and the GL thread then
+ * issues transfers that read from the slot's buffer (a texture upload from
+ * GL_PIXEL_UNPACK_BUFFER or a glCopyBufferSubData) between beginTransfer and
+ * endTransfer. endTransfer places a fence after them, and the slot is only
+ * handed out again once the GPU has passed that fence, so the driver never
+ * has to copy or wait on data still being read.
+ *
+ * With ARB_buffer_storage the slots are persistently mapped once. Otherwise
+ * each acquire orphans the slot's storage and maps it again, and
+ * beginTransfer unmaps it.
+ *
+ * All methods except getPointer must be called on the thread that owns the
+ * GL context.
+ */
+class StagingRing {
+public:
+    /// Slots created by default
+    static constexpr size_t DEFAULT_SLOT_COUNT = 8;
+    /// Size of each slot by default
+    static constexpr size_t DEFAULT_SLOT_BYTES = 4 * 1024 * 1024;
+
+    /**
+     * @brief Constructs an empty ring; call initialize once a GL context is current.
+     */
+    StagingRing();
+
+    /**
+     * @brief Destructor that frees the staging buffers.
+     */
+    ~StagingRing();
+
+    StagingRing(const StagingRing&) = delete;
+    StagingRing& operator=(const StagingRing&) = delete;
+
+    /**
+     * @brief Creates the staging buffers, replacing any previous ones.
+     * @param slotCount Number of slots, i.e. the most copies and transfers in flight.
+     * @param slotBytes Size of each slot.
+     * @return True if the buffers were created, false otherwise.
+     */
+    bool initialize(size_t slotCount = DEFAULT_SLOT_COUNT, size_t slotBytes = DEFAULT_SLOT_BYTES);
+
+    /**
+     * @brief Frees the staging buffers; no slot may be in use by a copy.
+     */
+    void cleanup();
+
+    /**
+     * @brief Takes a free slot for a copy.
+     *
+     * Slots are reused in ring order once the GPU has finished their last
+     * transfer. Never waits for the GPU.
+     * @param bytes Bytes about to be copied, at most getSlotBytes().
+     * @return The slot index, or -1 if every slot is in flight or bytes does not fit.
+     */
+    int acquire(size_t bytes);
+
+    /**
+     * @brief Gets the mapped memory of an acquired slot; safe to write from any thread.
+     * @param slot An acquired slot.
+     * @return Pointer to getSlotBytes() writable bytes, valid until beginTransfer or release.
+     */
+    unsigned char* getPointer(int slot) const { return m_slots[slot].pointer; }
+
+    /**
+     * @brief Makes a filled slot readable by the GPU; the copy into it must be complete.
+     * @param slot An acquired slot.
+     * @return The buffer to read from, starting at offset 0.
+     */
+    GLuint beginTransfer(int slot);
+
+    /**
+     * @brief Fences the transfers issued since beginTransfer and returns the slot to the ring.
+     * @param slot The slot passed to beginTransfer.
+     */
+    void endTransfer(int slot);
+
+    /**
+     * @brief Returns an acquired slot to the ring without transferring it.
+     * @param slot An acquired slot whose copy is complete or was never started.
+     */
+    void release(int slot);
+
+    /**
+     * @brief Checks whether the staging buffers exist.
+     * @return True after a successful initialize.
+     */
+    bool isValid() const { return !m_slots.empty(); }
+
+    /**
+     * @brief Checks whether the slots are persistently mapped.
+     * @return True if ARB_buffer_storage was available at initialize.
+     */
+    bool isPersistent() const { return m_persistent; }
+
+    /**
+     * @brief Gets the size of each slot.
+     * @return The largest copy one slot can hold, in bytes.
+     */
+    size_t getSlotBytes() const { return m_slotBytes; }
+
+    /**
+     * @brief Gets the number of slots.
+     * @return The slot count, 0 if not initialized.
+     */
+    size_t getSlotCount() const { return m_slots.size(); }
+
+    /**
+     * @brief Gets the usage counters.
+     * @return Reference to the StagingStats.
+     */
+    const StagingStats& getStats() const { return m_stats; }
+
+private:
+    enum class SlotState {
+        Free,       ///< Available, possibly with a pending fence
+        Acquired,   ///< Being filled or transferred
+    };
+
+    struct Slot {
+        GLuint buffer = 0;
+        unsigned char* pointer = nullptr;
+        GLsync fence = nullptr;
+        SlotState state = SlotState::Free;
+    };
+
+    std::vector<Slot> m_slots;
+    size_t m_slotBytes;
+    size_t m_next;
+    bool m_persistent;
+    StagingStats m_stats;
+
+    bool isIdle(Slot& slot);
+    bool map(Slot& slot);
+    void unmap(Slot& slot);
+};
+
+#endif // STAGINGRING_HPP
@@ -2,7 +2,50 @@
 #define TEXTURE_HPP
 
 #include <GL/glew.h>
+#include "core/TextureCache.hpp"
+#include <memory>
 #include <string>
+#include <vector>
+
+/**
+ * @struct TextureImage
+ * @brief Decoded image pixels waiting to be uploaded, tightly packed rows.
+ *
+ * Three-channel images are stored with an opaque alpha byte so every pixel is
+ * 4-byte aligned for the SIMD mip filter; hasAlpha records whether the source
+ * had a real alpha channel.
+ *
+ * A block-compressed image carries its levels in compressedLevels instead,
+ * pointing either into compressedStorage or into a mapped TextureCache, so
+ * an image must be moved rather than copied.
+ */
+struct TextureImage {
+    std::vector<unsigned char> pixels;                ///< Base level
+    std::vector<std::vector<unsigned char>> mips;     ///< Levels 1..n; empty lets the driver build them
+    int width = 0;
+    int height = 0;
+    int channels = 0;                                 ///< Bytes per pixel in pixels and mips
+    bool hasAlpha = false;
+    
+    BlockFormat compressedFormat = BlockFormat::BC1;
+    std::vector<TextureCache::Level> compressedLevels;             ///< Empty for uncompressed images
+    std::vector<std::vector<unsigned char>> compressedStorage;     ///< Blocks encoded by this load
+    std::shared_ptr<TextureCache> cache;                           ///< Keeps mapped levels alive
+    
+    /**
+     * @brief Gets the number of levels held, compressed or not.
+     * @return The level count, 0 for an empty image.
+     */
+    int getLevelCount() const;
+    
+    /**
+     * @brief Gets the data of one level, compressed or not.
+     * @param level Level index, less than getLevelCount().
+     * @param bytes Output receiving the size of the level.
+     * @return Pointer to the level's pixels or blocks.
+     */
+    const unsigned char* getLevel(int level, size_t& bytes) const;
+};
 
 /**
  * @class Texture
@@ -10,9 +53,31 @@
  * 
  * This class provides functionality for loading image files as OpenGL textures
  * and managing their lifecycle. It uses stb_image for image loading.
+ *
+ * Loading is split in two so decoding can run off the GL thread: decodeFile
+ * touches no GL state, and upload creates the GL texture from its result.
+ *
+ * With compression enabled (the default), the first load of an image encodes
+ * its mip chain with BlockCompressor and stores it in a TextureCache next to
+ * the image; later loads map that file and upload the blocks directly, with
+ * no image decode.
+ *
+ * A progressive upload creates only the coarse tail of the mip chain and
+ * streams the finer levels in later frames (see TextureStreamer), sampling
+ * being clamped to the resident levels through GL_TEXTURE_BASE_LEVEL. An
+ * image that is not decoded yet is drawn with a placeholder until
+ * TextureStreamer has decoded it on a worker.
+ *
+ * A texture uploaded from a shared TextureImage keeps it, so levels evicted
+ * by setBaseLevel can be uploaded again without reading them back from the
+ * GPU. For a cached compressed image that only holds the mapped .texcache;
+ * otherwise the decoded levels stay in system memory.
  */
 class Texture {
 public:
+    /// Levels whose larger dimension is at most this many pixels are uploaded first when streaming
+    static constexpr int STREAM_TAIL_SIZE = 64;
+
     /**
      * @brief Constructs an empty texture object.
      */
@@ -30,6 +95,105 @@ public:
      */
     bool loadFromFile(const std::string& filepath);
     
+    /**
+     * @brief Decodes an image file into memory without touching GL state.
+     *
+     * Safe to call from any thread. The mip chain is built with MipGenerator,
+     * splitting each level into row bands on the shared thread pool. With
+     * compression enabled, an up-to-date TextureCache is mapped instead, or
+     * written after encoding the chain. Without mips the cache is skipped and
+     * the pixels stay uncompressed.
+     * @param filepath Path to the image file to decode.
+     * @param image Output receiving the pixels, flipped so the first row is the bottom.
+     * @param generateMips True to build the full mip chain on the CPU.
+     * @return True if decoding succeeded, false otherwise.
+     */
+    static bool decodeFile(const std::string& filepath, TextureImage& image, bool generateMips = true);
+    
+    /**
+     * @brief Creates the GL texture and its mipmaps from decoded pixels.
+     *
+     * Compressed levels go through glCompressedTexImage2D. Otherwise each
+     * level in image.mips is uploaded explicitly; without them the driver
+     * generates the chain with glGenerateMipmap.
+     * @param image The decoded image.
+     * @return True if the image was uploaded, false if it was empty.
+     */
+    bool upload(const TextureImage& image);
+    
+    /**
+     * @brief Creates the GL texture from decoded pixels and keeps the image to restore evicted levels from.
+     * @param image The decoded image.
+     * @return True if the image was uploaded, false if it was empty.
+     */
+    bool upload(const std::shared_ptr<const TextureImage>& image);
+    
+    /**
+     * @brief Creates the GL texture with only its coarsest levels, keeping the image to stream the rest.
+     *
+     * Levels no larger than STREAM_TAIL_SIZE are uploaded right away and
+     * GL_TEXTURE_BASE_LEVEL is clamped to them, so the texture can be drawn
+     * at once; streamNextLevel then adds the finer levels one by one. Images
+     * without a CPU mip chain are uploaded whole.
+     * @param image The decoded image, kept to stream from and to restore evicted levels from.
+     * @return True if the image was uploaded, false if it was empty.
+     */
+    bool uploadProgressive(const std::shared_ptr<const TextureImage>& image);
+    
+    /**
+     * @brief Creates a 1x1 mid-grey texture to sample while the real image is still being decoded.
+     *
+     * A later upload or uploadProgressive replaces it.
+     * @return True if the texture was created.
+     */
+    bool uploadPlaceholder();
+    
+    /**
+     * @brief Checks whether the texture holds the placeholder from uploadPlaceholder.
+     * @return True until the real image is uploaded.
+     */
+    bool isPlaceholder() const { return m_placeholder; }
+    
+    /**
+     * @brief Uploads the next finer level of a progressive upload and lets sampling use it.
+     * @return Bytes uploaded, or 0 if the texture is not streaming.
+     */
+    size_t streamNextLevel();
+
+    /**
+     * @brief Uploads a band of rows of the next streamed level from a staging buffer.
+     *
+     * The first band (firstRow 0) defines the level's storage. Bands must
+     * arrive in order; once the last one is uploaded, sampling moves to the
+     * level as with streamNextLevel.
+     * @param level The level below getBaseLevel().
+     * @param firstRow First row of the band, in getLevelRows units.
+     * @param rowCount Number of rows in the band.
+     * @param buffer Buffer holding the band's bytes from offset 0, bound to GL_PIXEL_UNPACK_BUFFER for the upload.
+     * @return Bytes uploaded, or 0 if the texture is not streaming that level.
+     */
+    size_t streamLevelRows(int level, int firstRow, int rowCount, GLuint buffer);
+
+    /**
+     * @brief Gets how a level divides into rows for banded uploads.
+     * @param level Level index, less than getLevelCount().
+     * @param rowBytes Output receiving the size of one row (a row of 4x4 blocks when compressed).
+     * @return The number of rows.
+     */
+    int getLevelRows(int level, size_t& rowBytes) const;
+
+    /**
+     * @brief Checks whether a progressive upload still has levels to stream.
+     * @return True until the full-resolution level is uploaded.
+     */
+    bool isStreaming() const { return m_streamImage != nullptr; }
+    
+    /**
+     * @brief Gets the image a progressive upload streams from.
+     * @return The image, or nullptr if the texture is not streaming.
+     */
+    const std::shared_ptr<const TextureImage>& getStreamImage() const { return m_streamImage; }
+    
     /**
      * @brief Binds the texture to the specified texture unit.
      * @param unit The texture unit to bind to (default is 0).
@@ -57,14 +221,140 @@ public:
      * @return True if the texture is loaded and valid, false otherwise.
      */
     bool isValid() const { return m_textureID != 0; }
+    
+    /**
+     * @brief Gets the GPU memory of the full mip chain.
+     * @return Size in bytes as uploaded (driver padding not included), counting evicted levels.
+     */
+    size_t getMemoryBytes() const { return m_memoryBytes; }
+    
+    /**
+     * @brief Checks whether the texture was uploaded block-compressed.
+     * @return True if the levels are BC1, BC3, BC4 or BC5.
+     */
+    bool isCompressed() const { return m_compressed; }
+    
+    /**
+     * @brief Enables or disables block compression for images decoded afterwards.
+     * @param enabled True to compress and cache textures (default: true).
+     */
+    static void setCompressionEnabled(bool enabled);
+    
+    /**
+     * @brief Checks whether images are block-compressed on load.
+     * @return True if compression is enabled.
+     */
+    static bool isCompressionEnabled();
+    
+    /**
+     * @brief Checks whether the GL context can sample a block format.
+     *
+     * BC4 and BC5 are core since OpenGL 3.0; BC1 and BC3 need EXT_texture_compression_s3tc.
+     * @param format The block format.
+     * @return True if the format is supported.
+     */
+    static bool isFormatSupported(BlockFormat format);
+    
+    /**
+     * @brief Enables or disables progressive uploads for models loaded afterwards.
+     * @param enabled True to upload the coarse levels first and stream the rest (default: true).
+     */
+    static void setStreamingEnabled(bool enabled);
+    
+    /**
+     * @brief Checks whether models upload their textures progressively.
+     * @return True if streaming is enabled.
+     */
+    static bool isStreamingEnabled();
+    
+    /**
+     * @brief Gets the width of the full-resolution level.
+     * @return Width in pixels, even while top levels are evicted.
+     */
+    int getWidth() const { return m_width; }
+    
+    /**
+     * @brief Gets the height of the full-resolution level.
+     * @return Height in pixels, even while top levels are evicted.
+     */
+    int getHeight() const { return m_height; }
+    
+    /**
+     * @brief Gets the GL internal format of the levels.
+     * @return A sized or block-compressed format, or 0 if not loaded.
+     */
+    GLenum getInternalFormat() const { return m_internalFormat; }
+    
+    /**
+     * @brief Gets the pixel format used to upload and read back uncompressed levels.
+     * @return GL_RED, GL_RG, GL_RGB or GL_RGBA; 0 for compressed textures.
+     */
+    GLenum getPixelFormat() const { return m_pixelFormat; }
+    
+    /**
+     * @brief Gets the number of mip levels, including the base level.
+     * @return The level count, or 0 if not loaded.
+     */
+    int getLevelCount() const { return static_cast<int>(m_levelBytes.size()); }
+    
+    /**
+     * @brief Gets the size of one mip level.
+     * @param level Level index, less than getLevelCount().
+     * @return Size in bytes as uploaded.
+     */
+    size_t getLevelBytes(int level) const { return m_levelBytes[level]; }
+    
+    /**
+     * @brief Gets the finest level currently on the GPU.
+     * @return GL_TEXTURE_BASE_LEVEL of the texture (0 when fully resident).
+     */
+    int getBaseLevel() const { return m_baseLevel; }
+    
+    /**
+     * @brief Gets the GPU memory used by the resident levels.
+     * @return Size in bytes of levels getBaseLevel() and coarser.
+     */
+    size_t getResidentBytes() const { return m_residentBytes; }
+    
+    /**
+     * @brief Checks whether setBaseLevel can evict levels.
+     * @return True if the texture kept the image holding every one of its levels.
+     */
+    bool isEvictable() const;
+    
+    /**
+     * @brief Evicts or restores the finest mip levels.
+     *
+     * Raising the base level sets GL_TEXTURE_BASE_LEVEL so sampling starts at
+     * the new level, then redefines the dropped levels as empty so the driver
+     * frees their storage. Lowering it uploads those levels again from the
+     * kept image. Sampling always stays complete. Has no effect while the
+     * texture is streaming or when it is not evictable.
+     * @param level New base level, clamped to the coarsest level.
+     */
+    void setBaseLevel(int level);
 
 private:
     GLuint m_textureID;
     int m_width;
     int m_height;
     int m_channels;
+    size_t m_memoryBytes;
+    bool m_compressed;
+    GLenum m_internalFormat;
+    GLenum m_pixelFormat;
+    std::vector<size_t> m_levelBytes;
+    int m_baseLevel;
+    size_t m_residentBytes;
+    std::shared_ptr<const TextureImage> m_streamImage;
+    std::shared_ptr<const TextureImage> m_sourceImage;   // Evicted levels are restored from it
+    bool m_placeholder;
     
-    unsigned char* loadImageData(const std::string& filepath);
+    static bool loadCompressed(const std::string& filepath, TextureImage& image);
+    static void compressImage(const std::string& filepath, TextureImage& image);
+    bool createLevels(const TextureImage& image, int firstLevel);
+    void uploadLevel(const TextureImage& image, int level);
+    void finishStreamedLevel(int level);
 };
 
 #endif // TEXTURE_HPP
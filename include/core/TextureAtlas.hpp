@@ -0,0 +1,130 @@
+#ifndef TEXTUREATLAS_HPP
+#define TEXTUREATLAS_HPP
+
+#include <GL/glew.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class Texture;
+
+/**
+ * @struct AtlasRegion
+ * @brief Where a texture lives in a TextureAtlas.
+ *
+ * A texture coordinate uv maps to offset + fract(uv) * scale in the given
+ * layer, so repeating textures keep wrapping inside their region.
+ */
+struct AtlasRegion {
+    int layer = 0;                      ///< Layer of the array texture
+    float uvScale[2] = {1.0f, 1.0f};    ///< Size of the region in layer UV units
+    float uvOffset[2] = {0.0f, 0.0f};   ///< Corner of the region in layer UV units
+};
+
+/**
+ * @class TextureAtlas
+ * @brief Merges textures into one GL_TEXTURE_2D_ARRAY so they can be sampled with a single bind.
+ *
+ * When every texture has the same size, level count and internal format,
+ * each becomes one layer holding its full mip chain in its own format,
+ * compressed or not. Otherwise textures are shelf-packed into RGBA8 pages
+ * of at least PAGE_SIZE pixels, one page per layer, each region surrounded
+ * by PADDING texels that repeat the texture so filtering across its edges
+ * wraps as GL_REPEAT would. Packed pages keep levels 0 to PACKED_MAX_LEVEL
+ * only, the coarsest level at which the padding still separates regions.
+ * Block-compressed textures are decoded into those pages, so mixing sizes
+ * costs them 4x (BC3) or 8x (BC1) their compressed memory; give them a
+ * common size to keep them compressed in one layer each.
+ *
+ * Building fails, leaving textures to be bound on their own, if the layers
+ * or pages exceed GL_MAX_ARRAY_TEXTURE_LAYERS or a page exceeds
+ * GL_MAX_TEXTURE_SIZE.
+ *
+ * The texels are copied from the source textures, whose pending streamed
+ * and evicted levels are made resident first. Sample with textureGrad on
+ * the unwrapped coordinates' derivatives so mip selection ignores the wrap.
+ */
+class TextureAtlas {
+public:
+    /// Smallest side of a packed page
+    static constexpr int PAGE_SIZE = 2048;
+    /// Wrapped texels around each packed region
+    static constexpr int PADDING = 16;
+    /// Coarsest level kept for packed pages (2^PACKED_MAX_LEVEL == PADDING)
+    static constexpr int PACKED_MAX_LEVEL = 4;
+
+    /**
+     * @brief Constructs an empty atlas.
+     */
+    TextureAtlas();
+
+    /**
+     * @brief Destructor that frees the array texture.
+     */
+    ~TextureAtlas();
+
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    /**
+     * @brief Builds the array texture from a set of textures, replacing any previous contents.
+     * @param textures Textures to merge; duplicates and invalid textures are skipped.
+     * @return True if at least one texture was merged, false otherwise or if the GL limits are exceeded.
+     */
+    bool build(const std::vector<std::shared_ptr<Texture>>& textures);
+
+    /**
+     * @brief Looks up the region of a merged texture.
+     * @param texture A texture passed to the last build.
+     * @param region Output receiving the layer and UV transform.
+     * @return True if the texture is in the atlas, false otherwise.
+     */
+    bool getRegion(const Texture& texture, AtlasRegion& region) const;
+
+    /**
+     * @brief Binds the array texture to a texture unit.
+     * @param unit The texture unit to bind to.
+     */
+    void bind(unsigned int unit) const;
+
+    /**
+     * @brief Frees the array texture and forgets all regions.
+     */
+    void cleanup();
+
+    /**
+     * @brief Checks whether the atlas holds any texture.
+     * @return True after a successful build.
+     */
+    bool isValid() const { return m_textureID != 0; }
+
+    /**
+     * @brief Checks whether textures were packed into pages rather than given a layer each.
+     * @return True for the mixed-size fallback.
+     */
+    bool isPacked() const { return m_packed; }
+
+    /**
+     * @brief Gets the number of layers of the array texture.
+     * @return The layer count, 0 if empty.
+     */
+    int getLayerCount() const { return m_layerCount; }
+
+    /**
+     * @brief Gets the GPU memory of the array texture.
+     * @return Size in bytes of all layers and levels.
+     */
+    size_t getMemoryBytes() const { return m_memoryBytes; }
+
+private:
+    GLuint m_textureID;
+    bool m_packed;
+    int m_layerCount;
+    size_t m_memoryBytes;
+    std::unordered_map<const Texture*, AtlasRegion> m_regions;
+
+    bool buildLayers(const std::vector<Texture*>& textures);
+    bool buildPacked(const std::vector<Texture*>& textures);
+};
+
+#endif // TEXTUREATLAS_HPP
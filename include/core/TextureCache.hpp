@@ -0,0 +1,107 @@
+#ifndef TEXTURECACHE_HPP
+#define TEXTURECACHE_HPP
+
+#include "core/BlockCompressor.hpp"
+#include "core/MappedFile.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class TextureCache
+ * @brief Versioned container of a block-compressed mip chain, stored next to its image.
+ *
+ * Holds every level of a texture in a BlockFormat, so a later load can map
+ * the file and hand the levels to glCompressedTexImage2D without decoding
+ * the image. Like MeshCache, it is keyed by the source path, size,
+ * modification time and content hash; a cache that only matches by content
+ * hash is accepted and flagged for a header refresh.
+ */
+class TextureCache {
+public:
+    /// Bumped whenever the file layout or the encoder output changes
+    static constexpr uint32_t VERSION = 1;
+
+    /**
+     * @struct Level
+     * @brief One compressed mip level.
+     */
+    struct Level {
+        const unsigned char* data = nullptr;   ///< Compressed blocks
+        size_t size = 0;                       ///< Size of the blocks in bytes
+        int width = 0;                         ///< Level width in pixels
+        int height = 0;                        ///< Level height in pixels
+    };
+
+    /**
+     * @brief Constructs a closed cache.
+     */
+    TextureCache();
+
+    /**
+     * @brief Maps and validates the cache belonging to a source image.
+     *
+     * The file must hold the full mip chain of its base level; anything
+     * shorter is rejected.
+     * @param sourcePath Path of the image file the cache was built from.
+     * @return True if a valid, up-to-date cache was opened, false otherwise.
+     */
+    bool open(const std::string& sourcePath);
+
+    /**
+     * @brief Unmaps the cache file.
+     */
+    void close();
+
+    /**
+     * @brief Writes a cache for a source image.
+     * @param sourcePath Path of the image file.
+     * @param format Block format of the levels.
+     * @param hasAlpha True if the source image had an alpha channel.
+     * @param levels Compressed levels, base level first; the full chain down to 1x1.
+     * @return True if the cache was written, false otherwise.
+     */
+    static bool write(const std::string& sourcePath, BlockFormat format, bool hasAlpha,
+                      const std::vector<Level>& levels);
+
+    /**
+     * @brief Gets the path of the cache file for a source image.
+     * @param sourcePath Path of the image file.
+     * @return The cache file path.
+     */
+    static std::string getCachePath(const std::string& sourcePath);
+
+    /**
+     * @brief Gets the block format of the cached levels.
+     * @return The block format.
+     */
+    BlockFormat getFormat() const { return m_format; }
+
+    /**
+     * @brief Checks whether the source image had an alpha channel.
+     * @return True if it had alpha.
+     */
+    bool hasAlpha() const { return m_hasAlpha; }
+
+    /**
+     * @brief Gets the cached levels (pointing into the mapping), base level first.
+     * @return Reference to the levels.
+     */
+    const std::vector<Level>& getLevels() const { return m_levels; }
+
+    /**
+     * @brief Checks whether the cache matched by content hash only.
+     * @return True if the source's stamp changed and the cache should be rewritten.
+     */
+    bool needsRefresh() const { return m_needsRefresh; }
+
+private:
+    MappedFile m_file;
+    BlockFormat m_format;
+    bool m_hasAlpha;
+    std::vector<Level> m_levels;
+    bool m_needsRefresh;
+};
+
+#endif // TEXTURECACHE_HPP
@@ -0,0 +1,138 @@
+#ifndef TEXTURERESIDENCYMANAGER_HPP
+#define TEXTURERESIDENCYMANAGER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+class Texture;
+
+/**
+ * @struct TextureResidencyStats
+ * @brief Memory usage and eviction counters of a TextureResidencyManager.
+ */
+struct TextureResidencyStats {
+    size_t textureCount = 0;       ///< Live textures being tracked
+    size_t budgetBytes = 0;        ///< Configured budget (0 means unlimited)
+    size_t residentBytes = 0;      ///< GPU memory of the resident levels
+    size_t fullBytes = 0;          ///< GPU memory if every level were resident
+    size_t evictedLevels = 0;      ///< Levels evicted since creation
+    size_t evictedBytes = 0;       ///< Bytes freed by those evictions
+    size_t restoredLevels = 0;     ///< Levels uploaded again since creation
+    size_t restoredBytes = 0;      ///< Bytes uploaded by those restores
+    size_t deferredRestores = 0;   ///< Restores postponed because they did not fit the budget
+    size_t overBudgetFrames = 0;   ///< Frames that ended above budget with nothing left to evict
+};
+
+/**
+ * @class TextureResidencyManager
+ * @brief Keeps the textures' resident mip levels within a GPU memory budget.
+ *
+ * Each frame, drawn objects request the finest level they can resolve on
+ * screen for each of their textures. When the resident levels exceed the
+ * budget, update() evicts the finest levels of textures (Texture::setBaseLevel),
+ * in this order: textures not drawn this frame, least recently drawn first;
+ * then drawn textures holding finer levels than requested; then all drawn
+ * textures, one level at a time, largest first, so detail degrades evenly.
+ * Levels no larger than MIN_RESIDENT_SIZE are never evicted.
+ *
+ * A drawn texture whose base level is coarser than requested gets one level
+ * back per frame, coarsest first, if it fits in the budget after evicting
+ * textures that were not drawn. Restores never evict drawn textures, so a
+ * budget too small for the visible set settles instead of thrashing.
+ *
+ * Textures still streaming their levels in (Texture::isStreaming) count
+ * towards the resident size but are neither evicted nor restored.
+ *
+ * Textures are tracked by weak reference and dropped once destroyed. With no
+ * budget (the default), nothing is evicted. Not thread-safe; use it from the
+ * thread that owns the GL context.
+ */
+class TextureResidencyManager {
+public:
+    /// Levels whose larger dimension is at most this many pixels stay resident
+    static constexpr int MIN_RESIDENT_SIZE = 64;
+
+    /**
+     * @brief Sets the GPU memory budget for textures.
+     * @param bytes Largest resident size, or 0 for no limit (the default).
+     */
+    void setBudget(size_t bytes) { m_budget = bytes; }
+
+    /**
+     * @brief Gets the GPU memory budget for textures.
+     * @return The budget in bytes, 0 if unlimited.
+     */
+    size_t getBudget() const { return m_budget; }
+
+    /**
+     * @brief Starts accounting a texture; tracking the same texture again has no effect.
+     * @param texture The uploaded texture.
+     */
+    void track(const std::shared_ptr<Texture>& texture);
+
+    /**
+     * @brief Records that a texture is drawn this frame.
+     *
+     * Several requests for the same texture in one frame keep the finest level.
+     * @param texture A tracked texture; untracked textures are ignored.
+     * @param level Finest level the draw can resolve (0 for full resolution).
+     */
+    void request(const Texture& texture, int level);
+
+    /**
+     * @brief Evicts a texture down to the levels no larger than MIN_RESIDENT_SIZE.
+     *
+     * For textures whose pixels are sampled from elsewhere, e.g. a
+     * TextureAtlas; a later request brings the levels back one per frame.
+     * @param texture The texture.
+     */
+    void evictToTail(Texture& texture);
+
+    /**
+     * @brief Brings back every evicted level of a texture at once.
+     * @param texture The texture.
+     */
+    void restore(Texture& texture);
+
+    /**
+     * @brief Restores requested levels and enforces the budget, then starts the next frame.
+     *
+     * Call once per frame after all requests.
+     */
+    void update();
+
+    /**
+     * @brief Gets the memory usage as of the last update and the cumulative counters.
+     * @return Reference to the TextureResidencyStats.
+     */
+    const TextureResidencyStats& getStats() const { return m_stats; }
+
+    /**
+     * @brief Gets the process-wide manager used by Scene.
+     * @return Reference to the shared manager (created on first use).
+     */
+    static TextureResidencyManager& shared();
+
+private:
+    struct Entry {
+        std::weak_ptr<Texture> texture;
+        uint64_t lastUsedFrame = 0;
+        int requestedLevel = 0;
+        bool used = false;
+    };
+
+    std::unordered_map<const Texture*, Entry> m_entries;
+    size_t m_budget = 0;
+    uint64_t m_frame = 1;
+    size_t m_residentBytes = 0;
+    TextureResidencyStats m_stats;
+
+    static int getMaxBaseLevel(const Texture& texture);
+    void setBaseLevel(Texture& texture, int level);
+    bool isOverBudget(size_t extraBytes = 0) const;
+    void evictUnused(size_t extraBytes);
+};
+
+#endif // TEXTURERESIDENCYMANAGER_HPP
@@ -0,0 +1,144 @@
+#ifndef TEXTURESTREAMER_HPP
+#define TEXTURESTREAMER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+class StagingRing;
+class Texture;
+class ThreadPool;
+struct TextureImage;
+
+/**
+ * @class TextureStreamer
+ * @brief Decodes textures off the GL thread and streams their finer mip levels.
+ *
+ * A texture handed to streamFile() holds a placeholder while a worker
+ * decodes its image (mapping its TextureCache when up to date, otherwise
+ * stb decode, mip generation and compression); the first update() after the
+ * decode finishes uploads the coarse tail of the chain, and the finer levels
+ * then stream like those of a texture handed to stream().
+ *
+ * For each texture handed to stream(), a worker reads the pending levels of
+ * its image, coarsest first, so that levels mapped from a TextureCache are
+ * paged in off the GL thread. Each frame, update() uploads the levels that
+ * are ready on the GL thread, one level per texture per pass in round-robin
+ * order, until the byte budget is spent. Sampling is clamped to the levels
+ * uploaded so far, so textures sharpen over a few frames instead of
+ * stalling the frame in which their models appear.
+ *
+ * Given a StagingRing, update() instead splits the pending levels into
+ * bands of rows that fit a staging slot and has workers copy them into the
+ * ring; the next update() issues the uploads of the copied bands from the
+ * ring's buffers, in order, so the GL thread never copies texel data itself.
+ */
+class TextureStreamer {
+public:
+    /**
+     * @brief Constructs a streamer that reads levels on a thread pool.
+     * @param pool Pool running the read-ahead tasks.
+     */
+    explicit TextureStreamer(ThreadPool& pool);
+
+    /**
+     * @brief Destructor that waits for the read-ahead tasks still running.
+     */
+    ~TextureStreamer();
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    /**
+     * @brief Starts streaming the remaining levels of a texture.
+     * @param texture A texture created by Texture::uploadProgressive; ignored if it is not streaming.
+     */
+    void stream(const std::shared_ptr<Texture>& texture);
+
+    /**
+     * @brief Decodes an image file on a worker, then streams it into a texture.
+     *
+     * The texture is sampled as is until the decode finishes; if decoding
+     * fails it is left unchanged.
+     * @param texture Texture to receive the image, e.g. one created by Texture::uploadPlaceholder.
+     * @param path Path of the image file.
+     */
+    void streamFile(const std::shared_ptr<Texture>& texture, const std::string& path);
+
+    /**
+     * @brief Uploads ready levels within a byte budget; call once per frame on the GL thread.
+     *
+     * At least one level is uploaded per call when one is ready, so a level
+     * larger than the budget still gets through. Textures destroyed while
+     * streaming are dropped.
+     *
+     * With a staging ring, the budget applies to the bytes staged for the
+     * next call, at least one band per call, and the bands staged by earlier
+     * calls whose copies are done are uploaded first.
+     * @param budgetBytes Largest number of bytes to upload.
+     * @param staging Ring to stage bands through, or nullptr to upload levels from client memory.
+     * @return Bytes uploaded.
+     */
+    size_t update(size_t budgetBytes, StagingRing* staging = nullptr);
+
+    /**
+     * @brief Waits for the staged copies and drops them, so their ring can be destroyed.
+     *
+     * The dropped bands are staged again by the next update.
+     */
+    void releaseStaging();
+
+    /**
+     * @brief Gets the number of textures being decoded or with levels left to stream.
+     * @return The pending texture count.
+     */
+    size_t getPendingCount() const { return m_streams.size(); }
+
+    /**
+     * @brief Gets the process-wide streamer used by models and Scene.
+     * @return Reference to the shared streamer (created on first use).
+     */
+    static TextureStreamer& shared();
+
+private:
+    enum DecodeStatus { DECODE_NONE, DECODE_PENDING, DECODE_DONE, DECODE_FAILED };
+
+    struct StreamState {
+        std::weak_ptr<Texture> texture;
+        std::shared_ptr<TextureImage> decodeImage;         ///< Image decoded by the worker for streamFile
+        std::atomic<int> decodeStatus{DECODE_NONE};
+        std::atomic<int> readyLevel{0};     ///< Finest level read by the worker
+        std::atomic<bool> cancelled{false};
+        std::future<void> task;
+        int stageLevel = -1;                ///< Level whose bands are being staged (GL thread only)
+        int stageRow = 0;                   ///< Next row of stageLevel to stage
+        int stagedBands = 0;                ///< Bands staged but not uploaded yet
+    };
+
+    struct StagedBand {
+        std::shared_ptr<StreamState> state;
+        std::shared_ptr<const TextureImage> image;
+        int level;
+        int firstRow;
+        int rowCount;
+        int slot;
+        std::future<void> copy;
+    };
+
+    ThreadPool& m_pool;
+    std::vector<std::shared_ptr<StreamState>> m_streams;
+    std::deque<StagedBand> m_staged;
+    StagingRing* m_staging;
+    size_t m_next;
+
+    void finishDecodes();
+    size_t uploadDirect(size_t budgetBytes);
+    size_t uploadStaged(StagingRing& staging);
+    size_t stageBands(size_t budgetBytes, StagingRing& staging);
+};
+
+#endif // TEXTURESTREAMER_HPP
@@ -0,0 +1,83 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief Fixed-size pool of worker threads for CPU-side loading work.
+ *
+ * Tasks are pulled from a single FIFO queue. parallelFor lets the calling
+ * thread take part in the work, so it is safe to call from inside a task
+ * running on the same pool.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Constructs a pool with the given number of worker threads.
+     * @param threadCount Number of workers, or 0 to use the hardware concurrency.
+     */
+    explicit ThreadPool(size_t threadCount = 0);
+
+    /**
+     * @brief Destructor that finishes queued tasks and joins all workers.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Queues a task for execution on a worker thread.
+     * @param task Callable taking no arguments.
+     * @return Future receiving the task's result.
+     */
+    template <typename F>
+    auto submit(F&& task) -> std::future<typename std::invoke_result<F>::type> {
+        using Result = typename std::invoke_result<F>::type;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> future = packaged->get_future();
+        enqueue([packaged]() { (*packaged)(); });
+        return future;
+    }
+
+    /**
+     * @brief Runs body(i) for every i in [0, count) across the pool and waits for completion.
+     * @param count Number of iterations.
+     * @param body Function invoked once per iteration index.
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+    /**
+     * @brief Gets the number of worker threads.
+     * @return The worker thread count.
+     */
+    size_t getThreadCount() const { return m_workers.size(); }
+
+    /**
+     * @brief Gets the process-wide pool used by the asset loaders.
+     * @return Reference to the shared pool (created on first use).
+     */
+    static ThreadPool& shared();
+
+private:
+    std::vector<std::thread> m_workers;
+    std::queue<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopping;
+
+    void enqueue(std::function<void()> task);
+    void workerLoop();
+};
+
+#endif // THREADPOOL_HPP
@@ -0,0 +1,111 @@
+#ifndef UNIFORMRING_HPP
+#define UNIFORMRING_HPP
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class UniformRing
+ * @brief Uniform buffer written once per frame and bound block by block with glBindBufferRange.
+ *
+ * The buffer holds FRAME_COUNT regions used in turn. During a frame, push()
+ * appends std140 blocks to a CPU copy of the current region, each at the
+ * GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT; upload() sends them in one call, after
+ * which bind() attaches any of them to a uniform block binding point. A
+ * fence placed by endFrame() keeps a region from being overwritten before
+ * the GPU has drawn the frame that used it, so uploads never wait on
+ * commands still reading the buffer.
+ *
+ * The regions grow to fit the largest frame. Use it from the thread that
+ * owns the GL context.
+ */
+class UniformRing {
+public:
+    /// Frames whose blocks can be in flight at once
+    static constexpr int FRAME_COUNT = 3;
+
+    /**
+     * @brief Constructs an empty ring; call initialize once a GL context is current.
+     */
+    UniformRing();
+
+    /**
+     * @brief Destructor that frees the buffer.
+     */
+    ~UniformRing();
+
+    UniformRing(const UniformRing&) = delete;
+    UniformRing& operator=(const UniformRing&) = delete;
+
+    /**
+     * @brief Creates the uniform buffer.
+     * @param frameBytes Initial size of each frame's region.
+     * @return True if the buffer was created, false otherwise.
+     */
+    bool initialize(size_t frameBytes);
+
+    /**
+     * @brief Frees the uniform buffer.
+     */
+    void cleanup();
+
+    /**
+     * @brief Starts writing the next region, waiting for the GPU if it still reads it.
+     */
+    void beginFrame();
+
+    /**
+     * @brief Appends a block to the current frame.
+     * @param data The block's bytes, laid out as std140.
+     * @param bytes Size of the block.
+     * @return Offset of the block within the frame, to pass to bind.
+     */
+    size_t push(const void* data, size_t bytes);
+
+    /**
+     * @brief Uploads the blocks pushed this frame; call before the first bind.
+     */
+    void upload();
+
+    /**
+     * @brief Attaches a block of the current frame to a uniform block binding point.
+     * @param binding The binding point.
+     * @param offset Offset returned by push.
+     * @param bytes Size of the block.
+     */
+    void bind(GLuint binding, size_t offset, size_t bytes) const;
+
+    /**
+     * @brief Fences the frame's draws so its region is reused only once they are done.
+     */
+    void endFrame();
+
+    /**
+     * @brief Checks whether the buffer exists.
+     * @return True after a successful initialize.
+     */
+    bool isValid() const { return m_buffer != 0; }
+
+    /**
+     * @brief Gets the alignment of pushed blocks.
+     * @return GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT of the context.
+     */
+    size_t getAlignment() const { return m_alignment; }
+
+    /**
+     * @brief Gets the size of each frame's region.
+     * @return Size in bytes, grown to fit the largest frame so far.
+     */
+    size_t getFrameBytes() const { return m_frameBytes; }
+
+private:
+    GLuint m_buffer;
+    size_t m_frameBytes;
+    size_t m_alignment;
+    int m_frame;
+    std::vector<unsigned char> m_data;
+    GLsync m_fences[FRAME_COUNT];
+};
+
+#endif // UNIFORMRING_HPP
@@ -0,0 +1,88 @@
+#ifndef CLUSTERCULLER_HPP
+#define CLUSTERCULLER_HPP
+
+#include "models/MeshletBuilder.hpp"
+#include <cstddef>
+
+/**
+ * @struct ClusterCullStats
+ * @brief Per-frame meshlet culling counters.
+ */
+struct ClusterCullStats {
+    size_t tested = 0;          ///< Meshlets tested against the view
+    size_t culled = 0;          ///< Meshlets rejected (frustum + cone)
+    size_t frustumCulled = 0;   ///< Meshlets outside the view frustum
+    size_t coneCulled = 0;      ///< Meshlets facing away from the camera
+    size_t drawn = 0;           ///< Meshlets that were drawn
+    size_t drawRanges = 0;      ///< Index ranges submitted after merging adjacent meshlets
+};
+
+/**
+ * @class ClusterCuller
+ * @brief Tests meshlets against the camera frustum and their back-face cone.
+ *
+ * setView transforms the frustum planes and camera position into the
+ * object's model space once, so each meshlet is tested against its stored
+ * bounds without transforming them. Which side of a triangle the camera is
+ * on does not change under an affine transform, so the cone test stays exact
+ * for scaled objects. A mirrored model matrix (negative determinant) flips
+ * the winding, turning the faces the cones treat as back faces toward the
+ * viewer, so the cone test is skipped for those objects.
+ */
+class ClusterCuller {
+public:
+    /**
+     * @brief Constructs a culler with an empty view and zeroed counters.
+     */
+    ClusterCuller();
+
+    /**
+     * @brief Sets the view to test the next object's meshlets against.
+     * @param model The object's model matrix (column-major, affine); mirrored ones disable the cone test.
+     * @param modelViewProjection Projection times view times model (column-major).
+     * @param cameraPosition Camera position in world space (3 floats).
+     */
+    void setView(const float* model, const float* modelViewProjection, const float* cameraPosition);
+
+    /**
+     * @brief Enables or disables back-face cone culling.
+     *
+     * Cone culling assumes single-sided geometry; disable it for meshes that
+     * are meant to be seen from both sides.
+     * @param enabled True to reject meshlets facing away from the camera (the default).
+     */
+    void setConeCulling(bool enabled) { m_coneCulling = enabled; }
+
+    /**
+     * @brief Tests a meshlet and updates the counters.
+     * @param meshlet The meshlet to test.
+     * @return True if the meshlet may be visible.
+     */
+    bool isVisible(const Meshlet& meshlet);
+
+    /**
+     * @brief Records the number of index ranges submitted for drawing.
+     * @param ranges Number of ranges passed to the draw call.
+     */
+    void addDrawRanges(size_t ranges) { m_stats.drawRanges += ranges; }
+
+    /**
+     * @brief Gets the counters accumulated since the last reset.
+     * @return Reference to the ClusterCullStats.
+     */
+    const ClusterCullStats& getStats() const { return m_stats; }
+
+    /**
+     * @brief Resets the counters, typically at the start of a frame.
+     */
+    void resetStats() { m_stats = ClusterCullStats(); }
+
+private:
+    float m_planes[6][4];
+    float m_cameraPosition[3];
+    bool m_coneCulling;
+    bool m_mirrored;
+    ClusterCullStats m_stats;
+};
+
+#endif // CLUSTERCULLER_HPP
@@ -0,0 +1,33 @@
+#ifndef MATERIAL_HPP
+#define MATERIAL_HPP
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @struct Material
+ * @brief Surface description read from an MTL file.
+ *
+ * The defaults match the look of models rendered without an MTL file.
+ */
+struct Material {
+    std::string name;                          ///< Name given by "newmtl"
+    std::string diffuseMap;                    ///< Resolved path of the "map_Kd" texture, empty if none
+    float diffuse[3] = {0.7f, 0.7f, 0.7f};     ///< "Kd" color, used when there is no diffuse map
+    float specular[3] = {0.5f, 0.5f, 0.5f};    ///< "Ks" color
+    float shininess = 32.0f;                   ///< "Ns" specular exponent
+};
+
+/**
+ * @struct SubMesh
+ * @brief Contiguous range of an index buffer drawn with one material.
+ */
+struct SubMesh {
+    uint32_t indexOffset;    ///< First index of the range
+    uint32_t indexCount;     ///< Number of indices (three per triangle)
+    uint32_t material;       ///< Index into the model's material table
+    uint32_t meshletOffset;  ///< First meshlet covering the range (level 0 only)
+    uint32_t meshletCount;   ///< Number of meshlets covering the range, 0 if none
+};
+
+#endif // MATERIAL_HPP
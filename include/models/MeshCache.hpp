@@ -0,0 +1,204 @@
+#ifndef MESHCACHE_HPP
+#define MESHCACHE_HPP
+
+#include "core/MappedFile.hpp"
+#include "models/Material.hpp"
+#include "models/MeshletBuilder.hpp"
+#include "models/MeshSimplifier.hpp"
+#include "models/Vertex.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class MeshCache
+ * @brief Versioned binary cache of a loaded model, stored next to its OBJ file.
+ *
+ * The cache holds the already-welded vertex and index arrays, the
+ * per-material sub-meshes, the meshlets and levels of detail (if any), the
+ * bounding box and the material table. It is keyed by the source path, size, modification
+ * time and content hash of the OBJ (and the size and modification time of its
+ * MTL). If only the modification time changed but the content hash still
+ * matches, the cache is accepted and flagged for a header refresh.
+ *
+ * Opening a cache maps it, so the vertex and index arrays can be uploaded to
+ * the GPU straight from the mapping.
+ */
+class MeshCache {
+public:
+    /// Bumped whenever the file layout or the contents of a cached mesh change
+    static constexpr uint32_t VERSION = 5;
+
+    /// Set in Contents::flags when the mesh went through MeshOptimizer
+    static constexpr uint32_t FLAG_OPTIMIZED = 1u << 0;
+
+    /// Set in Contents::flags when the index buffer was partitioned into meshlets
+    static constexpr uint32_t FLAG_MESHLETS = 1u << 1;
+
+    /// Set in Contents::flags when simplified levels of detail were generated
+    static constexpr uint32_t FLAG_LODS = 1u << 2;
+
+    /**
+     * @struct Contents
+     * @brief Data written to a cache file.
+     */
+    struct Contents {
+        const std::vector<Vertex>* vertices = nullptr;
+        const std::vector<unsigned int>* indices = nullptr;
+        const std::vector<Material>* materials = nullptr;
+        const std::vector<Meshlet>* meshlets = nullptr;
+        const std::vector<MeshLod>* lods = nullptr;
+        const std::vector<SubMesh>* subMeshes = nullptr;
+        float bounds[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+        std::string mtlPath;
+        uint32_t flags = 0;
+    };
+
+    /**
+     * @brief Constructs a closed cache.
+     */
+    MeshCache();
+
+    /**
+     * @brief Maps and validates the cache belonging to a source OBJ.
+     *
+     * A cache with any range outside what it refers to (a section outside
+     * the file, an index outside the vertex array, a sub-mesh, level or
+     * meshlet outside the index buffer, or a table entry past the end of its
+     * table) is rejected as corrupt.
+     * @param sourcePath Path of the OBJ file the cache was built from.
+     * @param flags Processing flags the cached mesh must have been built with.
+     * @return True if a valid, up-to-date cache was opened, false otherwise.
+     */
+    bool open(const std::string& sourcePath, uint32_t flags);
+
+    /**
+     * @brief Unmaps the cache file.
+     */
+    void close();
+
+    /**
+     * @brief Checks whether a cache is open.
+     * @return True between a successful open and close.
+     */
+    bool isOpen() const { return m_file.isOpen(); }
+
+    /**
+     * @brief Writes a cache for a source OBJ file.
+     * @param sourcePath Path of the OBJ file.
+     * @param contents Data to store.
+     * @return True if the cache was written, false otherwise.
+     */
+    static bool write(const std::string& sourcePath, const Contents& contents);
+
+    /**
+     * @brief Gets the path of the cache file for a source OBJ.
+     * @param sourcePath Path of the OBJ file.
+     * @return The cache file path.
+     */
+    static std::string getCachePath(const std::string& sourcePath);
+
+    /**
+     * @brief Gets the cached vertex array (points into the mapping).
+     * @return Pointer to the first vertex.
+     */
+    const Vertex* getVertices() const { return m_vertices; }
+    
+    /**
+     * @brief Gets the number of cached vertices.
+     * @return The vertex count.
+     */
+    size_t getVertexCount() const { return m_vertexCount; }
+    
+    /**
+     * @brief Gets the cached index array (points into the mapping).
+     * @return Pointer to the first index.
+     */
+    const unsigned int* getIndices() const { return m_indices; }
+    
+    /**
+     * @brief Gets the number of cached indices.
+     * @return The index count.
+     */
+    size_t getIndexCount() const { return m_indexCount; }
+    
+    /**
+     * @brief Gets the cached meshlet array (points into the mapping).
+     * @return Pointer to the first meshlet, or nullptr if there are none.
+     */
+    const Meshlet* getMeshlets() const { return m_meshlets; }
+    
+    /**
+     * @brief Gets the number of cached meshlets.
+     * @return The meshlet count.
+     */
+    size_t getMeshletCount() const { return m_meshletCount; }
+    
+    /**
+     * @brief Gets the cached level of detail table (points into the mapping).
+     * @return Pointer to the first level, or nullptr if there are none.
+     */
+    const MeshLod* getLods() const { return m_lods; }
+    
+    /**
+     * @brief Gets the number of cached levels of detail.
+     * @return The level count.
+     */
+    size_t getLodCount() const { return m_lodCount; }
+    
+    /**
+     * @brief Gets the cached sub-mesh table (points into the mapping).
+     * @return Pointer to the first sub-mesh, or nullptr if there are none.
+     */
+    const SubMesh* getSubMeshes() const { return m_subMeshes; }
+    
+    /**
+     * @brief Gets the number of cached sub-meshes.
+     * @return The sub-mesh count.
+     */
+    size_t getSubMeshCount() const { return m_subMeshCount; }
+    
+    /**
+     * @brief Gets the cached bounding box as minX, minY, minZ, maxX, maxY, maxZ.
+     * @return Pointer to the six bounding box values.
+     */
+    const float* getBounds() const { return m_bounds; }
+    
+    /**
+     * @brief Gets the cached material table.
+     * @return Reference to the materials.
+     */
+    const std::vector<Material>& getMaterials() const { return m_materials; }
+    
+    /**
+     * @brief Gets the path of the MTL file the materials were read from.
+     * @return The MTL path, or an empty string if the model has none.
+     */
+    const std::string& getMtlPath() const { return m_mtlPath; }
+
+    /**
+     * @brief Checks whether the cache matched by content hash only.
+     * @return True if the source's stamp changed and the cache should be rewritten.
+     */
+    bool needsRefresh() const { return m_needsRefresh; }
+
+private:
+    MappedFile m_file;
+    const Vertex* m_vertices;
+    size_t m_vertexCount;
+    const unsigned int* m_indices;
+    size_t m_indexCount;
+    const Meshlet* m_meshlets;
+    size_t m_meshletCount;
+    const MeshLod* m_lods;
+    size_t m_lodCount;
+    const SubMesh* m_subMeshes;
+    size_t m_subMeshCount;
+    float m_bounds[6];
+    std::vector<Material> m_materials;
+    std::string m_mtlPath;
+    bool m_needsRefresh;
+};
+
+#endif // MESHCACHE_HPP
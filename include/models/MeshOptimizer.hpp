@@ -0,0 +1,107 @@
+#ifndef MESHOPTIMIZER_HPP
+#define MESHOPTIMIZER_HPP
+
+#include "models/Material.hpp"
+#include "models/Vertex.hpp"
+#include <cstddef>
+#include <vector>
+
+/**
+ * @struct VertexCacheStats
+ * @brief Post-transform vertex cache efficiency of an index buffer.
+ */
+struct VertexCacheStats {
+    size_t transformedVertices = 0;  ///< Simulated vertex shader invocations
+    float acmr = 0.0f;               ///< Average cache miss ratio: transformed vertices per triangle
+    float atvr = 0.0f;               ///< Average transformed vertex ratio: transformed / unique vertices
+};
+
+/**
+ * @struct MeshOptimizationStats
+ * @brief Before/after report of a MeshOptimizer::optimize run.
+ */
+struct MeshOptimizationStats {
+    VertexCacheStats before;   ///< Cache efficiency of the original index order
+    VertexCacheStats after;    ///< Cache efficiency after all passes
+    size_t clusterCount = 0;   ///< Number of clusters the overdraw pass reordered
+    double timeMs = 0.0;       ///< Time spent optimizing in milliseconds
+};
+
+/**
+ * @class MeshOptimizer
+ * @brief Post-load reordering of triangles and vertices for GPU efficiency.
+ *
+ * The passes are meant to run in order on a welded mesh:
+ * 1. optimizeVertexCache reorders triangles for post-transform cache reuse
+ *    (Forsyth's linear-speed vertex cache optimization).
+ * 2. optimizeOverdraw splits the result into clusters at cache-reset points
+ *    and sorts them front-to-back in a view-independent way (Sander et al.),
+ *    which keeps most of the cache benefit while reducing overdraw.
+ * 3. optimizeVertexFetch renumbers vertices in first-use order so vertex
+ *    data is fetched linearly.
+ * None of the passes change the rendered result.
+ */
+class MeshOptimizer {
+public:
+    /// Cache size used when simulating the post-transform cache (FIFO)
+    static constexpr unsigned int SIMULATED_CACHE_SIZE = 16;
+
+    /**
+     * @brief Runs all passes and reports the cache statistics before and after.
+     * @param vertices Vertex array, reordered in place.
+     * @param indices Triangle index array, reordered in place.
+     * @return Statistics of the run.
+     */
+    static MeshOptimizationStats optimize(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+    /**
+     * @brief Runs all passes, reordering triangles only within each sub-mesh.
+     *
+     * Sub-mesh ranges keep their offsets and sizes, so per-material draw
+     * ranges stay valid.
+     * @param vertices Vertex array, reordered in place.
+     * @param indices Triangle index array, reordered in place.
+     * @param subMeshes Index ranges whose triangles must stay together.
+     * @return Statistics of the run.
+     */
+    static MeshOptimizationStats optimize(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices,
+                                          const std::vector<SubMesh>& subMeshes);
+
+    /**
+     * @brief Reorders triangles to maximize post-transform vertex cache hits.
+     * @param indices Triangle index array, reordered in place.
+     * @param vertexCount Number of vertices referenced by the indices.
+     */
+    static void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount);
+
+    /**
+     * @brief Reorders clusters of triangles to reduce overdraw from any viewpoint.
+     * @param indices Cache-optimized triangle index array, reordered in place.
+     * @param vertices Vertex array the indices refer to.
+     * @param threshold Allowed ACMR degradation when splitting clusters (1.05 = 5%).
+     * @return Number of clusters that were sorted.
+     */
+    static size_t optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices,
+                                   float threshold = 1.05f);
+
+    /**
+     * @brief Renumbers vertices in the order they are first referenced.
+     *
+     * Vertices that are not referenced by any triangle are dropped.
+     * @param vertices Vertex array, reordered in place.
+     * @param indices Triangle index array, rewritten in place.
+     */
+    static void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+    /**
+     * @brief Simulates a FIFO post-transform cache over an index buffer.
+     * @param indices Triangle index array.
+     * @param vertexCount Number of vertices referenced by the indices.
+     * @param cacheSize Number of entries in the simulated cache.
+     * @return The resulting cache statistics.
+     */
+    static VertexCacheStats analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount,
+                                               unsigned int cacheSize = SIMULATED_CACHE_SIZE);
+};
+
+#endif // MESHOPTIMIZER_HPP
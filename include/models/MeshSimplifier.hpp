@@ -0,0 +1,50 @@
+#ifndef MESHSIMPLIFIER_HPP
+#define MESHSIMPLIFIER_HPP
+
+#include "models/Vertex.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct MeshLod
+ * @brief One level of detail stored as a range of a shared index buffer.
+ *
+ * The range is split into per-material sub-meshes listed in the model's
+ * sub-mesh table.
+ */
+struct MeshLod {
+    uint32_t indexOffset;    ///< First index of the level in the index buffer
+    uint32_t indexCount;     ///< Number of indices (three per triangle)
+    float error;             ///< Geometric error against the full mesh in model units
+    uint32_t firstSubMesh;   ///< First entry of the level in the sub-mesh table
+    uint32_t subMeshCount;   ///< Number of sub-meshes of the level
+};
+
+/**
+ * @class MeshSimplifier
+ * @brief Quadric error metric (Garland-Heckbert) triangle decimation.
+ *
+ * Edges are collapsed onto one of their existing endpoints, so a simplified
+ * index buffer keeps referring to the original vertex array and every LOD can
+ * share one vertex buffer. Vertices on open borders, on UV seams (several
+ * vertices with the same position) and on non-manifold edges are locked:
+ * other vertices may collapse onto them, but they never move, so silhouettes
+ * of open meshes and texture charts stay intact.
+ */
+class MeshSimplifier {
+public:
+    /**
+     * @brief Simplifies a triangle mesh towards a target triangle count.
+     * @param vertices Vertex array the indices refer to.
+     * @param indices Source triangle index array.
+     * @param targetIndexCount Desired number of indices (three per triangle).
+     * @param maxError Largest allowed geometric error in model units.
+     * @param out Output receiving the simplified index array.
+     * @return The error of the result in model units (0 if nothing was collapsed).
+     */
+    static float simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                          size_t targetIndexCount, float maxError, std::vector<unsigned int>& out);
+};
+
+#endif // MESHSIMPLIFIER_HPP
@@ -0,0 +1,67 @@
+#ifndef MESHLETBUILDER_HPP
+#define MESHLETBUILDER_HPP
+
+#include "models/Vertex.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct Meshlet
+ * @brief A cluster of triangles stored as a contiguous range of the index buffer.
+ *
+ * The bounding sphere and normal cone are in model space. The cone is used
+ * for back-face culling: the whole cluster faces away from a camera at
+ * position p when dot(center - p, coneAxis) >= coneCutoff * |center - p| + radius.
+ * A coneCutoff of 1 disables the test for clusters whose normals spread too far.
+ */
+struct Meshlet {
+    uint32_t indexOffset;   ///< First index of the cluster in the index buffer
+    uint32_t indexCount;    ///< Number of indices (three per triangle)
+    uint32_t vertexCount;   ///< Number of unique vertices referenced
+    float center[3];        ///< Bounding sphere center
+    float radius;           ///< Bounding sphere radius
+    float coneAxis[3];      ///< Average facing direction of the triangles
+    float coneCutoff;       ///< Sine of the cone's half angle, 1 when the cone is unusable
+};
+
+/**
+ * @class MeshletBuilder
+ * @brief Partitions a triangle index buffer into meshlets with culling bounds.
+ *
+ * Clusters are grown greedily from the current index order, preferring the
+ * adjacent triangle that adds the fewest new vertices, so a cache-optimized
+ * buffer keeps most of its locality. The index buffer is rewritten so each
+ * meshlet is a contiguous range.
+ */
+class MeshletBuilder {
+public:
+    /// Maximum unique vertices per meshlet
+    static constexpr size_t MAX_VERTICES = 64;
+
+    /// Maximum triangles per meshlet
+    static constexpr size_t MAX_TRIANGLES = 124;
+
+    /**
+     * @brief Builds meshlets and reorders the index buffer to match.
+     * @param vertices Vertex array the indices refer to.
+     * @param indices Triangle index array, reordered in place.
+     * @param meshlets Output receiving the meshlets in index buffer order.
+     * @param maxVertices Maximum unique vertices per meshlet.
+     * @param maxTriangles Maximum triangles per meshlet.
+     */
+    static void build(const std::vector<Vertex>& vertices, std::vector<unsigned int>& indices,
+                      std::vector<Meshlet>& meshlets, size_t maxVertices = MAX_VERTICES,
+                      size_t maxTriangles = MAX_TRIANGLES);
+
+    /**
+     * @brief Computes the bounding sphere and normal cone of one meshlet.
+     * @param vertices Vertex array the indices refer to.
+     * @param indices Triangle index array containing the meshlet's range.
+     * @param meshlet Meshlet whose indexOffset and indexCount are set; bounds are filled in.
+     */
+    static void computeBounds(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                              Meshlet& meshlet);
+};
+
+#endif // MESHLETBUILDER_HPP
@@ -2,19 +2,26 @@
 #define MODEL_HPP
 
 #include <GL/glew.h>
+#include <atomic>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
+#include "core/Shader.hpp"
 #include "core/Texture.hpp"
+#include "core/TextureAtlas.hpp"
+#include "models/ClusterCuller.hpp"
+#include "models/Material.hpp"
+#include "models/MeshCache.hpp"
+#include "models/MeshOptimizer.hpp"
+#include "models/MeshSimplifier.hpp"
+#include "models/ShaderFeatures.hpp"
+#include "models/Vertex.hpp"
+#include "models/VertexQuantizer.hpp"
+#include "models/VertexWelder.hpp"
 
-/**
- * @struct Vertex
- * @brief Represents a single vertex with position, normal, and texture coordinates.
- */
-struct Vertex {
-    float position[3];  ///< 3D position coordinates (x, y, z)
-    float normal[3];    ///< Normal vector (x, y, z)
-    float texCoord[2];  ///< Texture coordinates (u, v)
-};
+struct ObjData;
+class TextureResidencyManager;
 
 /**
  * @class Model
@@ -23,6 +30,14 @@ struct Vertex {
  * This class handles loading 3D models from OBJ format files, including
  * parsing geometry, normals, texture coordinates, and associated material files.
  * It manages OpenGL buffers for efficient rendering.
+ *
+ * Triangles are grouped by "usemtl" material into contiguous sub-meshes, so
+ * a model is drawn with one VAO bind and one ranged draw per material.
+ * Sub-meshes are ordered by diffuse texture so shared textures are bound once.
+ *
+ * Loading can be split across threads: loadMesh and decodeTextures do all
+ * CPU work without GL calls and may run on a worker, after which upload
+ * creates the GL objects on the thread that owns the context.
  */
 class Model {
 public:
@@ -38,15 +53,104 @@ public:
 
     /**
      * @brief Loads a 3D model from an OBJ file.
+     *
+     * A binary mesh cache next to the OBJ is used when it is up to date, and
+     * written after parsing otherwise. A missing, unreadable or stale cache
+     * silently falls back to parsing the OBJ.
      * @param filepath Path to the OBJ file to load.
      * @return True if loading succeeded, false otherwise.
      */
     bool loadFromOBJ(const std::string& filepath);
     
+    /**
+     * @brief Loads the mesh, materials, meshlets and levels of detail into memory.
+     *
+     * The CPU half of loadFromOBJ: makes no GL calls, so it may run on a
+     * worker thread as long as no other thread uses the model meanwhile.
+     * @param filepath Path to the OBJ file to load.
+     * @param cancelled Optional flag checked between the parse, optimize, meshlet and LOD stages; once
+     *                  set, loading stops without writing the mesh cache.
+     * @return True if loading succeeded, false otherwise or if cancelled.
+     */
+    bool loadMesh(const std::string& filepath, const std::atomic<bool>* cancelled = nullptr);
+    
+    /**
+     * @brief Decodes the materials' diffuse maps into memory for the next upload.
+     *
+     * Optional, and safe on a worker thread after loadMesh. Maps that are not
+     * decoded here are loaded by upload, unless already in the texture cache.
+     * Does nothing with Texture streaming enabled, as TextureStreamer decodes
+     * streamed maps on its workers after upload.
+     */
+    void decodeTextures();
+    
+    /**
+     * @brief Creates the GL buffers and textures from the loaded mesh.
+     *
+     * Must run on the thread that owns the GL context, after loadMesh.
+     * Decoded images are released afterwards. With Texture streaming enabled,
+     * textures start with their coarse levels, or with a placeholder while
+     * TextureStreamer decodes them, and are refined by TextureStreamer.
+     *
+     * The vertex and index data go up with one glBufferData each: the
+     * buffers are static, so staging them would only add a copy. A mesh
+     * loaded from its cache is uploaded straight from the mapped file, which
+     * is unmapped afterwards.
+     */
+    void upload();
+    
+    /**
+     * @brief Checks whether the model has GPU buffers and can be drawn.
+     * @return True after a successful upload.
+     */
+    bool isReady() const { return m_initialized; }
+    
     /**
      * @brief Renders the model using the current OpenGL state.
+     *
+     * Binds each material's diffuse texture but sets no uniforms.
+     * @param lod Level of detail to draw (clamped to the coarsest level).
+     */
+    void render(size_t lod = 0) const;
+    
+    /**
+     * @brief Renders the model, setting each material's uniforms on the shader.
+     *
+     * Sets materialDiffuse, materialSpecular and materialShininess before
+     * each sub-mesh's draw; whether it samples a texture is left to the
+     * shader's permutation (see getSubMeshFeatures).
+     * @param shader The shader in use.
+     * @param lod Level of detail to draw (clamped to the coarsest level).
+     */
+    void render(const Shader& shader, size_t lod = 0) const;
+    
+    /**
+     * @brief Renders only the meshlets that pass the culler's current view.
+     *
+     * Surviving meshlets of each sub-mesh are merged into contiguous index
+     * ranges and drawn with a single glMultiDrawElements. Models without
+     * meshlets, and levels of detail other than 0, are drawn whole.
+     * @param shader The shader in use.
+     * @param culler Culler set up with this object's model matrix and the camera.
+     * @param lod Level of detail to draw (clamped to the coarsest level).
+     * @param features Draw only sub-meshes with exactly these ShaderFeatures, or ShaderFeatures::ANY for all.
      */
-    void render() const;
+    void render(const Shader& shader, ClusterCuller& culler, size_t lod = 0,
+                uint32_t features = ShaderFeatures::ANY) const;
+    
+    /**
+     * @brief Gets the shader permutation a sub-mesh needs.
+     * @param subMesh Index into the model's sub-meshes.
+     * @return ShaderFeatures bits: its material's texture and specular term, and compact vertices.
+     */
+    uint32_t getSubMeshFeatures(uint32_t subMesh) const;
+    
+    /**
+     * @brief Collects the shader permutations one level of detail needs.
+     * @param lod Level of detail (clamped to the coarsest level).
+     * @param features Receives each feature mask of the level's sub-meshes not already in it.
+     */
+    void getLodFeatures(size_t lod, std::vector<uint32_t>& features) const;
     
     /**
      * @brief Cleans up OpenGL buffers and resources.
@@ -66,23 +170,210 @@ public:
                        float& maxX, float& maxY, float& maxZ) const;
     
     /**
-     * @brief Checks if the model has an associated texture.
+     * @brief Checks if any of the model's materials has a diffuse texture.
      * @return True if a texture is loaded, false otherwise.
      */
     bool hasTexture() const { return m_hasTexture; }
+    
+    /**
+     * @brief Gets the vertex welding statistics from the last load.
+     * @return Reference to the WeldStats of the last loadFromOBJ call.
+     */
+    const WeldStats& getWeldStats() const { return m_weldStats; }
+    
+    /**
+     * @brief Enables or disables the post-load mesh optimization passes.
+     *
+     * When enabled (the default), triangles are reordered for vertex cache
+     * reuse and reduced overdraw, and vertices are renumbered in fetch order.
+     * Takes effect on the next loadFromOBJ call.
+     * @param enabled True to optimize loaded meshes, false to keep file order.
+     */
+    void setOptimizeOnLoad(bool enabled) { m_optimizeOnLoad = enabled; }
+    
+    /**
+     * @brief Gets the mesh optimization report from the last load that parsed the OBJ.
+     * @return Reference to the MeshOptimizationStats (zeroed if no optimization ran).
+     */
+    const MeshOptimizationStats& getOptimizationStats() const { return m_optimizationStats; }
+    
+    /**
+     * @brief Gets the time taken by the last loadFromOBJ call.
+     * @return Load time in milliseconds.
+     */
+    double getLoadTimeMs() const { return m_loadTimeMs; }
+    
+    /**
+     * @brief Checks whether the last load was served from the binary mesh cache.
+     * @return True if loaded from cache, false if the OBJ was parsed.
+     */
+    bool isLoadedFromCache() const { return m_loadedFromCache; }
+    
+    /**
+     * @brief Enables or disables the compact GPU vertex format.
+     *
+     * When enabled, vertices are uploaded as 16-byte CompactVertex (positions
+     * quantized to the bounding box, octahedral normals, half-float UVs) and
+     * indices as 16-bit when the vertex count allows. Shaders must then
+     * dequantize with getDequantization. Takes effect on the next loadFromOBJ call.
+     * @param enabled True to upload compact vertices, false for float vertices (the default).
+     */
+    void setCompactVertices(bool enabled) { m_compactVertices = enabled; }
+    
+    /**
+     * @brief Checks whether the GPU buffers hold compact vertices.
+     * @return True if the last upload used CompactVertex.
+     */
+    bool isCompact() const { return m_compact; }
+    
+    /**
+     * @brief Gets the position dequantization parameters of the compact buffers.
+     * @param offset Output receiving the position offset (3 floats).
+     * @param scale Output receiving the position scale (3 floats).
+     */
+    void getDequantization(float* offset, float* scale) const;
+    
+    /**
+     * @brief Gets the quantization error of the compact buffers against the float source.
+     * @return Reference to the QuantizationError (zeroed if the buffers are not compact).
+     */
+    const QuantizationError& getQuantizationError() const { return m_quantizationError; }
+    
+    /**
+     * @brief Enables or disables partitioning the mesh into meshlets.
+     *
+     * Meshlets of up to MeshletBuilder::MAX_VERTICES vertices and
+     * MeshletBuilder::MAX_TRIANGLES triangles carry a bounding sphere and
+     * normal cone, so render(const Shader&, ClusterCuller&) can skip off-screen and
+     * back-facing parts of the mesh. Takes effect on the next loadFromOBJ call.
+     * @param enabled True to build meshlets, false to draw the mesh whole (the default).
+     */
+    void setMeshletsEnabled(bool enabled) { m_buildMeshlets = enabled; }
+    
+    /**
+     * @brief Gets the meshlets of the loaded mesh.
+     * @return Reference to the meshlets (empty if meshlets are disabled).
+     */
+    const std::vector<Meshlet>& getMeshlets() const { return m_meshlets; }
+    
+    /**
+     * @brief Enables or disables generating simplified levels of detail.
+     *
+     * When enabled (the default), levels with about 50%, 25%, 10% and 3% of
+     * the triangles are generated by MeshSimplifier and stored after the full
+     * mesh in the same index buffer. Takes effect on the next loadFromOBJ call.
+     * @param enabled True to generate levels of detail, false to keep only the full mesh.
+     */
+    void setLodEnabled(bool enabled) { m_buildLods = enabled; }
+    
+    /**
+     * @brief Gets the number of levels of detail, including the full mesh.
+     * @return The level count (1 if no simplified levels exist).
+     */
+    size_t getLodCount() const { return m_lods.size(); }
+    
+    /**
+     * @brief Gets a level of detail; level 0 is the full mesh with zero error.
+     * @param lod Level index, less than getLodCount().
+     * @return Reference to the MeshLod.
+     */
+    const MeshLod& getLod(size_t lod) const { return m_lods[lod]; }
+    
+    /**
+     * @brief Gets the material table.
+     * @return Reference to the materials; SubMesh::material indexes into it.
+     */
+    const std::vector<Material>& getMaterials() const { return m_materials; }
+    
+    /**
+     * @brief Gets the per-material draw ranges of all levels of detail.
+     * @return Reference to the sub-meshes; MeshLod::firstSubMesh indexes into it.
+     */
+    const std::vector<SubMesh>& getSubMeshes() const { return m_subMeshes; }
+    
+    /**
+     * @brief Requests the mip levels of the model's textures needed at a given screen size.
+     *
+     * The finest useful level is where one texel covers about one pixel,
+     * estimated from the texture size, the UV range and the bounding box.
+     * @param manager The residency manager tracking the textures.
+     * @param pixelsPerUnit Pixels covered by one model unit at the object's distance (0 if off screen).
+     */
+    void requestTextureLevels(TextureResidencyManager& manager, float pixelsPerUnit) const;
+    
+    /**
+     * @brief Gets the model's textures, one per distinct diffuse map.
+     * @return Reference to the textures.
+     */
+    const std::vector<std::shared_ptr<Texture>>& getTextures() const { return m_textures; }
+    
+    /**
+     * @brief Makes the model sample its textures from a TextureAtlas bound by the caller.
+     *
+     * render with a shader then binds no texture: it sets textureLayer and
+     * layerTransform (UV scale in xy, offset in zw) per
+     * sub-mesh instead. The textures themselves are no longer requested from
+     * the residency manager and are evicted to their coarse tail, so their
+     * full-resolution levels do not take GPU memory twice; clearing the
+     * regions restores them.
+     * @param regions One region per entry of getTextures(), or empty to bind the textures again.
+     */
+    void setAtlasRegions(const std::vector<AtlasRegion>& regions);
+    
+    /**
+     * @brief Checks whether the model samples from a TextureAtlas.
+     * @return True if atlas regions are set.
+     */
+    bool hasAtlasRegions() const { return !m_atlasRegions.empty(); }
 
 private:
-    std::vector<Vertex> m_vertices;
+    std::vector<Vertex> m_vertices;        // Empty while the mesh is in m_meshCache
     std::vector<unsigned int> m_indices;
+    MeshCache m_meshCache;                 // Open from a cache hit until upload()
+    std::vector<Meshlet> m_meshlets;
+    std::vector<MeshLod> m_lods;
+    std::vector<Material> m_materials;
+    std::vector<SubMesh> m_subMeshes;
+    std::string m_mtlPath;
+    float m_bounds[6];
     GLuint m_VAO;
     GLuint m_VBO;
     GLuint m_EBO;
+    GLenum m_indexType;
     bool m_initialized;
-    Texture m_texture;
+    std::vector<std::shared_ptr<Texture>> m_textures;
+    std::vector<int> m_materialTextures;
+    std::vector<AtlasRegion> m_atlasRegions;
+    std::unordered_map<std::string, TextureImage> m_decodedImages;
     bool m_hasTexture;
+    WeldStats m_weldStats;
+    bool m_optimizeOnLoad;
+    MeshOptimizationStats m_optimizationStats;
+    double m_loadTimeMs;
+    bool m_loadedFromCache;
+    bool m_compactVertices;
+    bool m_compact;
+    QuantizationError m_quantizationError;
+    bool m_buildMeshlets;
+    bool m_buildLods;
+    float m_texCoordSpan;
+    mutable std::vector<GLsizei> m_drawCounts;
+    mutable std::vector<const void*> m_drawOffsets;
     
-    void setupBuffers();
-    void parseOBJ(const std::string& filepath);
+    void setupBuffers(const Vertex* vertices, size_t vertexCount,
+                      const unsigned int* indices, size_t indexCount);
+    bool loadFromCache(const std::string& filepath);
+    void writeCache(const std::string& filepath) const;
+    uint32_t getCacheFlags() const;
+    void groupByMaterial(const ObjData& obj);
+    void buildMeshlets();
+    void buildLods(const std::atomic<bool>* cancelled = nullptr);
+    size_t getIndexSize() const;
+    void draw(const Shader* shader, ClusterCuller* culler, size_t lod, uint32_t features) const;
+    void computeBounds();
+    void computeTexCoordSpan(const Vertex* vertices, size_t vertexCount);
+    void loadTextures();
+    void parseOBJ(const std::string& filepath, const std::atomic<bool>* cancelled);
     void parseMTL(const std::string& mtlPath, const std::string& objDir);
     std::string extractDirectory(const std::string& filepath);
 };
@@ -0,0 +1,169 @@
+#ifndef MODELLOADER_HPP
+#define MODELLOADER_HPP
+
+#include "core/MpscQueue.hpp"
+#include "core/ThreadPool.hpp"
+#include "models/Model.hpp"
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+/**
+ * @enum LoadStatus
+ * @brief Stage of an asynchronous model load.
+ */
+enum class LoadStatus {
+    Queued,      ///< Waiting for a worker thread
+    Loading,     ///< Parsing, building and decoding on a worker
+    Uploading,   ///< CPU work done, waiting for its GPU upload
+    Ready,       ///< Uploaded; the model can be drawn
+    Failed,      ///< The file could not be loaded
+    Cancelled    ///< Cancelled before the upload
+};
+
+/**
+ * @struct ModelLoadState
+ * @brief State shared between a load's handle, its worker task and the loader.
+ */
+struct ModelLoadState {
+    std::string path;
+    std::shared_ptr<Model> model;
+    std::atomic<LoadStatus> status{LoadStatus::Queued};
+    std::atomic<float> progress{0.0f};
+    std::atomic<bool> cancelled{false};
+    bool loaded = false;            ///< Set by the worker before handing the state to the GL thread
+    std::future<void> task;         ///< Worker task, waited on when the loader is destroyed
+};
+
+/**
+ * @class ModelLoadHandle
+ * @brief Caller's view of an asynchronous model load.
+ *
+ * Copies refer to the same load. A default-constructed handle refers to no
+ * load and reports LoadStatus::Failed.
+ */
+class ModelLoadHandle {
+public:
+    /**
+     * @brief Constructs a handle that refers to no load.
+     */
+    ModelLoadHandle() = default;
+
+    /**
+     * @brief Constructs a handle for a load's shared state.
+     * @param state The load state.
+     */
+    explicit ModelLoadHandle(std::shared_ptr<ModelLoadState> state) : m_state(std::move(state)) {}
+
+    /**
+     * @brief Gets the current stage of the load.
+     * @return The load status.
+     */
+    LoadStatus getStatus() const { return m_state ? m_state->status.load() : LoadStatus::Failed; }
+
+    /**
+     * @brief Gets the fraction of the load that is done.
+     * @return Progress from 0 to 1.
+     */
+    float getProgress() const { return m_state ? m_state->progress.load() : 0.0f; }
+
+    /**
+     * @brief Checks whether the load has finished, successfully or not.
+     * @return True if the status is Ready, Failed or Cancelled.
+     */
+    bool isDone() const {
+        LoadStatus status = getStatus();
+        return status == LoadStatus::Ready || status == LoadStatus::Failed || status == LoadStatus::Cancelled;
+    }
+
+    /**
+     * @brief Requests cancellation; the worker stops at its next stage and nothing is uploaded.
+     *
+     * Has no effect once the model is uploaded. Every handle to the same load
+     * sees the cancellation.
+     */
+    void cancel() {
+        if (m_state) m_state->cancelled = true;
+    }
+
+    /**
+     * @brief Gets the model being loaded.
+     * @return Handle to the model; only drawable once the status is Ready.
+     */
+    std::shared_ptr<Model> getModel() const { return m_state ? m_state->model : nullptr; }
+
+private:
+    std::shared_ptr<ModelLoadState> m_state;
+};
+
+/**
+ * @class ModelLoader
+ * @brief Loads models on worker threads and uploads them on the GL thread.
+ *
+ * Model::loadMesh and Model::decodeTextures run on the thread pool. Finished
+ * loads are handed back through a lock-free queue, and processUploads, called
+ * once per frame on the GL thread, uploads them within a time budget so a
+ * large model never stalls a frame for long.
+ */
+class ModelLoader {
+public:
+    /**
+     * @brief Constructs a loader running its CPU work on the given pool.
+     * @param pool Thread pool for parsing and decoding (default: the shared pool).
+     */
+    explicit ModelLoader(ThreadPool& pool = ThreadPool::shared());
+
+    /**
+     * @brief Destructor that cancels pending loads and waits for their workers.
+     */
+    ~ModelLoader();
+
+    ModelLoader(const ModelLoader&) = delete;
+    ModelLoader& operator=(const ModelLoader&) = delete;
+
+    /**
+     * @brief Starts loading a model in the background.
+     *
+     * The model's load options must be set beforehand, and the model must not
+     * be used by other threads until the load is done.
+     * @param model The model to load into.
+     * @param filepath Path to the OBJ file.
+     * @return Handle reporting progress and allowing cancellation.
+     */
+    ModelLoadHandle load(const std::shared_ptr<Model>& model, const std::string& filepath);
+
+    /**
+     * @brief Gets the handle of a model's pending load.
+     * @param model The model.
+     * @return The pending load's handle, or a finished handle (Ready if the model is uploaded).
+     */
+    ModelLoadHandle find(const std::shared_ptr<Model>& model) const;
+
+    /**
+     * @brief Uploads finished loads until the time budget is spent; call on the GL thread.
+     *
+     * At least one load is processed per call, so progress is made even when
+     * a single upload takes longer than the budget.
+     * @param budgetMs Time budget in milliseconds.
+     * @return The number of loads that finished (uploaded, failed or cancelled).
+     */
+    size_t processUploads(double budgetMs);
+
+    /**
+     * @brief Gets the number of loads that have not finished yet.
+     * @return The pending load count.
+     */
+    size_t getPendingCount() const { return m_pending.size(); }
+
+private:
+    ThreadPool& m_pool;
+    MpscQueue<std::shared_ptr<ModelLoadState>> m_finished;
+    std::vector<std::shared_ptr<ModelLoadState>> m_pending;   // GL thread only
+
+    static void runLoad(ModelLoadState& state);
+};
+
+#endif // MODELLOADER_HPP
@@ -0,0 +1,122 @@
+#ifndef OBJPARSER_HPP
+#define OBJPARSER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "models/Vertex.hpp"
+#include "models/VertexWelder.hpp"
+
+class ThreadPool;
+
+/**
+ * @struct ObjCorner
+ * @brief One triangle corner referencing the OBJ attribute arrays.
+ *
+ * Indices are already resolved to 0-based offsets (OBJ's 1-based and negative
+ * relative indices are converted while parsing). -1 marks a missing attribute.
+ */
+struct ObjCorner {
+    int32_t position;  ///< Index into ObjData::positions (in units of 3 floats)
+    int32_t texCoord;  ///< Index into ObjData::texCoords (in units of 2 floats), or -1
+    int32_t normal;    ///< Index into ObjData::normals (in units of 3 floats), or -1
+};
+
+/**
+ * @struct ObjMaterialRun
+ * @brief Start of a run of triangles that share a "usemtl" material.
+ *
+ * A run lasts until the next run starts. Corners before the first run have
+ * no material.
+ */
+struct ObjMaterialRun {
+    uint32_t firstCorner;  ///< Index into ObjData::corners of the run's first corner
+    uint32_t material;     ///< Index into ObjData::materialNames
+};
+
+/**
+ * @struct ObjData
+ * @brief Raw geometry parsed from an OBJ file, before vertex welding.
+ */
+struct ObjData {
+    std::vector<float> positions;    ///< x, y, z per "v" record
+    std::vector<float> texCoords;    ///< u, v per "vt" record
+    std::vector<float> normals;      ///< x, y, z per "vn" record
+    std::vector<ObjCorner> corners;  ///< Triangulated faces, three corners per triangle
+    std::vector<std::string> materialNames;    ///< Distinct "usemtl" names in order of first use
+    std::vector<ObjMaterialRun> materialRuns;  ///< One entry per "usemtl" switch, in corner order
+    std::string mtlLib;              ///< File name given by the first "mtllib" record
+    size_t bytes = 0;                ///< Size of the parsed input in bytes
+    double parseTimeMs = 0.0;        ///< Time spent parsing in milliseconds
+
+    /**
+     * @brief Clears all parsed data.
+     */
+    void clear();
+};
+
+/**
+ * @class ObjParser
+ * @brief Allocation-free, single-pass tokenizer for Wavefront OBJ text.
+ *
+ * The input is scanned in place (normally straight from a MappedFile) with a
+ * hand-written tokenizer and std::from_chars for numbers. No per-line strings
+ * are created; the only allocations are the growth of the output arrays.
+ * Polygons with more than three corners are triangulated as a fan.
+ *
+ * Large files can be parsed in parallel: the mapping is split on line
+ * boundaries, each chunk is parsed on its own, and relative indices are fixed
+ * up after a prefix sum over the per-chunk record counts. The result is
+ * identical to a serial parse.
+ */
+class ObjParser {
+public:
+    /**
+     * @brief Maps and parses an OBJ file.
+     * @param filepath Path to the OBJ file.
+     * @param out Output receiving the parsed geometry (cleared first).
+     * @return True if the file could be opened, false otherwise.
+     */
+    static bool parseFile(const std::string& filepath, ObjData& out);
+
+    /**
+     * @brief Maps and parses an OBJ file using all threads of a pool.
+     * @param filepath Path to the OBJ file.
+     * @param out Output receiving the parsed geometry (cleared first).
+     * @param pool Thread pool to parse the chunks on.
+     * @return True if the file could be opened, false otherwise.
+     */
+    static bool parseFileParallel(const std::string& filepath, ObjData& out, ThreadPool& pool);
+
+    /**
+     * @brief Parses OBJ text from memory.
+     * @param data Pointer to the first character of the text.
+     * @param size Number of bytes to parse.
+     * @param out Output receiving the parsed geometry (appended to).
+     */
+    static void parse(const char* data, size_t size, ObjData& out);
+
+    /**
+     * @brief Builds a welded vertex and index array from parsed OBJ data.
+     *
+     * With a pool, ranges of triangles are welded in parallel and merged in
+     * order, giving the same vertices and indices as a serial weld.
+     * @param data Parsed OBJ data.
+     * @param vertices Output receiving the unique vertices (cleared first).
+     * @param indices Output receiving three indices per triangle.
+     * @param pool Thread pool to weld on, or nullptr to weld serially.
+     * @return Statistics of the welding pass.
+     */
+    static WeldStats buildMesh(const ObjData& data, std::vector<Vertex>& vertices,
+                               std::vector<unsigned int>& indices, ThreadPool* pool = nullptr);
+
+    /**
+     * @brief Gets the parse throughput of a completed parse.
+     * @param data The parsed data.
+     * @return Throughput in megabytes per second, or 0 if no time was recorded.
+     */
+    static double throughputMBps(const ObjData& data);
+};
+
+#endif // OBJPARSER_HPP
@@ -0,0 +1,29 @@
+#ifndef SHADERFEATURES_HPP
+#define SHADERFEATURES_HPP
+
+#include <cstdint>
+
+/**
+ * @struct ShaderFeatures
+ * @brief Feature bits selecting a permutation of the scene shader.
+ *
+ * Each bit is compiled into the shader as a preprocessor define named in
+ * NAMES, so a permutation contains only the paths its draws need.
+ */
+struct ShaderFeatures {
+    static constexpr uint32_t TEXTURED = 1u << 0;           ///< Samples the diffuse texture
+    static constexpr uint32_t TEXTURE_LAYERS = 1u << 1;     ///< Samples it from a TextureAtlas; set with TEXTURED
+    static constexpr uint32_t SPECULAR = 1u << 2;           ///< Adds the specular term of a non-black Ks
+    static constexpr uint32_t QUANTIZED_VERTEX = 1u << 3;   ///< Dequantizes compact vertices
+
+    /// Filter value that selects every sub-mesh, whatever its features
+    static constexpr uint32_t ANY = ~0u;
+
+    /// Number of feature bits
+    static constexpr int COUNT = 4;
+
+    /// Define names of the bits, lowest bit first
+    static constexpr const char* NAMES[COUNT] = {"TEXTURED", "TEXTURE_LAYERS", "SPECULAR", "QUANTIZED_VERTEX"};
+};
+
+#endif // SHADERFEATURES_HPP
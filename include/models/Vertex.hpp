@@ -0,0 +1,14 @@
+#ifndef VERTEX_HPP
+#define VERTEX_HPP
+
+/**
+ * @struct Vertex
+ * @brief Represents a single vertex with position, normal, and texture coordinates.
+ */
+struct Vertex {
+    float position[3];  ///< 3D position coordinates (x, y, z)
+    float normal[3];    ///< Normal vector (x, y, z)
+    float texCoord[2];  ///< Texture coordinates (u, v)
+};
+
+#endif // VERTEX_HPP
@@ -0,0 +1,102 @@
+#ifndef VERTEXQUANTIZER_HPP
+#define VERTEXQUANTIZER_HPP
+
+#include "models/Vertex.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct CompactVertex
+ * @brief 16-byte GPU vertex format, half the size of Vertex.
+ *
+ * - position: 16-bit unsigned normalized per axis, relative to the mesh AABB.
+ *   The fourth lane is padding that keeps the following attributes 4-byte aligned.
+ * - normal: octahedral encoding in two 16-bit signed normalized values.
+ * - texCoord: two half floats.
+ */
+struct CompactVertex {
+    uint16_t position[4];
+    int16_t normal[2];
+    uint16_t texCoord[2];
+};
+
+/**
+ * @struct QuantizationError
+ * @brief Worst-case error of a CompactVertex array against its float source.
+ */
+struct QuantizationError {
+    float maxPositionError = 0.0f;     ///< Largest per-axis position error in model units
+    float maxNormalErrorDeg = 0.0f;    ///< Largest angle between source and decoded normal, in degrees
+    float maxTexCoordError = 0.0f;     ///< Largest per-component texture coordinate error
+};
+
+/**
+ * @class VertexQuantizer
+ * @brief Encodes Vertex arrays into CompactVertex and measures the resulting error.
+ *
+ * The matching decode lives in the Scene vertex shader: positions are
+ * rebuilt as offset + value * scale, where offset is the AABB minimum and
+ * scale the AABB extent, and normals are decoded from the octahedron.
+ */
+class VertexQuantizer {
+public:
+    /**
+     * @brief Quantizes vertices relative to a bounding box.
+     * @param vertices Source vertices.
+     * @param count Number of source vertices.
+     * @param bounds Bounding box as minX, minY, minZ, maxX, maxY, maxZ.
+     * @param out Output receiving one CompactVertex per source vertex.
+     */
+    static void quantize(const Vertex* vertices, size_t count, const float bounds[6],
+                         std::vector<CompactVertex>& out);
+
+    /**
+     * @brief Decodes compact vertices and compares them with their source.
+     * @param vertices Source vertices.
+     * @param compact Quantized vertices (same order).
+     * @param count Number of vertices to compare.
+     * @param bounds Bounding box used for quantization.
+     * @return The worst-case errors.
+     */
+    static QuantizationError measureError(const Vertex* vertices, const CompactVertex* compact,
+                                          size_t count, const float bounds[6]);
+
+    /**
+     * @brief Gets the dequantization parameters for the shader.
+     * @param bounds Bounding box used for quantization.
+     * @param offset Output receiving the position offset (3 floats).
+     * @param scale Output receiving the position scale (3 floats).
+     */
+    static void getDequantization(const float bounds[6], float* offset, float* scale);
+
+    /**
+     * @brief Converts a float to an IEEE 754 half float (round to nearest even).
+     * @param value The value to convert.
+     * @return The half float bit pattern.
+     */
+    static uint16_t floatToHalf(float value);
+
+    /**
+     * @brief Converts an IEEE 754 half float to a float.
+     * @param value The half float bit pattern.
+     * @return The converted value.
+     */
+    static float halfToFloat(uint16_t value);
+
+    /**
+     * @brief Encodes a unit normal as two snorm16 octahedral coordinates.
+     * @param normal The normal (x, y, z); need not be normalized.
+     * @param out Output receiving the two encoded values.
+     */
+    static void encodeOctahedral(const float* normal, int16_t* out);
+
+    /**
+     * @brief Decodes two snorm16 octahedral coordinates into a unit normal.
+     * @param encoded The two encoded values.
+     * @param normal Output receiving the normal (x, y, z).
+     */
+    static void decodeOctahedral(const int16_t* encoded, float* normal);
+};
+
+#endif // VERTEXQUANTIZER_HPP
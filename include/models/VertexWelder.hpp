@@ -0,0 +1,77 @@
+#ifndef VERTEXWELDER_HPP
+#define VERTEXWELDER_HPP
+
+#include "models/Vertex.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct WeldStats
+ * @brief Statistics reported by a vertex welding pass.
+ */
+struct WeldStats {
+    size_t inputVertices = 0;   ///< Number of vertices submitted (one per triangle corner)
+    size_t uniqueVertices = 0;  ///< Number of vertices left after merging
+    double mergeRatio = 0.0;    ///< inputVertices / uniqueVertices (1.0 means nothing merged)
+    double timeMs = 0.0;        ///< Time spent welding in milliseconds
+};
+
+/**
+ * @class VertexWelder
+ * @brief Deduplicates vertices in linear time using an open-addressing hash map.
+ *
+ * Every attribute of the vertex (position, normal and texture coordinates) is
+ * quantized to a grid with the welding epsilon as cell size, and the resulting
+ * integer tuple is used as the hash key. Two vertices are merged when they fall
+ * into the same cell on every component.
+ */
+class VertexWelder {
+public:
+    /**
+     * @brief Constructs a welder that appends unique vertices to the given array.
+     * @param vertices Output array receiving the unique vertices.
+     * @param epsilon Quantization step used to decide whether two attributes are equal.
+     */
+    VertexWelder(std::vector<Vertex>& vertices, float epsilon = 0.0001f);
+
+    /**
+     * @brief Reserves hash table space for the expected number of unique vertices.
+     * @param count Expected number of unique vertices.
+     */
+    void reserve(size_t count);
+
+    /**
+     * @brief Inserts a vertex, reusing an existing equal vertex if there is one.
+     * @param vertex The vertex to insert.
+     * @return Index of the vertex in the output array.
+     */
+    unsigned int insert(const Vertex& vertex);
+
+    /**
+     * @brief Gets the statistics of the welding performed so far.
+     * @return WeldStats with counts filled in (timeMs is left to the caller).
+     */
+    WeldStats getStats() const;
+
+private:
+    static constexpr uint32_t EMPTY_SLOT = 0xFFFFFFFFu;
+    static constexpr int KEY_COMPONENTS = 8;
+
+    struct Slot {
+        uint64_t hash;
+        uint32_t index;
+    };
+
+    std::vector<Vertex>& m_vertices;
+    std::vector<Slot> m_slots;
+    std::vector<int64_t> m_keys;  // KEY_COMPONENTS quantized values per unique vertex
+    float m_invEpsilon;
+    size_t m_inputCount;
+
+    void quantize(const Vertex& vertex, int64_t* key) const;
+    static uint64_t hashKey(const int64_t* key);
+    void grow();
+};
+
+#endif // VERTEXWELDER_HPP
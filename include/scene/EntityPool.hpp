@@ -0,0 +1,276 @@
+#ifndef ENTITYPOOL_HPP
+#define ENTITYPOOL_HPP
+
+#include "scene/TransformBatch.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct EntityHandle
+ * @brief Generational reference to an entity in an EntityPool.
+ *
+ * The generation changes each time a slot is reused, so a handle to a
+ * destroyed entity is recognized as stale instead of reaching its successor.
+ * A default-constructed handle refers to no entity.
+ */
+struct EntityHandle {
+    static constexpr uint32_t INVALID_SLOT = 0xFFFFFFFFu;
+
+    uint32_t slot = INVALID_SLOT;   ///< Index into the pool's slot table
+    uint32_t generation = 0;        ///< Generation of the slot when the entity was created
+
+    /**
+     * @brief Checks whether the handle was returned by EntityPool::create.
+     * @return True unless default-constructed; the entity may since have been destroyed.
+     */
+    bool isValid() const { return slot != INVALID_SLOT; }
+
+    bool operator==(const EntityHandle& other) const { return slot == other.slot && generation == other.generation; }
+    bool operator!=(const EntityHandle& other) const { return !(*this == other); }
+};
+
+/**
+ * @struct EntityBounds
+ * @brief Axis-aligned bounding box.
+ */
+struct EntityBounds {
+    float min[3];
+    float max[3];
+};
+
+/**
+ * @class EntityPool
+ * @brief Scene entities stored as structure-of-arrays components, addressed by generational handles.
+ *
+ * Each component (local transform, world matrices, local and world bounds,
+ * parent, render id, level of detail) is one contiguous array. Live entities
+ * are packed at indices 0..size()-1 in every array: destroy() moves the last
+ * entity into the freed index, and the slot table maps handles to the
+ * current index. Per-frame passes therefore stream linearly over the arrays
+ * by index, without following pointers.
+ *
+ * Entities form a hierarchy: an entity's transform is relative to its
+ * parent's. Changing a transform or parent marks the entity dirty, and
+ * updateWorld recomputes the world matrices and bounds of dirty entities and
+ * their descendants only, parents before children, so an entity that did
+ * not move costs nothing. The update walks a depth-first order of the
+ * hierarchy in which every subtree is one contiguous range; the order is
+ * rebuilt by the first updateWorld after entities are destroyed or
+ * reparented.
+ */
+class EntityPool {
+public:
+    /// Returned by getIndex for a stale or invalid handle
+    static constexpr size_t INVALID_INDEX = static_cast<size_t>(-1);
+
+    /**
+     * @brief Constructs an empty pool.
+     */
+    EntityPool();
+
+    /**
+     * @brief Creates an entity.
+     * @param position Translation (3 floats).
+     * @param rotation Unit quaternion as x, y, z, w (4 floats).
+     * @param scale Scale along each local axis (3 floats).
+     * @param localBounds Bounds of the entity's mesh in its own space.
+     * @param renderId Caller-defined id of what the entity draws, e.g. an index into a model table.
+     * @param parent Entity the transform is relative to; invalid or stale for a root (default).
+     * @return Handle to the new entity.
+     */
+    EntityHandle create(const float* position, const float* rotation, const float* scale,
+                        const EntityBounds& localBounds, uint32_t renderId, EntityHandle parent = EntityHandle());
+
+    /**
+     * @brief Destroys an entity; its handle and any copies become stale.
+     *
+     * Its children become roots, their transforms now relative to the world.
+     * @param handle The entity.
+     * @return True if the entity existed, false if the handle was stale.
+     */
+    bool destroy(EntityHandle handle);
+
+    /**
+     * @brief Destroys every entity.
+     */
+    void clear();
+
+    /**
+     * @brief Checks whether a handle refers to a live entity.
+     * @param handle The handle.
+     * @return True if the entity has not been destroyed.
+     */
+    bool isAlive(EntityHandle handle) const { return getIndex(handle) != INVALID_INDEX; }
+
+    /**
+     * @brief Gets the index of an entity in the component arrays.
+     *
+     * Indices change when another entity is destroyed; keep the handle, not the index.
+     * @param handle The entity.
+     * @return The index, or INVALID_INDEX if the handle is stale.
+     */
+    size_t getIndex(EntityHandle handle) const;
+
+    /**
+     * @brief Gets the handle of the entity at an index.
+     * @param index Index less than size().
+     * @return The entity's handle.
+     */
+    EntityHandle getHandle(size_t index) const;
+
+    /**
+     * @brief Gets the number of live entities.
+     * @return The entity count.
+     */
+    size_t size() const { return m_slotOfIndex.size(); }
+
+    /**
+     * @brief Replaces an entity's transform relative to its parent.
+     *
+     * The entity and its descendants are updated by the next updateWorld.
+     * @param handle The entity.
+     * @param position Translation (3 floats).
+     * @param rotation Unit quaternion as x, y, z, w (4 floats).
+     * @param scale Scale along each local axis (3 floats).
+     * @return True if the entity exists, false if the handle was stale.
+     */
+    bool setTransform(EntityHandle handle, const float* position, const float* rotation, const float* scale);
+
+    /**
+     * @brief Reads an entity's transform relative to its parent.
+     * @param handle The entity.
+     * @param position Output receiving the translation (3 floats).
+     * @param rotation Output receiving the quaternion (4 floats).
+     * @param scale Output receiving the scale (3 floats).
+     * @return True if the entity exists, false if the handle was stale.
+     */
+    bool getTransform(EntityHandle handle, float* position, float* rotation, float* scale) const;
+
+    /**
+     * @brief Attaches an entity to a parent, or detaches it.
+     *
+     * The entity keeps its transform, which from now on is relative to the new parent.
+     * @param child The entity to move.
+     * @param parent The new parent, or an invalid handle to make the entity a root.
+     * @return False if either entity is stale or parent is child itself or one of its descendants.
+     */
+    bool setParent(EntityHandle child, EntityHandle parent);
+
+    /**
+     * @brief Gets an entity's parent.
+     * @param handle The entity.
+     * @return The parent, or an invalid handle for a root or stale entity.
+     */
+    EntityHandle getParent(EntityHandle handle) const;
+
+    /**
+     * @brief Recomputes the world matrices, normal matrices and world bounds of changed entities.
+     *
+     * Entities whose transform or parent changed since the last call are
+     * updated together with all their descendants.
+     * @return The number of entities updated.
+     */
+    size_t updateWorld();
+
+    /**
+     * @brief Computes the model-view-projection matrices of some entities, e.g. the visible ones.
+     * @param viewProjection The camera's projection times view matrix (column-major).
+     * @param indices Indices of the entities, as returned by cull.
+     */
+    void updateClipMatrices(const float* viewProjection, const std::vector<uint32_t>& indices);
+
+    /**
+     * @brief Collects the entities whose world bounds intersect the view frustum.
+     * @param viewProjection The camera's projection times view matrix (column-major).
+     * @param visible Output receiving the indices of visible entities in ascending order.
+     */
+    void cull(const float* viewProjection, std::vector<uint32_t>& visible) const;
+
+    /**
+     * @brief Gets an entity's matrices.
+     *
+     * The model and normal matrices are current after updateWorld, the
+     * model-view-projection after updateClipMatrices included the entity.
+     * @param index Index less than size().
+     * @return Reference to the matrices.
+     */
+    const ObjectTransform& getMatrices(size_t index) const { return m_transforms.get(index); }
+
+    /**
+     * @brief Gets an entity's bounds in its model's space.
+     * @param index Index less than size().
+     * @return Reference to the bounds given to create.
+     */
+    const EntityBounds& getLocalBounds(size_t index) const { return m_localBounds[index]; }
+
+    /**
+     * @brief Gets an entity's bounds in world space, as of the last updateWorld.
+     * @param index Index less than size().
+     * @return Reference to the bounds.
+     */
+    const EntityBounds& getWorldBounds(size_t index) const { return m_worldBounds[index]; }
+
+    /**
+     * @brief Gets the largest scale factor from an entity's model units to world units, as of the last updateWorld.
+     * @param index Index less than size().
+     * @return The scale.
+     */
+    float getMaxScale(size_t index) const { return m_maxScales[index]; }
+
+    /**
+     * @brief Gets what an entity draws.
+     * @param index Index less than size().
+     * @return The render id given to create.
+     */
+    uint32_t getRenderId(size_t index) const { return m_renderIds[index]; }
+
+    /**
+     * @brief Gets an entity's current level of detail.
+     * @param index Index less than size().
+     * @return The level index (0 is the full mesh).
+     */
+    uint32_t getLod(size_t index) const { return m_lods[index]; }
+
+    /**
+     * @brief Sets an entity's current level of detail.
+     * @param index Index less than size().
+     * @param lod The level index.
+     */
+    void setLod(size_t index, uint32_t lod) { m_lods[index] = lod; }
+
+private:
+    struct Slot {
+        uint32_t generation;
+        uint32_t index;   // Index into the component arrays while the slot is in use
+    };
+
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_freeSlots;
+    std::vector<uint32_t> m_dirtySlots;       // Slots marked dirty since the last updateWorld
+
+    // Components, one entry per live entity
+    TransformBatch m_transforms;
+    std::vector<EntityBounds> m_localBounds;
+    std::vector<EntityBounds> m_worldBounds;
+    std::vector<float> m_maxScales;
+    std::vector<uint32_t> m_renderIds;
+    std::vector<uint32_t> m_lods;
+    std::vector<uint32_t> m_slotOfIndex;
+    std::vector<uint32_t> m_parentSlots;      // EntityHandle::INVALID_SLOT for roots
+    std::vector<uint32_t> m_childCounts;
+    std::vector<uint8_t> m_dirty;
+
+    // Depth-first order of the hierarchy: a subtree starting at position p ends before m_subtreeEnds[p]
+    std::vector<uint32_t> m_order;            // Entity index at each position
+    std::vector<uint32_t> m_orderPositions;   // Position of each entity index
+    std::vector<uint32_t> m_subtreeEnds;
+    bool m_orderValid;
+    std::vector<uint32_t> m_updateScratch;
+
+    void markDirty(size_t index);
+    void rebuildOrder();
+    void updateEntity(size_t index);
+};
+
+#endif // ENTITYPOOL_HPP
@@ -2,8 +2,15 @@
 #define SCENE_HPP
 
 #include "scene/SceneObject.hpp"
+#include "scene/EntityPool.hpp"
 #include "core/Camera.hpp"
-#include "core/Shader.hpp"
+#include "core/ShaderPermutations.hpp"
+#include "core/ShaderReloader.hpp"
+#include "core/StagingRing.hpp"
+#include "core/TextureAtlas.hpp"
+#include "core/TextureResidencyManager.hpp"
+#include "core/UniformRing.hpp"
+#include "models/ModelLoader.hpp"
 #include <vector>
 #include <memory>
 
@@ -13,6 +20,13 @@
  * 
  * This class serves as the main container for all scene objects, manages
  * the camera, shaders, and coordinates rendering of the entire scene.
+ *
+ * Placed objects are entities in an EntityPool: their transforms, bounds
+ * and levels of detail live in contiguous arrays, and each refers to its
+ * model by an index into a table of the scene's unique models. A frame
+ * recomputes the matrices of the entities moved since the last one, and of
+ * their descendants, in one batch; then it culls entities against the view
+ * frustum and builds the draw list from the visible ones.
  */
 class Scene {
 public:
@@ -39,6 +53,20 @@ public:
      */
     void render();
     
+    /**
+     * @brief Replaces the built-in scene shader with source files and reloads them whenever they are saved.
+     *
+     * The files follow the built-in shader: a #version line, then code using
+     * the FrameBlock and ObjectBlock uniform blocks (inserted after #version)
+     * and #ifdef blocks for the ShaderFeatures names. A save recompiles every
+     * permutation in the background; frames keep using the previous programs
+     * until the new ones link. Call after initialize.
+     * @param vertexPath Path to the vertex shader source file.
+     * @param fragmentPath Path to the fragment shader source file.
+     * @return True if the files compiled and are watched; otherwise the built-in shader is kept.
+     */
+    bool loadShaderFiles(const std::string& vertexPath, const std::string& fragmentPath);
+    
     /**
      * @brief Cleans up all scene resources.
      */
@@ -46,6 +74,9 @@ public:
     
     /**
      * @brief Adds a 3D object to the scene.
+     *
+     * Objects added from the same OBJ with the same vertex options share one
+     * model, so load time and GPU memory grow with unique assets, not instances.
      * @param modelPath Path to the OBJ model file.
      * @param posX X position in world space (default: 0.0).
      * @param posY Y position in world space (default: 0.0).
@@ -53,25 +84,228 @@ public:
      * @param scaleX X scale factor (default: 1.0).
      * @param scaleY Y scale factor (default: 1.0).
      * @param scaleZ Z scale factor (default: 1.0).
+     * @return Handle to the object's entity; invalid if loading failed or the model is still
+     *         loading for another object, in which case the object is placed once it is ready.
+     */
+    EntityHandle addObject(const std::string& modelPath, float posX = 0.0f, float posY = 0.0f, float posZ = 0.0f,
+                           float scaleX = 1.0f, float scaleY = 1.0f, float scaleZ = 1.0f);
+    
+    /**
+     * @brief Removes a placed object from the scene.
+     * @param handle The object's entity.
+     * @return True if the object existed, false if the handle was stale.
+     */
+    bool removeObject(EntityHandle handle);
+    
+    /**
+     * @brief Moves a placed object.
+     *
+     * As in addObject, position is where the center of the model's bounds
+     * goes, not the model's origin: the origin is offset by the center
+     * scaled and rotated by the new transform. The transform is relative to
+     * the object's parent, or to the world for a root. The object and its
+     * descendants get new world matrices in the next render(); objects that
+     * are never moved cost nothing per frame.
+     * @param handle The object's entity.
+     * @param position Position of the model's center (3 floats).
+     * @param rotation Unit quaternion as x, y, z, w (4 floats).
+     * @param scale Scale along each local axis (3 floats).
+     * @return True if the object exists, false if the handle was stale.
+     */
+    bool setObjectTransform(EntityHandle handle, const float* position, const float* rotation, const float* scale);
+    
+    /**
+     * @brief Attaches a placed object to another so it follows the other's transform.
+     * @param child The object to attach; its transform becomes relative to the parent.
+     * @param parent The new parent, or an invalid handle to detach the object.
+     * @return False if either handle is stale or the parent is the child or one of its descendants.
      */
-    void addObject(const std::string& modelPath, float posX = 0.0f, float posY = 0.0f, float posZ = 0.0f,
-                  float scaleX = 1.0f, float scaleY = 1.0f, float scaleZ = 1.0f);
+    bool setObjectParent(EntityHandle child, EntityHandle parent);
+    
+    /**
+     * @brief Adds a 3D object whose model loads in the background.
+     *
+     * Parsing and image decoding run on worker threads; the GPU upload happens
+     * in render() within the upload budget. The object stays invisible until
+     * its model is uploaded, and is dropped if the load fails or is cancelled.
+     * @param modelPath Path to the OBJ model file.
+     * @param posX X position in world space (default: 0.0).
+     * @param posY Y position in world space (default: 0.0).
+     * @param posZ Z position in world space (default: 0.0).
+     * @param scaleX X scale factor (default: 1.0).
+     * @param scaleY Y scale factor (default: 1.0).
+     * @param scaleZ Z scale factor (default: 1.0).
+     * @return Handle reporting the load's progress and allowing cancellation.
+     */
+    ModelLoadHandle addObjectAsync(const std::string& modelPath, float posX = 0.0f, float posY = 0.0f,
+                                   float posZ = 0.0f, float scaleX = 1.0f, float scaleY = 1.0f,
+                                   float scaleZ = 1.0f);
+    
+    /**
+     * @brief Sets the time render() may spend uploading finished background loads per frame.
+     * @param milliseconds Upload budget (default: 2.0); at least one load is uploaded per frame.
+     */
+    void setUploadBudget(float milliseconds) { m_uploadBudgetMs = milliseconds; }
+    
+    /**
+     * @brief Sets the bytes of streamed texture levels render() may upload per frame.
+     * @param bytes Streaming budget (default: 4 MB); at least one level is uploaded per frame.
+     */
+    void setStreamingBudget(size_t bytes) { m_streamingBudget = bytes; }
+    
+    /**
+     * @brief Merges the textures of all placed objects into one TextureAtlas.
+     *
+     * Afterwards render() binds the atlas once per frame and the objects'
+     * models select their layer and region through uniforms instead of
+     * binding their own textures. Objects added later, and objects whose
+     * textures are still being decoded, bind their textures as before until
+     * the atlas is built again.
+     * @return True if the atlas holds at least one texture, false otherwise.
+     */
+    bool buildTextureAtlas();
+    
+    /**
+     * @brief Gets the texture atlas, e.g. to inspect its layers.
+     * @return Reference to the TextureAtlas (invalid until buildTextureAtlas succeeds).
+     */
+    const TextureAtlas& getTextureAtlas() const { return m_atlas; }
+    
+    /**
+     * @brief Gets the placed objects.
+     * @return Reference to the EntityPool.
+     */
+    const EntityPool& getEntities() const { return m_entities; }
+    
+    /**
+     * @brief Gets the number of placed objects that passed frustum culling in the last render().
+     * @return The visible object count.
+     */
+    size_t getVisibleObjectCount() const { return m_visible.size(); }
+    
+    /**
+     * @brief Gets the number of objects whose world matrices the last render() recomputed.
+     * @return The updated object count; 0 when nothing moved.
+     */
+    size_t getTransformUpdateCount() const { return m_transformUpdateCount; }
+    
+    /**
+     * @brief Gets the number of objects whose models are still loading.
+     * @return The pending object count.
+     */
+    size_t getPendingObjectCount() const { return m_pendingObjects.size(); }
     
     /**
      * @brief Gets a reference to the scene's camera.
      * @return Reference to the Camera object.
      */
     Camera& getCamera() { return m_camera; }
+    
+    /**
+     * @brief Enables or disables compact vertices for objects added afterwards.
+     * @param enabled True to upload compact vertices (default: false).
+     */
+    void setCompactVertices(bool enabled) { m_compactVertices = enabled; }
+    
+    /**
+     * @brief Enables or disables meshlet culling for objects added afterwards.
+     * @param enabled True to build meshlets and cull them per frame (default: false).
+     */
+    void setMeshletsEnabled(bool enabled) { m_meshletsEnabled = enabled; }
+    
+    /**
+     * @brief Gets the meshlet culler, e.g. to toggle cone culling.
+     * @return Reference to the ClusterCuller.
+     */
+    ClusterCuller& getClusterCuller() { return m_culler; }
+    
+    /**
+     * @brief Gets the meshlet culling counters of the last rendered frame.
+     * @return Reference to the ClusterCullStats.
+     */
+    const ClusterCullStats& getCullStats() const { return m_culler.getStats(); }
+    
+    /**
+     * @brief Sets the largest screen-space error, in pixels, accepted when picking LODs.
+     * @param pixels Error threshold (default: 1.0).
+     */
+    void setLodThreshold(float pixels) { m_lodThreshold = pixels; }
+    
+    /**
+     * @brief Sets the GPU memory budget for textures.
+     *
+     * When the resident mip levels exceed it, the finest levels of the least
+     * recently drawn textures are evicted, and brought back once an object
+     * using them is drawn close enough to need them again.
+     * @param bytes Budget in bytes, or 0 for no limit (the default).
+     */
+    void setTextureBudget(size_t bytes) { TextureResidencyManager::shared().setBudget(bytes); }
+    
+    /**
+     * @brief Gets texture memory usage and eviction counters.
+     * @return Reference to the TextureResidencyStats as of the last rendered frame.
+     */
+    const TextureResidencyStats& getTextureStats() const { return TextureResidencyManager::shared().getStats(); }
+    
+    /**
+     * @brief Gets the counters of the staging ring that streamed texture levels go through.
+     * @return Reference to the StagingStats.
+     */
+    const StagingStats& getStagingStats() const { return m_staging.getStats(); }
+    
+    /**
+     * @brief Gets the uniform calls and lookups made by the scene shaders in the last rendered frame.
+     * @return The UniformStats summed over every shader permutation.
+     */
+    UniformStats getUniformStats() const { return m_shaders.getStats(); }
+    
+    /**
+     * @brief Gets the number of scene shader permutations built so far.
+     * @return The variant count.
+     */
+    size_t getShaderVariantCount() const { return m_shaders.getVariantCount(); }
 
 private:
-    std::vector<std::unique_ptr<SceneObject>> m_objects;
+    struct PendingObject {
+        std::unique_ptr<SceneObject> object;
+        ModelLoadHandle handle;
+        float position[3];
+        float scale[3];
+    };
+    
+    EntityPool m_entities;
+    std::vector<std::shared_ptr<Model>> m_models;     // Indexed by render id; null once unused
+    std::vector<uint32_t> m_modelUsers;               // Entities per render id
+    std::vector<PendingObject> m_pendingObjects;
     Camera m_camera;
-    Shader m_shader;
+    ShaderPermutations m_shaders;
+    ShaderReloader m_shaderReloader;
     float m_width;
     float m_height;
+    bool m_compactVertices;
+    bool m_meshletsEnabled;
+    ClusterCuller m_culler;
+    float m_lodThreshold;
+    float m_uploadBudgetMs;
+    size_t m_streamingBudget;
+    TextureAtlas m_atlas;
+    StagingRing m_staging;
+    UniformRing m_uniformRing;
+    std::vector<uint32_t> m_visible;                  // Entity indices that passed culling this frame
+    size_t m_transformUpdateCount;
+    std::vector<size_t> m_objectOffsets;              // Per visible entity
+    std::vector<uint32_t> m_objectFeatures;
+    std::vector<std::pair<uint32_t, size_t>> m_drawItems;   // Feature mask and visible index, sorted by mask
+    ModelLoader m_loader;
     
     void setupCamera();
     bool loadShaders();
+    void processPendingObjects();
+    void queuePendingObject(std::unique_ptr<SceneObject> obj, const ModelLoadHandle& handle,
+                            float posX, float posY, float posZ, float scaleX, float scaleY, float scaleZ);
+    EntityHandle placeObject(const SceneObject& obj, float posX, float posY, float posZ,
+                             float scaleX, float scaleY, float scaleZ);
+    uint32_t acquireRenderId(const std::shared_ptr<Model>& model);
 };
 
 #endif // SCENE_HPP
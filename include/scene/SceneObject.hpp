@@ -2,18 +2,27 @@
 #define SCENEOBJECT_HPP
 
 #include "models/Model.hpp"
+#include "models/ModelLoader.hpp"
+#include <memory>
 #include <string>
 
 /**
  * @class SceneObject
- * @brief Represents a 3D object in the scene with position, scale, and rotation.
- * 
- * This class wraps a Model and adds transformation properties (position, scale, rotation)
- * that define how the model appears in the scene. It can compute model matrices
- * and bounding boxes in both local and world space.
+ * @brief Loads the model of an object being added to the scene.
+ *
+ * Scene creates one per addObject call to get the model, synchronously or
+ * through a ModelLoader, and the model's local bounds. Once the model is
+ * ready the object is placed in the EntityPool, which holds its transform
+ * and level of detail; the SceneObject itself is not drawn.
+ *
+ * Models come from the shared AssetCache, so objects created from the same
+ * OBJ with the same vertex options share one Model and its GPU buffers.
  */
 class SceneObject {
 public:
+    /// Fraction of the error threshold a coarser level must fit in before selectLod switches to it
+    static constexpr float LOD_HYSTERESIS = 0.75f;
+
     /**
      * @brief Constructs a scene object with the specified model path.
      * @param modelPath Path to the OBJ model file.
@@ -26,58 +35,52 @@ public:
     ~SceneObject();
 
     /**
-     * @brief Loads the model from the file path.
+     * @brief Gets the model from the shared asset cache, loading it on first use.
      * @return True if loading succeeded, false otherwise.
      */
     bool load();
     
     /**
-     * @brief Renders the object using its current transformation.
-     */
-    void render() const;
-    
-    /**
-     * @brief Sets the position of the object in world space.
-     * @param x The X coordinate.
-     * @param y The Y coordinate.
-     * @param z The Z coordinate.
-     */
-    void setPosition(float x, float y, float z);
-    
-    /**
-     * @brief Sets the scale of the object along each axis.
-     * @param x Scale factor along the X axis.
-     * @param y Scale factor along the Y axis.
-     * @param z Scale factor along the Z axis.
+     * @brief Gets the model from the shared asset cache, loading it in the background on first use.
+     *
+     * The object is not placed in the scene until isReady() returns true.
+     * @param loader Loader that parses on worker threads and uploads on the GL thread.
+     * @return Handle to the model's load; already Ready if the model was loaded before.
      */
-    void setScale(float x, float y, float z);
+    ModelLoadHandle loadAsync(ModelLoader& loader);
     
     /**
-     * @brief Sets the rotation of the object using an axis-angle representation.
-     * @param angle Rotation angle in radians.
-     * @param x X component of the rotation axis.
-     * @param y Y component of the rotation axis.
-     * @param z Z component of the rotation axis.
+     * @brief Checks whether the object's model is uploaded and can be drawn.
+     * @return True if the model is ready.
      */
-    void setRotation(float angle, float x, float y, float z);
+    bool isReady() const { return m_model && m_model->isReady(); }
     
     /**
-     * @brief Gets the model matrix (transformation matrix) for this object.
-     * @param matrix Output parameter for the 16-element matrix array (column-major order).
+     * @brief Picks a model's level of detail from its projected screen-space error.
+     *
+     * The coarsest level whose error, projected at the distance of the
+     * object's bounding sphere, stays within the threshold is selected. A
+     * coarser level must fit within LOD_HYSTERESIS times the threshold before
+     * the object switches to it, so the choice does not flicker at the boundary.
+     * @param model The model.
+     * @param currentLod Level selected in the previous frame.
+     * @param pixelsPerUnit Screen pixels per model unit, from getPixelsPerUnit.
+     * @param thresholdPixels Largest acceptable error in pixels.
+     * @return The level index to draw.
      */
-    void getModelMatrix(float* matrix) const;
+    static size_t selectLod(const Model& model, size_t currentLod, float pixelsPerUnit, float thresholdPixels);
     
     /**
-     * @brief Gets the axis-aligned bounding box in world space.
-     * @param minX Output parameter for minimum X coordinate.
-     * @param minY Output parameter for minimum Y coordinate.
-     * @param minZ Output parameter for minimum Z coordinate.
-     * @param maxX Output parameter for maximum X coordinate.
-     * @param maxY Output parameter for maximum Y coordinate.
-     * @param maxZ Output parameter for maximum Z coordinate.
+     * @brief Estimates how many screen pixels a model unit covers at an object's nearest point.
+     * @param worldMin Minimum corner of the object's world bounds (3 floats).
+     * @param worldMax Maximum corner of the object's world bounds (3 floats).
+     * @param maxScale Largest absolute scale factor of the object.
+     * @param cameraPosition Camera position in world space (3 floats).
+     * @param projectionScale Pixels per world unit at distance 1 (viewport height * projection[5] / 2).
+     * @return Pixels per model unit.
      */
-    void getBoundingBox(float& minX, float& minY, float& minZ,
-                       float& maxX, float& maxY, float& maxZ) const;
+    static float getPixelsPerUnit(const float* worldMin, const float* worldMax, float maxScale,
+                                  const float* cameraPosition, float projectionScale);
     
     /**
      * @brief Gets the axis-aligned bounding box in local space (before transformations).
@@ -95,17 +98,39 @@ public:
      * @brief Checks if the object's model has an associated texture.
      * @return True if a texture is loaded, false otherwise.
      */
-    bool hasTexture() const { return m_model.hasTexture(); }
+    bool hasTexture() const { return m_model && m_model->hasTexture(); }
+    
+    /**
+     * @brief Enables or disables the compact GPU vertex format for the next load.
+     * @param enabled True to upload compact vertices.
+     */
+    void setCompactVertices(bool enabled) { m_compactVertices = enabled; }
+    
+    /**
+     * @brief Enables or disables meshlet partitioning for the next load.
+     * @param enabled True to build meshlets for per-cluster culling.
+     */
+    void setMeshletsEnabled(bool enabled) { m_meshletsEnabled = enabled; }
+    
+    /**
+     * @brief Gets the path of the object's OBJ file.
+     * @return Reference to the model path.
+     */
+    const std::string& getModelPath() const { return m_modelPath; }
+    
+    /**
+     * @brief Gets the model shared by this object.
+     * @return Handle to the model, or nullptr before a successful load.
+     */
+    const std::shared_ptr<Model>& getModel() const { return m_model; }
 
 private:
     std::string m_modelPath;
-    Model m_model;
-    
-    float m_position[3];
-    float m_scale[3];
-    float m_rotation[4]; // angle, x, y, z
+    std::shared_ptr<Model> m_model;
+    bool m_compactVertices;
+    bool m_meshletsEnabled;
     
-    void buildModelMatrix(float* matrix) const;
+    std::string getModelVariant() const;
 };
 
 #endif // SCENEOBJECT_HPP
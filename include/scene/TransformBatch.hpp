@@ -0,0 +1,150 @@
+#ifndef TRANSFORMBATCH_HPP
+#define TRANSFORMBATCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct ObjectTransform
+ * @brief The matrices of one object computed by TransformBatch, all column-major.
+ */
+struct ObjectTransform {
+    float model[16];                 ///< Model to world
+    float normal[12];                ///< Inverse transpose of the model's 3x3, as three std140 vec4 columns
+    float modelViewProjection[16];   ///< Model to clip space
+};
+
+/**
+ * @class TransformBatch
+ * @brief Computes the model, normal and model-view-projection matrices of many objects at once.
+ *
+ * Objects are added as position, rotation quaternion and scale, stored as
+ * structure-of-arrays; they can be kept across frames and edited in place,
+ * as EntityPool does. compute() then builds every object's matrices in
+ * groups of LANES objects, one object per SSE2 lane, and writes them out
+ * per object, ready to copy into uniform blocks. Builds without SSE2 use a
+ * scalar loop with the same arithmetic, so both give identical results.
+ *
+ * The normal matrix is derived from the model matrix with cofactors, so it
+ * stays correct for non-uniform and negative scales.
+ */
+class TransformBatch {
+public:
+    /// Objects computed together in one group
+    static constexpr size_t LANES = 4;
+
+    /**
+     * @brief Constructs an empty batch.
+     */
+    TransformBatch();
+
+    /**
+     * @brief Removes every object, keeping the allocated storage.
+     */
+    void clear();
+
+    /**
+     * @brief Appends an object.
+     * @param position Translation (3 floats).
+     * @param rotation Unit quaternion as x, y, z, w (4 floats).
+     * @param scale Scale along each local axis (3 floats).
+     * @return Index of the object, to pass to get.
+     */
+    size_t add(const float* position, const float* rotation, const float* scale);
+
+    /**
+     * @brief Replaces an object's transform.
+     * @param index Index returned by add.
+     * @param position Translation (3 floats).
+     * @param rotation Unit quaternion as x, y, z, w (4 floats).
+     * @param scale Scale along each local axis (3 floats).
+     */
+    void set(size_t index, const float* position, const float* rotation, const float* scale);
+
+    /**
+     * @brief Removes an object by moving the last object into its place.
+     * @param index Index of the object to remove; the last object takes this index.
+     */
+    void remove(size_t index);
+
+    /**
+     * @brief Reads back an object's transform.
+     * @param index Index returned by add.
+     * @param position Output receiving the translation (3 floats).
+     * @param rotation Output receiving the quaternion (4 floats).
+     * @param scale Output receiving the scale (3 floats).
+     */
+    void getInputs(size_t index, float* position, float* rotation, float* scale) const;
+
+    /**
+     * @brief Computes the matrices of every object added since the last clear.
+     * @param viewProjection The camera's projection times view matrix (column-major).
+     */
+    void compute(const float* viewProjection);
+
+    /**
+     * @brief Sets an object's model and normal matrices from its transform relative to a parent.
+     *
+     * For transform hierarchies, where only some objects change per frame;
+     * the model-view-projection matrix is left to computeClip.
+     * @param index Index returned by add.
+     * @param parentWorld The parent's model matrix (column-major, affine), or nullptr for a root.
+     */
+    void updateWorld(size_t index, const float* parentWorld);
+
+    /**
+     * @brief Computes the model-view-projection matrices of some objects from their current model matrices.
+     * @param indices Indices of the objects, e.g. those that passed culling.
+     * @param count Number of indices.
+     * @param viewProjection The camera's projection times view matrix (column-major).
+     */
+    void computeClip(const uint32_t* indices, size_t count, const float* viewProjection);
+
+    /**
+     * @brief Gets the matrices of an object after compute, or updateWorld and computeClip.
+     * @param index Index returned by add.
+     * @return Reference to the object's matrices.
+     */
+    const ObjectTransform& get(size_t index) const { return m_transforms[index]; }
+
+    /**
+     * @brief Gets the number of objects in the batch.
+     * @return The object count.
+     */
+    size_t size() const { return m_count; }
+
+    /**
+     * @brief Enables or disables the SSE2 path.
+     * @param enabled False to force the scalar loop (for verification and benchmarks).
+     */
+    void setSimdEnabled(bool enabled) { m_simdEnabled = enabled; }
+
+    /**
+     * @brief Checks whether compute uses SSE2.
+     * @return True if the build has SSE2 and it was not disabled.
+     */
+    bool isSimdEnabled() const;
+
+    /**
+     * @brief Builds a single model matrix, the same way compute does.
+     * @param position Translation (3 floats).
+     * @param rotation Unit quaternion as x, y, z, w (4 floats).
+     * @param scale Scale along each local axis (3 floats).
+     * @param matrix Output receiving the 16-element matrix (column-major).
+     */
+    static void composeModel(const float* position, const float* rotation, const float* scale, float* matrix);
+
+private:
+    enum Input { PX, PY, PZ, QX, QY, QZ, QW, SX, SY, SZ, INPUT_COUNT };
+
+    std::vector<float> m_inputs[INPUT_COUNT];   // One array per component, padded to a multiple of LANES
+    std::vector<ObjectTransform> m_transforms;
+    size_t m_count;
+    bool m_simdEnabled;
+
+    void computeScalar(size_t index, const float* viewProjection);
+    void computeGroup(size_t first, const float* viewProjection);
+};
+
+#endif // TRANSFORMBATCH_HPP
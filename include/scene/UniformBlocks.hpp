@@ -0,0 +1,61 @@
+#ifndef UNIFORMBLOCKS_HPP
+#define UNIFORMBLOCKS_HPP
+
+#include <GL/glew.h>
+
+/**
+ * @struct FrameUniforms
+ * @brief Camera and light data shared by every program, laid out as the std140 FrameBlock.
+ */
+struct FrameUniforms {
+    float view[16];
+    float projection[16];
+    float lightPos[4];      ///< xyz used
+    float lightColor[4];    ///< xyz used
+    float viewPos[4];       ///< xyz used
+};
+
+/**
+ * @struct ObjectUniforms
+ * @brief Per-object transforms, laid out as the std140 ObjectBlock.
+ *
+ * The normal and model-view-projection matrices are computed on the CPU
+ * (see TransformBatch), so vertex shaders do not invert the model matrix.
+ */
+struct ObjectUniforms {
+    float model[16];
+    float modelViewProjection[16];
+    float normalMatrix[12];     ///< mat3 as three vec4 columns, xyz used
+    float positionOffset[4];    ///< Dequantization of compact vertices, xyz used
+    float positionScale[4];     ///< Dequantization of compact vertices, xyz used
+};
+
+/// Binding point of FrameBlock in every program
+constexpr GLuint FRAME_BLOCK_BINDING = 0;
+
+/// Binding point of ObjectBlock in every program
+constexpr GLuint OBJECT_BLOCK_BINDING = 1;
+
+/// GLSL declaration of both blocks, to paste after the #version line of a shader
+constexpr const char* UNIFORM_BLOCKS_GLSL = R"(
+layout(std140) uniform FrameBlock {
+    mat4 view;
+    mat4 projection;
+    vec4 lightPos;
+    vec4 lightColor;
+    vec4 viewPos;
+};
+
+layout(std140) uniform ObjectBlock {
+    mat4 model;
+    mat4 modelViewProjection;
+    mat3 normalMatrix;
+    vec4 positionOffset;
+    vec4 positionScale;
+};
+)";
+
+static_assert(sizeof(FrameUniforms) == 176, "FrameUniforms must match the std140 FrameBlock");
+static_assert(sizeof(ObjectUniforms) == 208, "ObjectUniforms must match the std140 ObjectBlock");
+
+#endif // UNIFORMBLOCKS_HPP
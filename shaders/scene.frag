@@ -0,0 +1,54 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoord;
+
+#if defined(TEXTURE_LAYERS)
+uniform sampler2DArray textureLayers;
+uniform float textureLayer;
+uniform vec4 layerTransform;
+#elif defined(TEXTURED)
+uniform sampler2D texture_diffuse1;
+#else
+uniform vec3 materialDiffuse;
+#endif
+#ifdef SPECULAR
+uniform vec3 materialSpecular;
+uniform float materialShininess;
+#endif
+
+void main() {
+#if defined(TEXTURE_LAYERS)
+    // Wrap inside the atlas region; gradients of the unwrapped UVs keep mip selection smooth
+    vec2 uv = layerTransform.zw + fract(TexCoord) * layerTransform.xy;
+    vec2 dx = dFdx(TexCoord) * layerTransform.xy;
+    vec2 dy = dFdy(TexCoord) * layerTransform.xy;
+    vec3 objectColor = textureGrad(textureLayers, vec3(uv, textureLayer), dx, dy).rgb;
+#elif defined(TEXTURED)
+    vec3 objectColor = texture(texture_diffuse1, TexCoord).rgb;
+#else
+    vec3 objectColor = materialDiffuse;
+#endif
+    
+    // Ambient
+    float ambientStrength = 0.3;
+    vec3 ambient = ambientStrength * lightColor.rgb;
+    
+    // Diffuse
+    vec3 norm = normalize(Normal);
+    vec3 lightDir = normalize(lightPos.xyz - FragPos);
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = diff * lightColor.rgb;
+    
+    vec3 result = ambient + diffuse;
+#ifdef SPECULAR
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
+    vec3 reflectDir = reflect(-lightDir, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), materialShininess);
+    result += materialSpecular * spec * lightColor.rgb;
+#endif
+    
+    FragColor = vec4(result * objectColor, 1.0);
+}
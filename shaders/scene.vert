@@ -0,0 +1,31 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+
+#ifdef QUANTIZED_VERTEX
+vec3 octDecode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+#endif
+
+void main() {
+#ifdef QUANTIZED_VERTEX
+    vec3 position = positionOffset.xyz + aPos * positionScale.xyz;
+    vec3 normal = octDecode(aNormal.xy);
+#else
+    vec3 position = aPos;
+    vec3 normal = aNormal;
+#endif
+    FragPos = vec3(model * vec4(position, 1.0));
+    Normal = normalMatrix * normal;
+    TexCoord = aTexCoord;
+    gl_Position = modelViewProjection * vec4(position, 1.0);
+}
@@ -0,0 +1,359 @@
+#include "core/BlockCompressor.hpp"
+#include "core/ThreadPool.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+struct Block {
+    unsigned char rgba[16][4];
+};
+
+uint16_t to565(int r, int g, int b) {
+    return static_cast<uint16_t>(((r * 31 + 127) / 255) << 11 | ((g * 63 + 127) / 255) << 5 | ((b * 31 + 127) / 255));
+}
+
+void expand565(uint16_t color, int* rgb) {
+    int r = (color >> 11) & 31;
+    int g = (color >> 5) & 63;
+    int b = color & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+// Four-color palette: endpoints, then 2/3 and 1/3 of the way from color0 to color1
+void buildPalette(uint16_t c0, uint16_t c1, int palette[4][3]) {
+    expand565(c0, palette[0]);
+    expand565(c1, palette[1]);
+    for (int k = 0; k < 3; k++) {
+        palette[2][k] = (2 * palette[0][k] + palette[1][k]) / 3;
+        palette[3][k] = (palette[0][k] + 2 * palette[1][k]) / 3;
+    }
+}
+
+// Picks the nearest palette entry per pixel; returns the total squared error
+int chooseColorIndices(const Block& block, uint16_t c0, uint16_t c1, uint8_t* indices) {
+    int palette[4][3];
+    buildPalette(c0, c1, palette);
+    int total = 0;
+    for (int i = 0; i < 16; i++) {
+        int best = 0;
+        int bestError = 1 << 30;
+        for (int p = 0; p < 4; p++) {
+            int dr = block.rgba[i][0] - palette[p][0];
+            int dg = block.rgba[i][1] - palette[p][1];
+            int db = block.rgba[i][2] - palette[p][2];
+            int error = dr * dr + dg * dg + db * db;
+            if (error < bestError) {
+                bestError = error;
+                best = p;
+            }
+        }
+        indices[i] = static_cast<uint8_t>(best);
+        total += bestError;
+    }
+    return total;
+}
+
+// Least-squares endpoints for fixed indices; false if the system is degenerate
+bool refineEndpoints(const Block& block, const uint8_t* indices, uint16_t& c0, uint16_t& c1) {
+    static const float WEIGHTS[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float ax[3] = {0.0f, 0.0f, 0.0f};
+    float bx[3] = {0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < 16; i++) {
+        float alpha = WEIGHTS[indices[i]];
+        float beta = 1.0f - alpha;
+        aa += alpha * alpha;
+        ab += alpha * beta;
+        bb += beta * beta;
+        for (int k = 0; k < 3; k++) {
+            ax[k] += alpha * block.rgba[i][k];
+            bx[k] += beta * block.rgba[i][k];
+        }
+    }
+    float det = aa * bb - ab * ab;
+    if (det < 1e-6f) {
+        return false;
+    }
+
+    int end0[3], end1[3];
+    for (int k = 0; k < 3; k++) {
+        float a = (bb * ax[k] - ab * bx[k]) / det;
+        float b = (aa * bx[k] - ab * ax[k]) / det;
+        end0[k] = std::max(0, std::min(255, static_cast<int>(a + 0.5f)));
+        end1[k] = std::max(0, std::min(255, static_cast<int>(b + 0.5f)));
+    }
+    c0 = to565(end0[0], end0[1], end0[2]);
+    c1 = to565(end1[0], end1[1], end1[2]);
+    return true;
+}
+
+void encodeColorBlock(const Block& block, unsigned char* out) {
+    int minColor[3] = {255, 255, 255};
+    int maxColor[3] = {0, 0, 0};
+    int mean[3] = {0, 0, 0};
+    for (int i = 0; i < 16; i++) {
+        for (int k = 0; k < 3; k++) {
+            minColor[k] = std::min(minColor[k], static_cast<int>(block.rgba[i][k]));
+            maxColor[k] = std::max(maxColor[k], static_cast<int>(block.rgba[i][k]));
+            mean[k] += block.rgba[i][k];
+        }
+    }
+
+    // Orient red and blue along their covariance with green, so the endpoints span the right diagonal
+    int covRG = 0, covBG = 0;
+    for (int i = 0; i < 16; i++) {
+        int g = block.rgba[i][1] * 16 - mean[1];
+        covRG += (block.rgba[i][0] * 16 - mean[0]) * g;
+        covBG += (block.rgba[i][2] * 16 - mean[2]) * g;
+    }
+    for (int k = 0; k < 3; k++) {
+        int inset = (maxColor[k] - minColor[k]) >> 4;
+        minColor[k] += inset;
+        maxColor[k] -= inset;
+    }
+    if (covRG < 0) std::swap(minColor[0], maxColor[0]);
+    if (covBG < 0) std::swap(minColor[2], maxColor[2]);
+
+    uint16_t c0 = to565(maxColor[0], maxColor[1], maxColor[2]);
+    uint16_t c1 = to565(minColor[0], minColor[1], minColor[2]);
+    uint8_t indices[16];
+    int error = chooseColorIndices(block, c0, c1, indices);
+
+    uint16_t r0 = c0, r1 = c1;
+    uint8_t refined[16];
+    if (error > 0 && refineEndpoints(block, indices, r0, r1)) {
+        int refinedError = chooseColorIndices(block, r0, r1, refined);
+        if (refinedError < error) {
+            c0 = r0;
+            c1 = r1;
+            std::memcpy(indices, refined, sizeof(indices));
+        }
+    }
+
+    // color0 > color1 selects the four-color mode; equal endpoints must use index 0 only
+    if (c0 < c1) {
+        std::swap(c0, c1);
+        static const uint8_t SWAPPED[4] = {1, 0, 3, 2};
+        for (uint8_t& index : indices) index = SWAPPED[index];
+    } else if (c0 == c1) {
+        std::memset(indices, 0, sizeof(indices));
+    }
+
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; i++) {
+        bits |= static_cast<uint32_t>(indices[i]) << (2 * i);
+    }
+    out[0] = static_cast<unsigned char>(c0 & 0xFF);
+    out[1] = static_cast<unsigned char>(c0 >> 8);
+    out[2] = static_cast<unsigned char>(c1 & 0xFF);
+    out[3] = static_cast<unsigned char>(c1 >> 8);
+    std::memcpy(out + 4, &bits, 4);
+}
+
+void buildSingleChannelPalette(int a0, int a1, int palette[8]) {
+    palette[0] = a0;
+    palette[1] = a1;
+    if (a0 > a1) {
+        for (int i = 2; i < 8; i++) palette[i] = ((8 - i) * a0 + (i - 1) * a1 + 3) / 7;
+    } else {
+        for (int i = 2; i < 6; i++) palette[i] = ((6 - i) * a0 + (i - 1) * a1 + 2) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+void encodeSingleChannelBlock(const Block& block, int channel, unsigned char* out) {
+    int minValue = 255, maxValue = 0;
+    for (int i = 0; i < 16; i++) {
+        minValue = std::min(minValue, static_cast<int>(block.rgba[i][channel]));
+        maxValue = std::max(maxValue, static_cast<int>(block.rgba[i][channel]));
+    }
+
+    uint64_t bits = 0;
+    if (maxValue > minValue) {
+        int palette[8];
+        buildSingleChannelPalette(maxValue, minValue, palette);
+        for (int i = 0; i < 16; i++) {
+            int value = block.rgba[i][channel];
+            int best = 0;
+            int bestError = 1 << 30;
+            for (int p = 0; p < 8; p++) {
+                int error = std::abs(value - palette[p]);
+                if (error < bestError) {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            bits |= static_cast<uint64_t>(best) << (3 * i);
+        }
+    }
+    out[0] = static_cast<unsigned char>(maxValue);
+    out[1] = static_cast<unsigned char>(minValue);
+    for (int i = 0; i < 6; i++) {
+        out[2 + i] = static_cast<unsigned char>(bits >> (8 * i));
+    }
+}
+
+void decodeColorBlock(const unsigned char* in, bool forceFourColor, unsigned char pixels[16][4]) {
+    uint16_t c0 = static_cast<uint16_t>(in[0] | in[1] << 8);
+    uint16_t c1 = static_cast<uint16_t>(in[2] | in[3] << 8);
+    int palette[4][3];
+    buildPalette(c0, c1, palette);
+    if (c0 <= c1 && !forceFourColor) {
+        for (int k = 0; k < 3; k++) {
+            palette[2][k] = (palette[0][k] + palette[1][k]) / 2;
+            palette[3][k] = 0;
+        }
+    }
+    uint32_t bits;
+    std::memcpy(&bits, in + 4, 4);
+    for (int i = 0; i < 16; i++) {
+        int index = (bits >> (2 * i)) & 3;
+        for (int k = 0; k < 3; k++) pixels[i][k] = static_cast<unsigned char>(palette[index][k]);
+    }
+}
+
+void decodeSingleChannelBlock(const unsigned char* in, int channel, unsigned char pixels[16][4]) {
+    int palette[8];
+    buildSingleChannelPalette(in[0], in[1], palette);
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; i++) {
+        bits |= static_cast<uint64_t>(in[2 + i]) << (8 * i);
+    }
+    for (int i = 0; i < 16; i++) {
+        pixels[i][channel] = static_cast<unsigned char>(palette[(bits >> (3 * i)) & 7]);
+    }
+}
+
+void loadBlock(const ImageLevel& level, int channels, int blockX, int blockY, Block& block) {
+    for (int y = 0; y < 4; y++) {
+        int sy = std::min(blockY * 4 + y, level.height - 1);
+        for (int x = 0; x < 4; x++) {
+            int sx = std::min(blockX * 4 + x, level.width - 1);
+            const unsigned char* pixel = level.pixels + (static_cast<size_t>(sy) * level.width + sx) * channels;
+            unsigned char* texel = block.rgba[y * 4 + x];
+            texel[0] = pixel[0];
+            texel[1] = channels > 1 ? pixel[1] : 0;
+            texel[2] = channels > 2 ? pixel[2] : 0;
+            texel[3] = channels > 3 ? pixel[3] : 255;
+        }
+    }
+}
+
+void encodeBlock(const Block& block, BlockFormat format, unsigned char* out) {
+    switch (format) {
+    case BlockFormat::BC1:
+        encodeColorBlock(block, out);
+        break;
+    case BlockFormat::BC3:
+        encodeSingleChannelBlock(block, 3, out);
+        encodeColorBlock(block, out + 8);
+        break;
+    case BlockFormat::BC4:
+        encodeSingleChannelBlock(block, 0, out);
+        break;
+    case BlockFormat::BC5:
+        encodeSingleChannelBlock(block, 0, out);
+        encodeSingleChannelBlock(block, 1, out + 8);
+        break;
+    }
+}
+
+} // namespace
+
+BlockFormat BlockCompressor::chooseFormat(int channels, bool hasAlpha) {
+    if (channels == 1) return BlockFormat::BC4;
+    if (channels == 2) return BlockFormat::BC5;
+    return hasAlpha ? BlockFormat::BC3 : BlockFormat::BC1;
+}
+
+size_t BlockCompressor::getBlockBytes(BlockFormat format) {
+    return format == BlockFormat::BC1 || format == BlockFormat::BC4 ? 8 : 16;
+}
+
+size_t BlockCompressor::getCompressedSize(BlockFormat format, int width, int height) {
+    size_t blocksX = static_cast<size_t>((width + 3) / 4);
+    size_t blocksY = static_cast<size_t>((height + 3) / 4);
+    return blocksX * blocksY * getBlockBytes(format);
+}
+
+void BlockCompressor::compress(const std::vector<ImageLevel>& levels, int channels, BlockFormat format,
+                               std::vector<std::vector<unsigned char>>& out, ThreadPool* pool) {
+    // One task per band of block rows, across all levels, so small levels share the pool too
+    struct Band {
+        size_t level;
+        int firstRow;
+    };
+    std::vector<Band> bands;
+    out.assign(levels.size(), std::vector<unsigned char>());
+    for (size_t level = 0; level < levels.size(); level++) {
+        out[level].resize(getCompressedSize(format, levels[level].width, levels[level].height));
+        int blockRows = (levels[level].height + 3) / 4;
+        for (int row = 0; row < blockRows; row += BAND_BLOCK_ROWS) {
+            bands.push_back({level, row});
+        }
+    }
+
+    size_t blockBytes = getBlockBytes(format);
+    auto runBand = [&](size_t index) {
+        const Band& band = bands[index];
+        const ImageLevel& level = levels[band.level];
+        int blocksX = (level.width + 3) / 4;
+        int lastRow = std::min(band.firstRow + BAND_BLOCK_ROWS, (level.height + 3) / 4);
+        Block block;
+        for (int by = band.firstRow; by < lastRow; by++) {
+            for (int bx = 0; bx < blocksX; bx++) {
+                loadBlock(level, channels, bx, by, block);
+                encodeBlock(block, format, out[band.level].data() + (static_cast<size_t>(by) * blocksX + bx) * blockBytes);
+            }
+        }
+    };
+
+    if (pool) {
+        pool->parallelFor(bands.size(), runBand);
+    } else {
+        for (size_t i = 0; i < bands.size(); i++) runBand(i);
+    }
+}
+
+void BlockCompressor::decompress(const unsigned char* data, int width, int height, BlockFormat format,
+                                 std::vector<unsigned char>& out) {
+    out.assign(static_cast<size_t>(width) * height * 4, 0);
+    int blocksX = (width + 3) / 4;
+    int blocksY = (height + 3) / 4;
+    size_t blockBytes = getBlockBytes(format);
+
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            const unsigned char* in = data + (static_cast<size_t>(by) * blocksX + bx) * blockBytes;
+            unsigned char pixels[16][4] = {};
+            for (auto& pixel : pixels) pixel[3] = 255;
+            switch (format) {
+            case BlockFormat::BC1:
+                decodeColorBlock(in, false, pixels);
+                break;
+            case BlockFormat::BC3:
+                decodeSingleChannelBlock(in, 3, pixels);
+                decodeColorBlock(in + 8, true, pixels);
+                break;
+            case BlockFormat::BC4:
+                decodeSingleChannelBlock(in, 0, pixels);
+                break;
+            case BlockFormat::BC5:
+                decodeSingleChannelBlock(in, 0, pixels);
+                decodeSingleChannelBlock(in + 8, 1, pixels);
+                break;
+            }
+
+            for (int y = 0; y < 4 && by * 4 + y < height; y++) {
+                for (int x = 0; x < 4 && bx * 4 + x < width; x++) {
+                    std::memcpy(&out[(static_cast<size_t>(by * 4 + y) * width + bx * 4 + x) * 4], pixels[y * 4 + x], 4);
+                }
+            }
+        }
+    }
+}
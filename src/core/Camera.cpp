@@ -343,3 +343,14 @@ void Camera::rotatePitch(float angle) {
     calculateViewMatrix();
 }
 
+void Camera::getViewProjectionMatrix(float* matrix) const {
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; k++) {
+                sum += m_projectionMatrix[k * 4 + row] * m_viewMatrix[col * 4 + k];
+            }
+            matrix[col * 4 + row] = sum;
+        }
+    }
+}
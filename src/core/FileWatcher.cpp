@@ -0,0 +1,101 @@
+#include "core/FileWatcher.hpp"
+#include <algorithm>
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef __linux__
+// In-place writes end with IN_CLOSE_WRITE; editors that save through a temporary file end with IN_MOVED_TO
+const uint32_t WATCH_EVENTS = IN_CLOSE_WRITE | IN_MOVED_TO;
+#endif
+
+std::string getDirectory(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? "." : path.substr(0, slash);
+}
+
+} // namespace
+
+FileWatcher::FileWatcher() : m_inotify(-1) {
+#ifdef __linux__
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotify < 0) {
+        std::cerr << "inotify unavailable, polling watched files instead" << std::endl;
+    }
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+    if (m_inotify >= 0) {
+        close(m_inotify);
+    }
+#endif
+}
+
+bool FileWatcher::addFile(const std::string& filepath) {
+    FileStamp stamp = FileUtils::getStamp(filepath);
+    if (!stamp.valid) {
+        return false;
+    }
+    std::string path = FileUtils::canonicalPath(filepath);
+    m_files[path] = stamp;
+
+#ifdef __linux__
+    if (m_inotify >= 0) {
+        std::string directory = getDirectory(path);
+        int watch = inotify_add_watch(m_inotify, directory.c_str(), WATCH_EVENTS);
+        if (watch < 0) {
+            std::cerr << "Failed to watch directory: " << directory << std::endl;
+        } else {
+            // Watching a directory twice returns the same descriptor
+            m_directories[watch] = directory;
+        }
+    }
+#endif
+    return true;
+}
+
+void FileWatcher::poll(std::vector<std::string>& changed) {
+#ifdef __linux__
+    if (m_inotify >= 0) {
+        alignas(inotify_event) char buffer[4096];
+        for (;;) {
+            ssize_t length = read(m_inotify, buffer, sizeof(buffer));
+            if (length <= 0) break;
+
+            for (ssize_t offset = 0; offset < length;) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+                auto directory = m_directories.find(event->wd);
+                if (directory == m_directories.end() || event->len == 0) continue;
+
+                std::string path = directory->second + "/" + event->name;
+                if (m_files.count(path) > 0) {
+                    addChanged(path, changed);
+                }
+            }
+        }
+        return;
+    }
+#endif
+
+    for (auto& file : m_files) {
+        FileStamp stamp = FileUtils::getStamp(file.first);
+        if (stamp.valid && stamp != file.second) {
+            addChanged(file.first, changed);
+        }
+    }
+}
+
+void FileWatcher::addChanged(const std::string& path, std::vector<std::string>& changed) {
+    m_files[path] = FileUtils::getStamp(path);
+    if (std::find(changed.begin(), changed.end(), path) == changed.end()) {
+        changed.push_back(path);
+    }
+}
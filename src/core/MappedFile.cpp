@@ -0,0 +1,113 @@
+#include "core/MappedFile.hpp"
+#include <fstream>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : m_data(nullptr), m_size(0), m_open(false), m_mapped(false) {
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(other.m_data), m_size(other.m_size), m_open(other.m_open),
+      m_mapped(other.m_mapped), m_buffer(std::move(other.m_buffer)) {
+    if (!m_mapped && !m_buffer.empty()) {
+        m_data = m_buffer.data();
+    }
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_open = false;
+    other.m_mapped = false;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_data = other.m_data;
+        m_size = other.m_size;
+        m_open = other.m_open;
+        m_mapped = other.m_mapped;
+        m_buffer = std::move(other.m_buffer);
+        if (!m_mapped && !m_buffer.empty()) {
+            m_data = m_buffer.data();
+        }
+        other.m_data = nullptr;
+        other.m_size = 0;
+        other.m_open = false;
+        other.m_mapped = false;
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& filepath) {
+    close();
+
+#ifndef _WIN32
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    m_size = static_cast<size_t>(st.st_size);
+    if (m_size == 0) {
+        ::close(fd);
+        m_open = true;
+        return true;
+    }
+
+    void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping != MAP_FAILED) {
+        madvise(mapping, m_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const char*>(mapping);
+        m_mapped = true;
+        m_open = true;
+        return true;
+    }
+#endif
+
+    // Fallback: read the whole file into memory
+    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        m_size = 0;
+        return false;
+    }
+    m_size = static_cast<size_t>(file.tellg());
+    file.seekg(0);
+    m_buffer.resize(m_size);
+    if (m_size > 0 && !file.read(m_buffer.data(), m_size)) {
+        m_buffer.clear();
+        m_size = 0;
+        return false;
+    }
+    m_data = m_buffer.empty() ? nullptr : m_buffer.data();
+    m_open = true;
+    return true;
+}
+
+void MappedFile::close() {
+#ifndef _WIN32
+    if (m_mapped && m_data) {
+        munmap(const_cast<char*>(m_data), m_size);
+    }
+#endif
+    m_buffer.clear();
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+    m_mapped = false;
+}
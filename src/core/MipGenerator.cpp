@@ -0,0 +1,151 @@
+#include "core/MipGenerator.hpp"
+#include "core/ThreadPool.hpp"
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MIPGENERATOR_SSE2 1
+#endif
+
+namespace {
+
+// Averages destination bytes [begin, end) of one row from source rows r0 and r1
+void downsampleRowScalar(const unsigned char* r0, const unsigned char* r1, int srcWidth, int channels,
+                         unsigned char* dst, int begin, int end) {
+    for (int i = begin; i < end; i++) {
+        int x = i / channels;
+        int k = i % channels;
+        int x0 = 2 * x;
+        int x1 = std::min(x0 + 1, srcWidth - 1);
+        int sum = r0[x0 * channels + k] + r0[x1 * channels + k] + r1[x0 * channels + k] + r1[x1 * channels + k];
+        dst[i] = static_cast<unsigned char>((sum + 2) >> 2);
+    }
+}
+
+#ifdef MIPGENERATOR_SSE2
+
+// Sums horizontally adjacent pixels of 8 vertical sums; the result is in the low 4 lanes
+template <int Channels>
+__m128i sumPixelPairs(__m128i v);
+
+template <>
+__m128i sumPixelPairs<4>(__m128i v) {
+    return _mm_add_epi16(v, _mm_srli_si128(v, 8));
+}
+
+template <>
+__m128i sumPixelPairs<2>(__m128i v) {
+    __m128i t = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 1, 2, 0));
+    return _mm_add_epi16(t, _mm_srli_si128(t, 8));
+}
+
+template <>
+__m128i sumPixelPairs<1>(__m128i v) {
+    __m128i t = _mm_madd_epi16(v, _mm_set1_epi16(1));
+    return _mm_packs_epi32(t, t);
+}
+
+// Produces 16 destination bytes per iteration from 32 bytes of each source row;
+// returns the number of destination bytes written
+template <int Channels>
+int downsampleRowSse2(const unsigned char* r0, const unsigned char* r1, unsigned char* dst, int rowBytes) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two = _mm_set1_epi16(2);
+    int i = 0;
+    for (; i + 16 <= rowBytes; i += 16) {
+        __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r0 + 2 * i));
+        __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r0 + 2 * i + 16));
+        __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r1 + 2 * i));
+        __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r1 + 2 * i + 16));
+
+        __m128i s0 = sumPixelPairs<Channels>(_mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero)));
+        __m128i s1 = sumPixelPairs<Channels>(_mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero)));
+        __m128i s2 = sumPixelPairs<Channels>(_mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero)));
+        __m128i s3 = sumPixelPairs<Channels>(_mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero)));
+
+        __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(s0, s1), two), 2);
+        __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(s2, s3), two), 2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    return i;
+}
+
+#endif
+
+void downsampleRow(const unsigned char* r0, const unsigned char* r1, int srcWidth, int channels,
+                   unsigned char* dst, int dstWidth, bool useSimd) {
+    int rowBytes = dstWidth * channels;
+    int done = 0;
+#ifdef MIPGENERATOR_SSE2
+    // With a source width of 1 the horizontal pair is the texel itself, which only the scalar path handles
+    if (useSimd && srcWidth > 1) {
+        if (channels == 4) {
+            done = downsampleRowSse2<4>(r0, r1, dst, rowBytes);
+        } else if (channels == 2) {
+            done = downsampleRowSse2<2>(r0, r1, dst, rowBytes);
+        } else if (channels == 1) {
+            done = downsampleRowSse2<1>(r0, r1, dst, rowBytes);
+        }
+    }
+#else
+    (void)useSimd;
+#endif
+    downsampleRowScalar(r0, r1, srcWidth, channels, dst, done, rowBytes);
+}
+
+} // namespace
+
+int MipGenerator::getLevelCount(int width, int height) {
+    int size = std::max(width, height);
+    int levels = 1;
+    while (size > 1) {
+        size /= 2;
+        levels++;
+    }
+    return levels;
+}
+
+void MipGenerator::downsample(const unsigned char* src, int width, int height, int channels,
+                              unsigned char* dst, ThreadPool* pool, bool useSimd) {
+    int dstWidth = std::max(1, width / 2);
+    int dstHeight = std::max(1, height / 2);
+    size_t srcStride = static_cast<size_t>(width) * channels;
+    size_t dstStride = static_cast<size_t>(dstWidth) * channels;
+
+    auto runBand = [&](size_t band) {
+        int firstRow = static_cast<int>(band) * BAND_ROWS;
+        int lastRow = std::min(firstRow + BAND_ROWS, dstHeight);
+        for (int y = firstRow; y < lastRow; y++) {
+            const unsigned char* r0 = src + static_cast<size_t>(2 * y) * srcStride;
+            const unsigned char* r1 = src + static_cast<size_t>(std::min(2 * y + 1, height - 1)) * srcStride;
+            downsampleRow(r0, r1, width, channels, dst + static_cast<size_t>(y) * dstStride, dstWidth, useSimd);
+        }
+    };
+
+    size_t bandCount = static_cast<size_t>((dstHeight + BAND_ROWS - 1) / BAND_ROWS);
+    if (pool && bandCount > 1) {
+        pool->parallelFor(bandCount, runBand);
+    } else {
+        for (size_t band = 0; band < bandCount; band++) {
+            runBand(band);
+        }
+    }
+}
+
+void MipGenerator::generate(const unsigned char* base, int width, int height, int channels,
+                            std::vector<std::vector<unsigned char>>& levels, ThreadPool* pool, bool useSimd) {
+    int levelCount = getLevelCount(width, height);
+    levels.assign(levelCount - 1, std::vector<unsigned char>());
+
+    const unsigned char* src = base;
+    for (int level = 1; level < levelCount; level++) {
+        int dstWidth = std::max(1, width / 2);
+        int dstHeight = std::max(1, height / 2);
+        levels[level - 1].resize(static_cast<size_t>(dstWidth) * dstHeight * channels);
+        downsample(src, width, height, channels, levels[level - 1].data(), pool, useSimd);
+
+        src = levels[level - 1].data();
+        width = dstWidth;
+        height = dstHeight;
+    }
+}
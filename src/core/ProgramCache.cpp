@@ -0,0 +1,149 @@
+#include "core/ProgramCache.hpp"
+#include "core/FileUtils.hpp"
+#include "core/MappedFile.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+const char MAGIC[8] = {'I', 'A', 'O', 'P', 'R', 'O', 'G', '\0'};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t key;
+    uint32_t binaryFormat;
+    uint32_t binaryBytes;
+    uint64_t binaryHash;
+};
+
+std::atomic<bool> g_enabled{true};
+std::string g_directory = ".shadercache";
+
+uint64_t hashString(const char* text, uint64_t seed) {
+    // The length goes in too, so adjacent strings cannot trade characters
+    size_t length = text ? std::strlen(text) : 0;
+    seed = FileUtils::hashBytes(&length, sizeof(length), seed);
+    return FileUtils::hashBytes(text, length, seed);
+}
+
+} // namespace
+
+uint64_t ProgramCache::computeKey(const std::string& vertexSource, const std::string& fragmentSource) {
+    uint64_t key = FileUtils::hashBytes(&VERSION, sizeof(VERSION));
+    key = hashString(reinterpret_cast<const char*>(glGetString(GL_VENDOR)), key);
+    key = hashString(reinterpret_cast<const char*>(glGetString(GL_RENDERER)), key);
+    key = hashString(reinterpret_cast<const char*>(glGetString(GL_VERSION)), key);
+    key = hashString(vertexSource.c_str(), key);
+    return hashString(fragmentSource.c_str(), key);
+}
+
+bool ProgramCache::load(GLuint program, uint64_t key) {
+    if (!isEnabled() || !isSupported()) {
+        return false;
+    }
+
+    MappedFile file;
+    if (!file.open(getCachePath(key)) || file.size() < sizeof(Header)) {
+        return false;
+    }
+    Header header;
+    std::memcpy(&header, file.data(), sizeof(Header));
+    const char* binary = file.data() + sizeof(Header);
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.headerSize != sizeof(Header) || header.key != key ||
+        file.size() - sizeof(Header) != header.binaryBytes ||
+        FileUtils::hashBytes(binary, header.binaryBytes) != header.binaryHash) {
+        return false;
+    }
+
+    // A format the driver no longer lists would raise GL_INVALID_ENUM; a binary it rejects fails the link
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    std::vector<GLint> formats(static_cast<size_t>(std::max(formatCount, 0)));
+    if (!formats.empty()) {
+        glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+    }
+    if (std::find(formats.begin(), formats.end(), static_cast<GLint>(header.binaryFormat)) == formats.end()) {
+        return false;
+    }
+    glProgramBinary(program, header.binaryFormat, binary, static_cast<GLsizei>(header.binaryBytes));
+    GLint success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    return success == GL_TRUE;
+}
+
+bool ProgramCache::store(GLuint program, uint64_t key) {
+    if (!isEnabled() || !isSupported()) {
+        return false;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return false;
+    }
+    std::vector<char> file(sizeof(Header) + static_cast<size_t>(length));
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &written, &format, file.data() + sizeof(Header));
+    if (written <= 0) {
+        return false;
+    }
+    file.resize(sizeof(Header) + static_cast<size_t>(written));
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.headerSize = sizeof(Header);
+    header.key = key;
+    header.binaryFormat = format;
+    header.binaryBytes = static_cast<uint32_t>(written);
+    header.binaryHash = FileUtils::hashBytes(file.data() + sizeof(Header), header.binaryBytes);
+    std::memcpy(file.data(), &header, sizeof(Header));
+
+    std::error_code error;
+    std::filesystem::create_directories(getDirectory(), error);
+    if (error || !FileUtils::writeAtomic(getCachePath(key), file.data(), file.size())) {
+        std::cerr << "Failed to write shader program cache: " << getCachePath(key) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::string ProgramCache::getCachePath(uint64_t key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.glprog", static_cast<unsigned long long>(key));
+    return getDirectory() + "/" + name;
+}
+
+bool ProgramCache::isSupported() {
+    if (!GLEW_ARB_get_program_binary) {
+        return false;
+    }
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    return formatCount > 0;
+}
+
+void ProgramCache::setEnabled(bool enabled) {
+    g_enabled = enabled;
+}
+
+bool ProgramCache::isEnabled() {
+    return g_enabled;
+}
+
+void ProgramCache::setDirectory(const std::string& directory) {
+    g_directory = directory;
+}
+
+const std::string& ProgramCache::getDirectory() {
+    return g_directory;
+}
@@ -1,12 +1,50 @@
 #include "core/Shader.hpp"
+#include "core/ProgramCache.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
-Shader::Shader() : m_programID(0) {
+namespace {
+
+// Lets the driver use as many compiler threads as it likes
+const GLuint MAX_COMPILER_THREADS = 0xFFFFFFFFu;
+
+bool g_parallelCompileEnabled = false;
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+GLuint createShader(GLenum type, const std::string& source) {
+    GLuint shader = glCreateShader(type);
+    const char* src = source.c_str();
+    glShaderSource(shader, 1, &src, nullptr);
+    glCompileShader(shader);
+    return shader;
+}
+
+bool checkCompileStatus(GLuint shader) {
+    GLint success = GL_TRUE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Shader compilation error: " << infoLog << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+Shader::Shader() : m_programID(0), m_pendingProgram(0), m_pendingShaders{0, 0} {
 }
 
 Shader::~Shader() {
+    cancelLoad();
     if (m_programID != 0) {
         glDeleteProgram(m_programID);
     }
@@ -24,17 +62,8 @@ std::string Shader::readFile(const std::string& filepath) {
 }
 
 GLuint Shader::compileShader(GLenum type, const std::string& source) {
-    GLuint shader = glCreateShader(type);
-    const char* src = source.c_str();
-    glShaderSource(shader, 1, &src, nullptr);
-    glCompileShader(shader);
-
-    GLint success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
-        std::cerr << "Shader compilation error: " << infoLog << std::endl;
+    GLuint shader = createShader(type, source);
+    if (!checkCompileStatus(shader)) {
         glDeleteShader(shader);
         return 0;
     }
@@ -45,6 +74,9 @@ bool Shader::linkProgram(GLuint vertexShader, GLuint fragmentShader) {
     m_programID = glCreateProgram();
     glAttachShader(m_programID, vertexShader);
     glAttachShader(m_programID, fragmentShader);
+    if (ProgramCache::isEnabled() && ProgramCache::isSupported()) {
+        glProgramParameteri(m_programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glLinkProgram(m_programID);
 
     GLint success;
@@ -60,9 +92,66 @@ bool Shader::linkProgram(GLuint vertexShader, GLuint fragmentShader) {
 
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
+    reflectUniforms();
     return true;
 }
 
+void Shader::reflectUniforms() {
+    m_uniforms.clear();
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(m_programID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(m_programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    
+    std::vector<char> buffer(std::max(maxLength, 1));
+    for (GLint i = 0; i < count; i++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(m_programID, static_cast<GLuint>(i), static_cast<GLsizei>(buffer.size()), &length, &size,
+                           &type, buffer.data());
+        std::string name(buffer.data(), length);
+        GLint location = glGetUniformLocation(m_programID, name.c_str());
+        m_stats.locationQueries++;
+        if (location < 0) continue;   // Members of uniform blocks have no location
+        
+        // Arrays are reported as "name[0]"; "name" also addresses the first element, and
+        // every further element gets its own entry since their locations need not be consecutive
+        m_uniforms.push_back({UniformName::fnv1a(name.c_str()), location, name});
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0) {
+            std::string base = name.substr(0, name.size() - 3);
+            m_uniforms.push_back({UniformName::fnv1a(base.c_str()), location, base});
+            for (GLint element = 1; element < size; element++) {
+                std::string elementName = base + "[" + std::to_string(element) + "]";
+                GLint elementLocation = glGetUniformLocation(m_programID, elementName.c_str());
+                m_stats.locationQueries++;
+                if (elementLocation >= 0) {
+                    m_uniforms.push_back({UniformName::fnv1a(elementName.c_str()), elementLocation, elementName});
+                }
+            }
+        }
+    }
+    
+    std::sort(m_uniforms.begin(), m_uniforms.end(), [](const UniformEntry& a, const UniformEntry& b) {
+        return a.hash < b.hash;
+    });
+}
+
+GLint Shader::getUniformLocation(UniformName name) const {
+    m_stats.lookups++;
+    auto it = std::lower_bound(m_uniforms.begin(), m_uniforms.end(), name.hash,
+                               [](const UniformEntry& entry, uint32_t hash) { return entry.hash < hash; });
+    
+    // Colliding hashes sit next to each other; the name decides
+    for (; it != m_uniforms.end() && it->hash == name.hash; ++it) {
+        if (std::strcmp(it->name.c_str(), name.text) == 0) {
+            return it->location;
+        }
+    }
+    m_stats.unknownNames++;
+    return -1;
+}
+
 bool Shader::loadFromFiles(const std::string& vertexPath, const std::string& fragmentPath) {
     std::string vertexSource = readFile(vertexPath);
     std::string fragmentSource = readFile(fragmentPath);
@@ -71,10 +160,139 @@ bool Shader::loadFromFiles(const std::string& vertexPath, const std::string& fra
         return false;
     }
     
+    m_vertexPath = vertexPath;
+    m_fragmentPath = fragmentPath;
     return loadFromSource(vertexSource, fragmentSource);
 }
 
+bool Shader::reloadFromFiles() {
+    if (m_vertexPath.empty() || m_fragmentPath.empty()) {
+        return false;
+    }
+    std::string vertexSource = readFile(m_vertexPath);
+    std::string fragmentSource = readFile(m_fragmentPath);
+    if (vertexSource.empty() || fragmentSource.empty()) {
+        return false;
+    }
+    
+    beginLoadFromSource(vertexSource, fragmentSource);
+    return true;
+}
+
+void Shader::beginLoadFromSource(const std::string& vertexSource, const std::string& fragmentSource) {
+    cancelLoad();
+    if (isParallelCompileSupported() && !g_parallelCompileEnabled) {
+        if (GLEW_KHR_parallel_shader_compile) {
+            glMaxShaderCompilerThreadsKHR(MAX_COMPILER_THREADS);
+        } else {
+            glMaxShaderCompilerThreadsARB(MAX_COMPILER_THREADS);
+        }
+        g_parallelCompileEnabled = true;
+    }
+    
+    m_pendingProgram = glCreateProgram();
+    if (ProgramCache::isEnabled() && ProgramCache::isSupported() &&
+        ProgramCache::load(m_pendingProgram, ProgramCache::computeKey(vertexSource, fragmentSource))) {
+        return;
+    }
+    
+    // No status is queried here: the calls return before the driver has finished
+    m_pendingShaders[0] = createShader(GL_VERTEX_SHADER, vertexSource);
+    m_pendingShaders[1] = createShader(GL_FRAGMENT_SHADER, fragmentSource);
+    glAttachShader(m_pendingProgram, m_pendingShaders[0]);
+    glAttachShader(m_pendingProgram, m_pendingShaders[1]);
+    glLinkProgram(m_pendingProgram);
+}
+
+CompileStatus Shader::pollLoad() {
+    if (m_pendingProgram == 0) {
+        return CompileStatus::Idle;
+    }
+    if (isParallelCompileSupported()) {
+        GLint complete = GL_FALSE;
+        glGetProgramiv(m_pendingProgram, GL_COMPLETION_STATUS_KHR, &complete);
+        if (!complete) {
+            return CompileStatus::Compiling;
+        }
+    }
+    
+    GLint success = GL_FALSE;
+    glGetProgramiv(m_pendingProgram, GL_LINK_STATUS, &success);
+    if (!success) {
+        for (GLuint shader : m_pendingShaders) {
+            if (shader != 0) {
+                checkCompileStatus(shader);
+            }
+        }
+        char infoLog[512];
+        glGetProgramInfoLog(m_pendingProgram, 512, nullptr, infoLog);
+        std::cerr << "Shader linking error: " << infoLog << std::endl;
+        cancelLoad();
+        return CompileStatus::Failed;
+    }
+    
+    // Not stored in the ProgramCache: a file being edited would leave an entry behind for every save
+    for (GLuint& shader : m_pendingShaders) {
+        if (shader != 0) {
+            glDetachShader(m_pendingProgram, shader);
+            glDeleteShader(shader);
+            shader = 0;
+        }
+    }
+    
+    // The callback runs against the new program, so the old one is kept until it succeeds
+    GLuint previous = m_programID;
+    m_programID = m_pendingProgram;
+    m_pendingProgram = 0;
+    reflectUniforms();
+    if (m_onLink && !m_onLink(*this)) {
+        std::cerr << "Reloaded shader " << m_fragmentPath << " failed its setup, keeping the previous program"
+                  << std::endl;
+        glDeleteProgram(m_programID);
+        m_programID = previous;
+        reflectUniforms();
+        return CompileStatus::Failed;
+    }
+    // Deleting the program still in use is deferred by GL until another one is made current
+    if (previous != 0) {
+        glDeleteProgram(previous);
+    }
+    return CompileStatus::Linked;
+}
+
+void Shader::cancelLoad() {
+    for (GLuint& shader : m_pendingShaders) {
+        if (shader != 0) {
+            glDeleteShader(shader);
+            shader = 0;
+        }
+    }
+    if (m_pendingProgram != 0) {
+        glDeleteProgram(m_pendingProgram);
+        m_pendingProgram = 0;
+    }
+}
+
+bool Shader::isParallelCompileSupported() {
+    return GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
+}
+
 bool Shader::loadFromSource(const std::string& vertexSource, const std::string& fragmentSource) {
+    auto start = std::chrono::steady_clock::now();
+    bool cached = ProgramCache::isEnabled() && ProgramCache::isSupported();
+    uint64_t key = cached ? ProgramCache::computeKey(vertexSource, fragmentSource) : 0;
+    if (cached) {
+        m_programID = glCreateProgram();
+        if (ProgramCache::load(m_programID, key)) {
+            reflectUniforms();
+            std::cout << "Loaded shader program from cache in " << elapsedMs(start) << " ms" << std::endl;
+            return !m_onLink || m_onLink(*this);
+        }
+        // Missing, stale or rejected by the driver: compile from source
+        glDeleteProgram(m_programID);
+        m_programID = 0;
+    }
+    
     GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
     if (vertexShader == 0) return false;
 
@@ -84,30 +302,67 @@ bool Shader::loadFromSource(const std::string& vertexSource, const std::string&
         return false;
     }
 
-    return linkProgram(vertexShader, fragmentShader);
+    if (!linkProgram(vertexShader, fragmentShader)) {
+        return false;
+    }
+    bool stored = cached && ProgramCache::store(m_programID, key);
+    std::cout << "Compiled shader program in " << elapsedMs(start) << " ms"
+              << (stored ? " (cached for the next start)" : "") << std::endl;
+    return !m_onLink || m_onLink(*this);
 }
 
 void Shader::use() const {
     glUseProgram(m_programID);
 }
 
-void Shader::setBool(const std::string& name, bool value) const {
-    glUniform1i(glGetUniformLocation(m_programID, name.c_str()), (int)value);
+void Shader::setBool(UniformName name, bool value) const {
+    GLint location = getUniformLocation(name);
+    if (location < 0) return;
+    glUniform1i(location, (int)value);
+    m_stats.uniformCalls++;
 }
 
-void Shader::setInt(const std::string& name, int value) const {
-    glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
+void Shader::setInt(UniformName name, int value) const {
+    GLint location = getUniformLocation(name);
+    if (location < 0) return;
+    glUniform1i(location, value);
+    m_stats.uniformCalls++;
 }
 
-void Shader::setFloat(const std::string& name, float value) const {
-    glUniform1f(glGetUniformLocation(m_programID, name.c_str()), value);
+void Shader::setFloat(UniformName name, float value) const {
+    GLint location = getUniformLocation(name);
+    if (location < 0) return;
+    glUniform1f(location, value);
+    m_stats.uniformCalls++;
 }
 
-void Shader::setMat4(const std::string& name, const float* matrix) const {
-    glUniformMatrix4fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, matrix);
+void Shader::setMat4(UniformName name, const float* matrix) const {
+    GLint location = getUniformLocation(name);
+    if (location < 0) return;
+    glUniformMatrix4fv(location, 1, GL_FALSE, matrix);
+    m_stats.uniformCalls++;
 }
 
-void Shader::setVec3(const std::string& name, float x, float y, float z) const {
-    glUniform3f(glGetUniformLocation(m_programID, name.c_str()), x, y, z);
+void Shader::setVec3(UniformName name, float x, float y, float z) const {
+    GLint location = getUniformLocation(name);
+    if (location < 0) return;
+    glUniform3f(location, x, y, z);
+    m_stats.uniformCalls++;
 }
 
+void Shader::setVec4(UniformName name, float x, float y, float z, float w) const {
+    GLint location = getUniformLocation(name);
+    if (location < 0) return;
+    glUniform4f(location, x, y, z, w);
+    m_stats.uniformCalls++;
+}
+
+bool Shader::bindUniformBlock(const char* name, GLuint binding) const {
+    GLuint index = glGetUniformBlockIndex(m_programID, name);
+    if (index == GL_INVALID_INDEX) {
+        std::cerr << "Shader has no uniform block " << name << std::endl;
+        return false;
+    }
+    glUniformBlockBinding(m_programID, index, binding);
+    return true;
+}
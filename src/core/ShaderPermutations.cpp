@@ -0,0 +1,137 @@
+#include "core/ShaderPermutations.hpp"
+#include <iostream>
+
+ShaderPermutations::ShaderPermutations() {
+}
+
+void ShaderPermutations::setSource(const std::string& vertexSource, const std::string& fragmentSource,
+                                   const std::vector<std::string>& features) {
+    cleanup();
+    m_vertexSource = vertexSource;
+    m_fragmentSource = fragmentSource;
+    m_vertexPath.clear();
+    m_fragmentPath.clear();
+    m_features = features;
+}
+
+bool ShaderPermutations::setSourceFiles(const std::string& vertexPath, const std::string& fragmentPath,
+                                        const std::vector<std::string>& features) {
+    std::string vertexSource = Shader::readFile(vertexPath);
+    std::string fragmentSource = Shader::readFile(fragmentPath);
+    if (vertexSource.empty() || fragmentSource.empty()) {
+        return false;
+    }
+    setSource(vertexSource, fragmentSource, features);
+    m_vertexPath = vertexPath;
+    m_fragmentPath = fragmentPath;
+    return true;
+}
+
+bool ShaderPermutations::reloadFromFiles() {
+    if (m_vertexPath.empty() || m_fragmentPath.empty()) {
+        return false;
+    }
+    std::string vertexSource = Shader::readFile(m_vertexPath);
+    std::string fragmentSource = Shader::readFile(m_fragmentPath);
+    if (vertexSource.empty() || fragmentSource.empty()) {
+        return false;
+    }
+    
+    m_vertexSource = vertexSource;
+    m_fragmentSource = fragmentSource;
+    for (auto& entry : m_variants) {
+        entry.second->beginLoadFromSource(addDefines(m_vertexSource, m_features, entry.first, m_prelude),
+                                          addDefines(m_fragmentSource, m_features, entry.first, m_prelude));
+    }
+    return true;
+}
+
+size_t ShaderPermutations::update() {
+    size_t swapped = 0;
+    for (auto& entry : m_variants) {
+        Shader& shader = *entry.second;
+        if (!shader.isLoading()) continue;
+        
+        CompileStatus status = shader.pollLoad();
+        if (status == CompileStatus::Linked) {
+            swapped++;
+        } else if (status == CompileStatus::Failed) {
+            std::cerr << "Failed to reload shader variant 0x" << std::hex << entry.first << std::dec
+                      << ", keeping the previous program" << std::endl;
+        }
+    }
+    return swapped;
+}
+
+void ShaderPermutations::setLinkCallback(LinkCallback callback) {
+    m_onLink = std::move(callback);
+    for (auto& entry : m_variants) {
+        entry.second->setLinkCallback(m_onLink);
+    }
+}
+
+bool ShaderPermutations::isReloading() const {
+    for (const auto& entry : m_variants) {
+        if (entry.second->isLoading()) return true;
+    }
+    return false;
+}
+
+const Shader* ShaderPermutations::get(uint32_t mask) {
+    auto it = m_variants.find(mask);
+    if (it == m_variants.end()) {
+        auto shader = std::make_unique<Shader>();
+        shader->setLinkCallback(m_onLink);
+        if (!shader->loadFromSource(addDefines(m_vertexSource, m_features, mask, m_prelude),
+                                    addDefines(m_fragmentSource, m_features, mask, m_prelude))) {
+            std::cerr << "Failed to build shader variant 0x" << std::hex << mask << std::dec << std::endl;
+        }
+        it = m_variants.emplace(mask, std::move(shader)).first;
+    }
+    return it->second->getID() != 0 ? it->second.get() : nullptr;
+}
+
+std::string ShaderPermutations::addDefines(const std::string& source, const std::vector<std::string>& features,
+                                           uint32_t mask, const std::string& prelude) {
+    std::string defines = prelude;
+    for (size_t i = 0; i < features.size() && i < 32; i++) {
+        if (mask & (1u << i)) {
+            defines += "#define " + features[i] + "\n";
+        }
+    }
+
+    // #version must stay the first statement, so the defines go right after it
+    size_t insertAt = 0;
+    size_t version = source.find("#version");
+    if (version != std::string::npos) {
+        size_t lineEnd = source.find('\n', version);
+        insertAt = lineEnd == std::string::npos ? source.size() : lineEnd + 1;
+    }
+    std::string result = source.substr(0, insertAt);
+    if (!result.empty() && result.back() != '\n') {
+        result += '\n';
+    }
+    return result + defines + source.substr(insertAt);
+}
+
+UniformStats ShaderPermutations::getStats() const {
+    UniformStats total;
+    for (const auto& entry : m_variants) {
+        const UniformStats& stats = entry.second->getStats();
+        total.uniformCalls += stats.uniformCalls;
+        total.lookups += stats.lookups;
+        total.unknownNames += stats.unknownNames;
+        total.locationQueries += stats.locationQueries;
+    }
+    return total;
+}
+
+void ShaderPermutations::resetStats() const {
+    for (const auto& entry : m_variants) {
+        entry.second->resetStats();
+    }
+}
+
+void ShaderPermutations::cleanup() {
+    m_variants.clear();
+}
@@ -0,0 +1,82 @@
+#include "core/ShaderReloader.hpp"
+#include "core/FileUtils.hpp"
+#include <algorithm>
+#include <iostream>
+
+ShaderReloader::ShaderReloader() : m_reloadCount(0) {
+}
+
+bool ShaderReloader::add(Shader& shader) {
+    if (!m_watcher.addFile(shader.getVertexPath()) || !m_watcher.addFile(shader.getFragmentPath())) {
+        std::cerr << "Cannot watch shader files: " << shader.getVertexPath() << ", " << shader.getFragmentPath()
+                  << std::endl;
+        return false;
+    }
+    m_shaders.push_back(&shader);
+    return true;
+}
+
+bool ShaderReloader::add(ShaderPermutations& permutations) {
+    if (!m_watcher.addFile(permutations.getVertexPath()) || !m_watcher.addFile(permutations.getFragmentPath())) {
+        std::cerr << "Cannot watch shader files: " << permutations.getVertexPath() << ", "
+                  << permutations.getFragmentPath() << std::endl;
+        return false;
+    }
+    m_permutations.push_back(&permutations);
+    return true;
+}
+
+void ShaderReloader::remove(const Shader& shader) {
+    m_shaders.erase(std::remove(m_shaders.begin(), m_shaders.end(), &shader), m_shaders.end());
+}
+
+void ShaderReloader::remove(const ShaderPermutations& permutations) {
+    m_permutations.erase(std::remove(m_permutations.begin(), m_permutations.end(), &permutations),
+                         m_permutations.end());
+}
+
+size_t ShaderReloader::update() {
+    // Loads started last frame are checked first, so the driver always gets a frame to work on a new one
+    size_t swapped = 0;
+    for (Shader* shader : m_shaders) {
+        CompileStatus status = shader->pollLoad();
+        if (status == CompileStatus::Linked) {
+            swapped++;
+        } else if (status == CompileStatus::Failed) {
+            std::cerr << "Failed to reload shader " << shader->getFragmentPath() << ", keeping the previous program"
+                      << std::endl;
+        }
+    }
+    for (ShaderPermutations* permutations : m_permutations) {
+        swapped += permutations->update();
+    }
+    
+    m_changed.clear();
+    m_watcher.poll(m_changed);
+    if (m_changed.empty()) {
+        return swapped;
+    }
+    for (Shader* shader : m_shaders) {
+        if (isChanged(shader->getVertexPath(), shader->getFragmentPath()) && shader->reloadFromFiles()) {
+            std::cout << "Reloading shader " << shader->getFragmentPath() << std::endl;
+            m_reloadCount++;
+        }
+    }
+    for (ShaderPermutations* permutations : m_permutations) {
+        if (isChanged(permutations->getVertexPath(), permutations->getFragmentPath()) &&
+            permutations->reloadFromFiles()) {
+            std::cout << "Reloading shader " << permutations->getFragmentPath() << std::endl;
+            m_reloadCount++;
+        }
+    }
+    return swapped;
+}
+
+bool ShaderReloader::isChanged(const std::string& vertexPath, const std::string& fragmentPath) const {
+    for (const std::string& path : {vertexPath, fragmentPath}) {
+        if (std::find(m_changed.begin(), m_changed.end(), FileUtils::canonicalPath(path)) != m_changed.end()) {
+            return true;
+        }
+    }
+    return false;
+}
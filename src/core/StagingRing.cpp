@@ -0,0 +1,133 @@
+#include "core/StagingRing.hpp"
+#include <iostream>
+
+namespace {
+
+const GLbitfield PERSISTENT_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+} // namespace
+
+StagingRing::StagingRing() : m_slotBytes(0), m_next(0), m_persistent(false) {
+}
+
+StagingRing::~StagingRing() {
+    cleanup();
+}
+
+bool StagingRing::initialize(size_t slotCount, size_t slotBytes) {
+    cleanup();
+    if (slotCount == 0 || slotBytes == 0) {
+        return false;
+    }
+
+    m_slotBytes = slotBytes;
+    m_persistent = GLEW_ARB_buffer_storage;
+    m_slots.resize(slotCount);
+    for (Slot& slot : m_slots) {
+        glGenBuffers(1, &slot.buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, slot.buffer);
+        if (m_persistent) {
+            glBufferStorage(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(slotBytes), nullptr, PERSISTENT_FLAGS);
+            slot.pointer = static_cast<unsigned char*>(
+                glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, static_cast<GLsizeiptr>(slotBytes), PERSISTENT_FLAGS));
+            if (!slot.pointer) {
+                std::cerr << "Failed to map staging buffer" << std::endl;
+                glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+                cleanup();
+                return false;
+            }
+        } else {
+            glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(slotBytes), nullptr, GL_STREAM_DRAW);
+        }
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    m_stats = StagingStats();
+    return true;
+}
+
+void StagingRing::cleanup() {
+    for (Slot& slot : m_slots) {
+        if (slot.fence) {
+            glDeleteSync(slot.fence);
+        }
+        // Deleting a buffer unmaps it
+        glDeleteBuffers(1, &slot.buffer);
+    }
+    m_slots.clear();
+    m_slotBytes = 0;
+    m_next = 0;
+    m_persistent = false;
+}
+
+bool StagingRing::isIdle(Slot& slot) {
+    if (slot.state != SlotState::Free) return false;
+    if (!slot.fence) return true;
+
+    GLenum result = glClientWaitSync(slot.fence, 0, 0);
+    if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+        return false;
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    return true;
+}
+
+bool StagingRing::map(Slot& slot) {
+    if (m_persistent) return true;
+
+    // Orphaning gives the slot fresh storage, so the map never waits on the previous contents
+    glBindBuffer(GL_COPY_WRITE_BUFFER, slot.buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(m_slotBytes), nullptr, GL_STREAM_DRAW);
+    slot.pointer = static_cast<unsigned char*>(glMapBufferRange(
+        GL_COPY_WRITE_BUFFER, 0, static_cast<GLsizeiptr>(m_slotBytes),
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return slot.pointer != nullptr;
+}
+
+void StagingRing::unmap(Slot& slot) {
+    if (m_persistent || !slot.pointer) return;
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, slot.buffer);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    slot.pointer = nullptr;
+}
+
+int StagingRing::acquire(size_t bytes) {
+    if (bytes == 0 || bytes > m_slotBytes) return -1;
+
+    for (size_t i = 0; i < m_slots.size(); i++) {
+        size_t index = (m_next + i) % m_slots.size();
+        Slot& slot = m_slots[index];
+        if (!isIdle(slot)) continue;
+        if (!map(slot)) {
+            std::cerr << "Failed to map staging buffer" << std::endl;
+            return -1;
+        }
+
+        slot.state = SlotState::Acquired;
+        m_next = index + 1;
+        m_stats.acquiredSlots++;
+        return static_cast<int>(index);
+    }
+    m_stats.rejectedAcquires++;
+    return -1;
+}
+
+GLuint StagingRing::beginTransfer(int slot) {
+    unmap(m_slots[slot]);
+    return m_slots[slot].buffer;
+}
+
+void StagingRing::endTransfer(int slot) {
+    Slot& entry = m_slots[slot];
+    entry.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    entry.state = SlotState::Free;
+    m_stats.transfers++;
+}
+
+void StagingRing::release(int slot) {
+    unmap(m_slots[slot]);
+    m_slots[slot].state = SlotState::Free;
+}
@@ -1,9 +1,32 @@
 #include "core/Texture.hpp"
+#include "core/MipGenerator.hpp"
+#include "core/ThreadPool.hpp"
 #define STB_IMAGE_IMPLEMENTATION
 #include "core/stb_image.h"
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 
-Texture::Texture() : m_textureID(0), m_width(0), m_height(0), m_channels(0) {
+int TextureImage::getLevelCount() const {
+    if (!compressedLevels.empty()) {
+        return static_cast<int>(compressedLevels.size());
+    }
+    return pixels.empty() ? 0 : static_cast<int>(mips.size()) + 1;
+}
+
+const unsigned char* TextureImage::getLevel(int level, size_t& bytes) const {
+    if (!compressedLevels.empty()) {
+        bytes = compressedLevels[level].size;
+        return compressedLevels[level].data;
+    }
+    const std::vector<unsigned char>& data = level == 0 ? pixels : mips[level - 1];
+    bytes = data.size();
+    return data.data();
+}
+
+Texture::Texture()
+    : m_textureID(0), m_width(0), m_height(0), m_channels(0), m_memoryBytes(0), m_compressed(false),
+      m_internalFormat(0), m_pixelFormat(0), m_baseLevel(0), m_residentBytes(0), m_placeholder(false) {
 }
 
 Texture::~Texture() {
@@ -15,26 +38,341 @@ void Texture::cleanup() {
         glDeleteTextures(1, &m_textureID);
         m_textureID = 0;
     }
+    m_memoryBytes = 0;
+    m_compressed = false;
+    m_levelBytes.clear();
+    m_baseLevel = 0;
+    m_residentBytes = 0;
+    m_streamImage.reset();
+    m_sourceImage.reset();
+    m_placeholder = false;
+}
+
+namespace {
+
+std::atomic<bool> g_compressionEnabled{true};
+std::atomic<bool> g_streamingEnabled{true};
+
+GLenum getCompressedFormat(BlockFormat format) {
+    switch (format) {
+    case BlockFormat::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case BlockFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case BlockFormat::BC4: return GL_COMPRESSED_RED_RGTC1;
+    case BlockFormat::BC5: return GL_COMPRESSED_RG_RGTC2;
+    }
+    return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+}
+
+const char* getFormatName(BlockFormat format) {
+    switch (format) {
+    case BlockFormat::BC1: return "BC1";
+    case BlockFormat::BC3: return "BC3";
+    case BlockFormat::BC4: return "BC4";
+    case BlockFormat::BC5: return "BC5";
+    }
+    return "BC?";
+}
+
+} // namespace
+
+void Texture::setCompressionEnabled(bool enabled) {
+    g_compressionEnabled = enabled;
+}
+
+bool Texture::isCompressionEnabled() {
+    return g_compressionEnabled;
+}
+
+void Texture::setStreamingEnabled(bool enabled) {
+    g_streamingEnabled = enabled;
+}
+
+bool Texture::isStreamingEnabled() {
+    return g_streamingEnabled;
+}
+
+bool Texture::isFormatSupported(BlockFormat format) {
+    if (format == BlockFormat::BC1 || format == BlockFormat::BC3) {
+        return GLEW_EXT_texture_compression_s3tc;
+    }
+    return true;
+}
+
+bool Texture::loadCompressed(const std::string& filepath, TextureImage& image) {
+    auto cache = std::make_shared<TextureCache>();
+    if (!cache->open(filepath) || !isFormatSupported(cache->getFormat())) {
+        return false;
+    }
+    
+    const std::vector<TextureCache::Level>& levels = cache->getLevels();
+    image.width = levels[0].width;
+    image.height = levels[0].height;
+    image.channels = 0;
+    image.hasAlpha = cache->hasAlpha();
+    image.compressedFormat = cache->getFormat();
+    image.compressedLevels = levels;
+    if (cache->needsRefresh()) {
+        TextureCache::write(filepath, cache->getFormat(), cache->hasAlpha(), levels);
+    }
+    image.cache = std::move(cache);
+    return true;
+}
+
+void Texture::compressImage(const std::string& filepath, TextureImage& image) {
+    BlockFormat format = BlockCompressor::chooseFormat(image.channels, image.hasAlpha);
+    if (!isFormatSupported(format)) {
+        return;
+    }
+    
+    std::vector<ImageLevel> levels;
+    levels.push_back({image.pixels.data(), image.width, image.height});
+    int width = image.width;
+    int height = image.height;
+    for (const auto& mip : image.mips) {
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+        levels.push_back({mip.data(), width, height});
+    }
+    BlockCompressor::compress(levels, image.channels, format, image.compressedStorage, &ThreadPool::shared());
+    
+    image.compressedFormat = format;
+    image.compressedLevels.resize(levels.size());
+    for (size_t i = 0; i < levels.size(); i++) {
+        image.compressedLevels[i].data = image.compressedStorage[i].data();
+        image.compressedLevels[i].size = image.compressedStorage[i].size();
+        image.compressedLevels[i].width = levels[i].width;
+        image.compressedLevels[i].height = levels[i].height;
+    }
+    if (!TextureCache::write(filepath, format, image.hasAlpha, image.compressedLevels)) {
+        std::cerr << "Could not write texture cache: " << TextureCache::getCachePath(filepath) << std::endl;
+    }
+    
+    // The blocks replace the pixels
+    image.pixels.clear();
+    image.pixels.shrink_to_fit();
+    image.mips.clear();
 }
 
-unsigned char* Texture::loadImageData(const std::string& filepath) {
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* data = stbi_load(filepath.c_str(), &m_width, &m_height, &m_channels, 0);
+bool Texture::decodeFile(const std::string& filepath, TextureImage& image, bool generateMips) {
+    // The cache holds a full compressed chain, so it neither serves nor stores a base level alone
+    bool useCache = generateMips && isCompressionEnabled();
+    if (useCache && loadCompressed(filepath, image)) {
+        return true;
+    }
+    
+    // Per-thread flip flag, so workers can decode concurrently
+    stbi_set_flip_vertically_on_load_thread(true);
+    int width, height, channels;
+    if (!stbi_info(filepath.c_str(), &width, &height, &channels)) {
+        std::cerr << "Failed to load texture: " << filepath << std::endl;
+        std::cerr << "STB Error: " << stbi_failure_reason() << std::endl;
+        return false;
+    }
+    
+    // RGB is widened to RGBA so each pixel is one 32-bit word for the mip filter
+    int storedChannels = channels == 3 ? 4 : channels;
+    unsigned char* data = stbi_load(filepath.c_str(), &width, &height, &channels, storedChannels);
     if (!data) {
         std::cerr << "Failed to load texture: " << filepath << std::endl;
         std::cerr << "STB Error: " << stbi_failure_reason() << std::endl;
-        return nullptr;
+        return false;
+    }
+    
+    image.width = width;
+    image.height = height;
+    image.channels = storedChannels;
+    image.hasAlpha = channels == 2 || channels == 4;
+    image.pixels.assign(data, data + static_cast<size_t>(width) * height * storedChannels);
+    stbi_image_free(data);
+    
+    image.mips.clear();
+    if (generateMips) {
+        MipGenerator::generate(image.pixels.data(), width, height, storedChannels, image.mips, &ThreadPool::shared());
+    }
+    if (useCache) {
+        compressImage(filepath, image);
     }
-    return data;
+    return true;
 }
 
 bool Texture::loadFromFile(const std::string& filepath) {
-    cleanup();
+    auto image = std::make_shared<TextureImage>();
+    if (!decodeFile(filepath, *image) || !upload(image)) {
+        return false;
+    }
     
-    unsigned char* data = loadImageData(filepath);
-    if (!data) {
+    std::cout << "Loaded texture: " << filepath << " (" << m_width << "x" << m_height << ", "
+              << (m_compressed ? getFormatName(image->compressedFormat) : std::to_string(m_channels) + " channels")
+              << ", " << m_memoryBytes / 1024 << " KB)" << std::endl;
+    return true;
+}
+
+bool Texture::upload(const TextureImage& image) {
+    return createLevels(image, 0);
+}
+
+bool Texture::upload(const std::shared_ptr<const TextureImage>& image) {
+    if (!image || !createLevels(*image, 0)) {
+        return false;
+    }
+    m_sourceImage = image;
+    return true;
+}
+
+bool Texture::uploadPlaceholder() {
+    TextureImage image;
+    image.width = image.height = 1;
+    image.channels = 4;
+    image.pixels.assign(4, 128);
+    image.pixels[3] = 255;
+    if (!createLevels(image, 0)) {
+        return false;
+    }
+    m_placeholder = true;
+    return true;
+}
+
+bool Texture::uploadProgressive(const std::shared_ptr<const TextureImage>& image) {
+    if (!image) {
+        return false;
+    }
+    
+    // Without a CPU mip chain the driver builds the levels, so there is nothing to stream
+    int levelCount = image->getLevelCount();
+    int firstLevel = 0;
+    if (levelCount > 1) {
+        int size = std::max(image->width, image->height);
+        while (firstLevel + 1 < levelCount && (size >> firstLevel) > STREAM_TAIL_SIZE) {
+            firstLevel++;
+        }
+    }
+    if (!createLevels(*image, firstLevel)) {
+        return false;
+    }
+    if (firstLevel > 0) {
+        m_streamImage = image;
+    }
+    m_sourceImage = image;
+    return true;
+}
+
+size_t Texture::streamNextLevel() {
+    if (!m_streamImage) {
+        return 0;
+    }
+    
+    int level = m_baseLevel - 1;
+    glBindTexture(GL_TEXTURE_2D, m_textureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    uploadLevel(*m_streamImage, level);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    finishStreamedLevel(level);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return m_levelBytes[level];
+}
+
+int Texture::getLevelRows(int level, size_t& rowBytes) const {
+    int height = std::max(1, m_height >> level);
+    int rows = m_compressed ? (height + 3) / 4 : height;
+    rowBytes = m_levelBytes[level] / rows;
+    return rows;
+}
+
+size_t Texture::streamLevelRows(int level, int firstRow, int rowCount, GLuint buffer) {
+    if (!m_streamImage || level != m_baseLevel - 1) {
+        return 0;
+    }
+
+    size_t rowBytes = 0;
+    int rows = getLevelRows(level, rowBytes);
+    int width = std::max(1, m_width >> level);
+    int height = std::max(1, m_height >> level);
+    size_t bytes = rowBytes * rowCount;
+    glBindTexture(GL_TEXTURE_2D, m_textureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // Defined with no buffer bound, since a bound unpack buffer would be read from
+    if (firstRow == 0) {
+        if (m_compressed) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, m_internalFormat, width, height, 0,
+                                   static_cast<GLsizei>(m_levelBytes[level]), nullptr);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, level, m_internalFormat, width, height, 0, m_pixelFormat,
+                         GL_UNSIGNED_BYTE, nullptr);
+        }
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    if (m_compressed) {
+        // Block rows cover 4 pixel rows, the last one possibly fewer
+        int y = firstRow * 4;
+        int bandHeight = std::min(rowCount * 4, height - y);
+        glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, y, width, bandHeight, m_internalFormat,
+                                  static_cast<GLsizei>(bytes), nullptr);
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, firstRow, width, rowCount, m_pixelFormat, GL_UNSIGNED_BYTE, nullptr);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if (firstRow + rowCount >= rows) {
+        finishStreamedLevel(level);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return bytes;
+}
+
+void Texture::finishStreamedLevel(int level) {
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+    m_baseLevel = level;
+    m_residentBytes += m_levelBytes[level];
+    if (level == 0) {
+        m_streamImage.reset();
+    }
+}
+
+void Texture::uploadLevel(const TextureImage& image, int level) {
+    size_t bytes = 0;
+    const unsigned char* data = image.getLevel(level, bytes);
+    int width = std::max(1, m_width >> level);
+    int height = std::max(1, m_height >> level);
+    if (m_compressed) {
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, m_internalFormat, width, height, 0,
+                               static_cast<GLsizei>(bytes), data);
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, level, m_internalFormat, width, height, 0, m_pixelFormat, GL_UNSIGNED_BYTE, data);
+    }
+}
+
+bool Texture::createLevels(const TextureImage& image, int firstLevel) {
+    cleanup();
+    if (image.pixels.empty() && image.compressedLevels.empty()) {
         return false;
     }
+    m_width = image.width;
+    m_height = image.height;
+    m_channels = image.channels;
+    m_compressed = !image.compressedLevels.empty();
+    m_memoryBytes = 0;
+    
+    if (m_compressed) {
+        m_internalFormat = getCompressedFormat(image.compressedFormat);
+        m_pixelFormat = 0;
+    } else {
+        // Widened RGB keeps an RGB internal format
+        m_pixelFormat = GL_RGB;
+        m_internalFormat = GL_RGB8;
+        if (m_channels == 1) {
+            m_pixelFormat = GL_RED;
+            m_internalFormat = GL_R8;
+        } else if (m_channels == 2) {
+            m_pixelFormat = GL_RG;
+            m_internalFormat = GL_RG8;
+        } else if (m_channels == 4) {
+            m_pixelFormat = GL_RGBA;
+            m_internalFormat = image.hasAlpha ? GL_RGBA8 : GL_RGB8;
+        }
+    }
     
     glGenTextures(1, &m_textureID);
     glBindTexture(GL_TEXTURE_2D, m_textureID);
@@ -45,28 +383,82 @@ bool Texture::loadFromFile(const std::string& filepath) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     
-    // Determine format
-    GLenum format = GL_RGB;
-    if (m_channels == 1) {
-        format = GL_RED;
-    } else if (m_channels == 3) {
-        format = GL_RGB;
-    } else if (m_channels == 4) {
-        format = GL_RGBA;
-    }
+    // Rows are tightly packed, which breaks the default 4-byte alignment for narrow formats
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     
-    // Upload texture data
-    glTexImage2D(GL_TEXTURE_2D, 0, format, m_width, m_height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    int levelCount = image.getLevelCount();
+    if (!m_compressed && image.mips.empty()) {
+        uploadLevel(image, 0);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        m_levelBytes.push_back(image.pixels.size());
+        for (int level = 1; level < MipGenerator::getLevelCount(m_width, m_height); level++) {
+            m_levelBytes.push_back(static_cast<size_t>(std::max(1, m_width >> level)) *
+                                   std::max(1, m_height >> level) * m_channels);
+        }
+    } else {
+        // Levels finer than firstLevel are left undefined until streamed in
+        for (int level = 0; level < levelCount; level++) {
+            size_t bytes = 0;
+            image.getLevel(level, bytes);
+            m_levelBytes.push_back(bytes);
+        }
+        for (int level = levelCount - 1; level >= firstLevel; level--) {
+            uploadLevel(image, level);
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, firstLevel);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+    }
     
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     glBindTexture(GL_TEXTURE_2D, 0);
     
-    stbi_image_free(data);
-    
-    std::cout << "Loaded texture: " << filepath << " (" << m_width << "x" << m_height << ", " << m_channels << " channels)" << std::endl;
+    m_baseLevel = firstLevel;
+    for (size_t level = 0; level < m_levelBytes.size(); level++) {
+        m_memoryBytes += m_levelBytes[level];
+        if (static_cast<int>(level) >= m_baseLevel) {
+            m_residentBytes += m_levelBytes[level];
+        }
+    }
     return true;
 }
 
+bool Texture::isEvictable() const {
+    // Without a CPU mip chain the driver built the finer levels, so they could not be uploaded again
+    return m_sourceImage && m_sourceImage->getLevelCount() == getLevelCount();
+}
+
+void Texture::setBaseLevel(int level) {
+    if (m_textureID == 0 || m_streamImage || !isEvictable()) return;
+    level = std::clamp(level, 0, getLevelCount() - 1);
+    if (level == m_baseLevel) return;
+    
+    glBindTexture(GL_TEXTURE_2D, m_textureID);
+    if (level > m_baseLevel) {
+        // Sample from the new base before the finer levels go away
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+        for (int i = m_baseLevel; i < level; i++) {
+            // A 0x0 level has no storage; levels below the base level do not affect completeness
+            if (m_compressed) {
+                glCompressedTexImage2D(GL_TEXTURE_2D, i, m_internalFormat, 0, 0, 0, 0, nullptr);
+            } else {
+                glTexImage2D(GL_TEXTURE_2D, i, m_internalFormat, 0, 0, 0, m_pixelFormat, GL_UNSIGNED_BYTE, nullptr);
+            }
+            m_residentBytes -= m_levelBytes[i];
+        }
+    } else {
+        // The kept image still holds every level, so nothing was saved on the way out
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (int i = m_baseLevel - 1; i >= level; i--) {
+            uploadLevel(*m_sourceImage, i);
+            m_residentBytes += m_levelBytes[i];
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+    }
+    m_baseLevel = level;
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
 void Texture::bind(unsigned int unit) const {
     if (m_textureID == 0) return;
     glActiveTexture(GL_TEXTURE0 + unit);
@@ -0,0 +1,265 @@
+#include "core/TextureAtlas.hpp"
+#include "core/MipGenerator.hpp"
+#include "core/Texture.hpp"
+#include "core/ThreadPool.hpp"
+#include <algorithm>
+#include <iostream>
+
+TextureAtlas::TextureAtlas() : m_textureID(0), m_packed(false), m_layerCount(0), m_memoryBytes(0) {
+}
+
+TextureAtlas::~TextureAtlas() {
+    cleanup();
+}
+
+void TextureAtlas::cleanup() {
+    if (m_textureID != 0) {
+        glDeleteTextures(1, &m_textureID);
+        m_textureID = 0;
+    }
+    m_packed = false;
+    m_layerCount = 0;
+    m_memoryBytes = 0;
+    m_regions.clear();
+}
+
+bool TextureAtlas::getRegion(const Texture& texture, AtlasRegion& region) const {
+    auto it = m_regions.find(&texture);
+    if (it == m_regions.end()) {
+        return false;
+    }
+    region = it->second;
+    return true;
+}
+
+void TextureAtlas::bind(unsigned int unit) const {
+    if (m_textureID == 0) return;
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureID);
+}
+
+bool TextureAtlas::build(const std::vector<std::shared_ptr<Texture>>& textures) {
+    cleanup();
+
+    std::vector<Texture*> unique;
+    for (const auto& texture : textures) {
+        if (!texture || !texture->isValid()) continue;
+        if (std::find(unique.begin(), unique.end(), texture.get()) != unique.end()) continue;
+
+        // Every level is copied, so bring back streamed and evicted ones first
+        while (texture->isStreaming()) {
+            texture->streamNextLevel();
+        }
+        texture->setBaseLevel(0);
+        unique.push_back(texture.get());
+    }
+    if (unique.empty()) {
+        return false;
+    }
+
+    const Texture& first = *unique[0];
+    bool sameLayout = true;
+    for (const Texture* texture : unique) {
+        sameLayout = sameLayout && texture->getWidth() == first.getWidth() &&
+                     texture->getHeight() == first.getHeight() &&
+                     texture->getLevelCount() == first.getLevelCount() &&
+                     texture->getInternalFormat() == first.getInternalFormat();
+    }
+
+    glGenTextures(1, &m_textureID);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureID);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    m_packed = !sameLayout;
+    bool built = sameLayout ? buildLayers(unique) : buildPacked(unique);
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    if (!built) {
+        cleanup();
+        return false;
+    }
+
+    std::cout << "Built texture atlas: " << unique.size() << " textures in " << m_layerCount
+              << (m_packed ? " packed pages" : " layers") << " (" << m_memoryBytes / 1024 << " KB)" << std::endl;
+    return true;
+}
+
+bool TextureAtlas::buildLayers(const std::vector<Texture*>& textures) {
+    const Texture& first = *textures[0];
+    GLenum internalFormat = first.getInternalFormat();
+    GLsizei layers = static_cast<GLsizei>(textures.size());
+    GLint maxLayers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    if (layers > maxLayers) {
+        std::cerr << "Texture atlas needs " << layers << " layers, more than the " << maxLayers << " supported"
+                  << std::endl;
+        return false;
+    }
+    std::vector<unsigned char> data;
+
+    for (int level = 0; level < first.getLevelCount(); level++) {
+        int width = std::max(1, first.getWidth() >> level);
+        int height = std::max(1, first.getHeight() >> level);
+        size_t bytes = first.getLevelBytes(level);
+        if (first.isCompressed()) {
+            glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, internalFormat, width, height, layers, 0,
+                                   static_cast<GLsizei>(bytes * layers), nullptr);
+        } else {
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, level, internalFormat, width, height, layers, 0,
+                         first.getPixelFormat(), GL_UNSIGNED_BYTE, nullptr);
+        }
+
+        data.resize(bytes);
+        for (GLsizei layer = 0; layer < layers; layer++) {
+            glBindTexture(GL_TEXTURE_2D, textures[layer]->getID());
+            if (first.isCompressed()) {
+                glGetCompressedTexImage(GL_TEXTURE_2D, level, data.data());
+                glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, width, height, 1, internalFormat,
+                                          static_cast<GLsizei>(bytes), data.data());
+            } else {
+                glGetTexImage(GL_TEXTURE_2D, level, first.getPixelFormat(), GL_UNSIGNED_BYTE, data.data());
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, width, height, 1, first.getPixelFormat(),
+                                GL_UNSIGNED_BYTE, data.data());
+            }
+        }
+        m_memoryBytes += bytes * layers;
+    }
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, first.getLevelCount() - 1);
+
+    for (GLsizei layer = 0; layer < layers; layer++) {
+        AtlasRegion region;
+        region.layer = layer;
+        m_regions[textures[layer]] = region;
+    }
+    m_layerCount = layers;
+    return true;
+}
+
+bool TextureAtlas::buildPacked(const std::vector<Texture*>& textures) {
+    struct Placement {
+        Texture* texture;
+        int width;
+        int height;
+        int x;
+        int y;
+        int page;
+    };
+
+    // Regions start and end on multiples of the coarsest level's texel, so each level stays aligned
+    const int alignment = 1 << PACKED_MAX_LEVEL;
+    auto alignUp = [alignment](int value) { return (value + alignment - 1) / alignment * alignment; };
+
+    GLint maxSize = 0;
+    GLint maxLayers = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+    // Pages grow to fit the largest region, which may not fit in a texture even when its source does
+    int pageSize = std::min(PAGE_SIZE, static_cast<int>(maxSize));
+    std::vector<Placement> placements;
+    bool compressed = false;
+    for (Texture* texture : textures) {
+        placements.push_back({texture, alignUp(texture->getWidth() + 2 * PADDING),
+                              alignUp(texture->getHeight() + 2 * PADDING), 0, 0, 0});
+        pageSize = std::max({pageSize, placements.back().width, placements.back().height});
+        compressed = compressed || texture->isCompressed();
+    }
+    if (pageSize > maxSize) {
+        std::cerr << "Texture atlas page of " << pageSize << " pixels exceeds the " << maxSize << " supported"
+                  << std::endl;
+        return false;
+    }
+
+    // Shelf packing, tallest first
+    std::sort(placements.begin(), placements.end(), [](const Placement& a, const Placement& b) {
+        return a.height > b.height;
+    });
+    int x = 0, y = 0, shelfHeight = 0, page = 0;
+    for (Placement& placement : placements) {
+        if (x + placement.width > pageSize) {
+            x = 0;
+            y += shelfHeight;
+            shelfHeight = 0;
+        }
+        if (y + placement.height > pageSize) {
+            page++;
+            x = y = shelfHeight = 0;
+        }
+        placement.x = x;
+        placement.y = y;
+        placement.page = page;
+        x += placement.width;
+        shelfHeight = std::max(shelfHeight, placement.height);
+    }
+    GLsizei pages = page + 1;
+    if (pages > maxLayers) {
+        std::cerr << "Texture atlas needs " << pages << " pages, more than the " << maxLayers << " supported"
+                  << std::endl;
+        return false;
+    }
+    if (compressed) {
+        std::cout << "Texture atlas decodes block-compressed textures into RGBA8 pages" << std::endl;
+    }
+    int maxLevel = std::min(PACKED_MAX_LEVEL, MipGenerator::getLevelCount(pageSize, pageSize) - 1);
+
+    for (int level = 0; level <= maxLevel; level++) {
+        int size = std::max(1, pageSize >> level);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, size, size, pages, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        m_memoryBytes += static_cast<size_t>(size) * size * 4 * pages;
+    }
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, maxLevel);
+
+    std::vector<unsigned char> pixels;
+    std::vector<unsigned char> source;
+    std::vector<std::vector<unsigned char>> mips;
+    for (GLsizei current = 0; current < pages; current++) {
+        pixels.assign(static_cast<size_t>(pageSize) * pageSize * 4, 0);
+        for (const Placement& placement : placements) {
+            if (placement.page != current) continue;
+
+            // Compressed textures are decoded by the driver on readback
+            Texture& texture = *placement.texture;
+            int width = texture.getWidth();
+            int height = texture.getHeight();
+            source.resize(static_cast<size_t>(width) * height * 4);
+            glBindTexture(GL_TEXTURE_2D, texture.getID());
+            glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, source.data());
+
+            // The padding repeats the texture, as GL_REPEAT would sample it
+            for (int row = 0; row < placement.height; row++) {
+                int sourceRow = ((row - PADDING) % height + height) % height;
+                unsigned char* dst = &pixels[(static_cast<size_t>(placement.y + row) * pageSize + placement.x) * 4];
+                for (int column = 0; column < placement.width; column++) {
+                    int sourceColumn = ((column - PADDING) % width + width) % width;
+                    const unsigned char* src = &source[(static_cast<size_t>(sourceRow) * width + sourceColumn) * 4];
+                    std::copy(src, src + 4, dst + column * 4);
+                }
+            }
+
+            AtlasRegion region;
+            region.layer = current;
+            region.uvScale[0] = static_cast<float>(width) / pageSize;
+            region.uvScale[1] = static_cast<float>(height) / pageSize;
+            region.uvOffset[0] = static_cast<float>(placement.x + PADDING) / pageSize;
+            region.uvOffset[1] = static_cast<float>(placement.y + PADDING) / pageSize;
+            m_regions[placement.texture] = region;
+        }
+
+        MipGenerator::generate(pixels.data(), pageSize, pageSize, 4, mips, &ThreadPool::shared());
+        for (int level = 0; level <= maxLevel; level++) {
+            int size = std::max(1, pageSize >> level);
+            const unsigned char* data = level == 0 ? pixels.data() : mips[level - 1].data();
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, current, size, size, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        }
+    }
+    m_layerCount = pages;
+    return true;
+}
@@ -0,0 +1,166 @@
+#include "core/TextureCache.hpp"
+#include "core/FileUtils.hpp"
+#include "core/MipGenerator.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const char MAGIC[8] = {'I', 'A', 'O', 'T', 'E', 'X', '\0', '\0'};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t sourceSize;
+    int64_t sourceMtime;
+    uint64_t sourceHash;
+    uint32_t format;
+    uint32_t hasAlpha;
+    uint32_t levelCount;
+    uint32_t reserved;
+};
+
+struct LevelEntry {
+    uint64_t offset;
+    uint64_t size;
+    uint32_t width;
+    uint32_t height;
+};
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool isKnownFormat(uint32_t format) {
+    return format == static_cast<uint32_t>(BlockFormat::BC1) || format == static_cast<uint32_t>(BlockFormat::BC3) ||
+           format == static_cast<uint32_t>(BlockFormat::BC4) || format == static_cast<uint32_t>(BlockFormat::BC5);
+}
+
+} // namespace
+
+TextureCache::TextureCache() : m_format(BlockFormat::BC1), m_hasAlpha(false), m_needsRefresh(false) {
+}
+
+std::string TextureCache::getCachePath(const std::string& sourcePath) {
+    return sourcePath + ".texcache";
+}
+
+void TextureCache::close() {
+    m_file.close();
+    m_levels.clear();
+    m_needsRefresh = false;
+}
+
+bool TextureCache::open(const std::string& sourcePath) {
+    close();
+
+    FileStamp sourceStamp = FileUtils::getStamp(sourcePath);
+    if (!sourceStamp.valid || !m_file.open(getCachePath(sourcePath))) {
+        return false;
+    }
+
+    const char* data = m_file.data();
+    Header header;
+    if (m_file.size() < sizeof(Header)) {
+        close();
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(Header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.headerSize != sizeof(Header) || !isKnownFormat(header.format) || header.levelCount == 0 ||
+        m_file.size() < sizeof(Header) + header.levelCount * sizeof(LevelEntry)) {
+        close();
+        return false;
+    }
+
+    // Same size and mtime is trusted; otherwise fall back to the content hash
+    if (sourceStamp.size != header.sourceSize || sourceStamp.mtimeNs != header.sourceMtime) {
+        uint64_t hash = 0;
+        if (sourceStamp.size != header.sourceSize || !FileUtils::hashFile(sourcePath, hash) ||
+            hash != header.sourceHash) {
+            close();
+            return false;
+        }
+        m_needsRefresh = true;
+    }
+
+    m_format = static_cast<BlockFormat>(header.format);
+    m_hasAlpha = header.hasAlpha != 0;
+    m_levels.resize(header.levelCount);
+    for (uint32_t i = 0; i < header.levelCount; i++) {
+        LevelEntry entry;
+        std::memcpy(&entry, data + sizeof(Header) + i * sizeof(LevelEntry), sizeof(LevelEntry));
+        // Subtracted rather than added, so a huge offset cannot wrap past the check
+        if (entry.width == 0 || entry.height == 0 || entry.offset > m_file.size() ||
+            entry.size > m_file.size() - entry.offset ||
+            entry.size != BlockCompressor::getCompressedSize(m_format, entry.width, entry.height)) {
+            close();
+            return false;
+        }
+        m_levels[i].data = reinterpret_cast<const unsigned char*>(data + entry.offset);
+        m_levels[i].size = entry.size;
+        m_levels[i].width = static_cast<int>(entry.width);
+        m_levels[i].height = static_cast<int>(entry.height);
+    }
+
+    // Only a full chain halving down to 1x1 is usable; a partial one would leave the texture without mips
+    int width = m_levels[0].width;
+    int height = m_levels[0].height;
+    if (static_cast<int>(header.levelCount) != MipGenerator::getLevelCount(width, height)) {
+        close();
+        return false;
+    }
+    for (uint32_t i = 1; i < header.levelCount; i++) {
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+        if (m_levels[i].width != width || m_levels[i].height != height) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TextureCache::write(const std::string& sourcePath, BlockFormat format, bool hasAlpha,
+                         const std::vector<Level>& levels) {
+    FileStamp sourceStamp = FileUtils::getStamp(sourcePath);
+    uint64_t sourceHash = 0;
+    bool fullChain = !levels.empty() &&
+                     static_cast<int>(levels.size()) == MipGenerator::getLevelCount(levels[0].width, levels[0].height);
+    if (!fullChain || !sourceStamp.valid || !FileUtils::hashFile(sourcePath, sourceHash)) {
+        return false;
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.headerSize = sizeof(Header);
+    header.sourceSize = sourceStamp.size;
+    header.sourceMtime = sourceStamp.mtimeNs;
+    header.sourceHash = sourceHash;
+    header.format = static_cast<uint32_t>(format);
+    header.hasAlpha = hasAlpha ? 1 : 0;
+    header.levelCount = static_cast<uint32_t>(levels.size());
+
+    // Header, level table, then each level's blocks 16-byte aligned
+    std::vector<LevelEntry> entries(levels.size());
+    size_t offset = sizeof(Header) + levels.size() * sizeof(LevelEntry);
+    for (size_t i = 0; i < levels.size(); i++) {
+        offset = alignUp(offset, 16);
+        entries[i].offset = offset;
+        entries[i].size = levels[i].size;
+        entries[i].width = static_cast<uint32_t>(levels[i].width);
+        entries[i].height = static_cast<uint32_t>(levels[i].height);
+        offset += levels[i].size;
+    }
+
+    std::vector<char> buffer(offset, 0);
+    std::memcpy(buffer.data(), &header, sizeof(Header));
+    std::memcpy(buffer.data() + sizeof(Header), entries.data(), entries.size() * sizeof(LevelEntry));
+    for (size_t i = 0; i < levels.size(); i++) {
+        std::memcpy(buffer.data() + entries[i].offset, levels[i].data, levels[i].size);
+    }
+
+    return FileUtils::writeAtomic(getCachePath(sourcePath), buffer.data(), buffer.size());
+}
@@ -0,0 +1,181 @@
+#include "core/TextureResidencyManager.hpp"
+#include "core/Texture.hpp"
+#include <algorithm>
+#include <vector>
+
+TextureResidencyManager& TextureResidencyManager::shared() {
+    static TextureResidencyManager manager;
+    return manager;
+}
+
+void TextureResidencyManager::track(const std::shared_ptr<Texture>& texture) {
+    if (!texture || !texture->isValid()) return;
+
+    auto it = m_entries.find(texture.get());
+    if (it != m_entries.end() && !it->second.texture.expired()) return;
+
+    // A new texture at a recycled address replaces the dead entry
+    Entry entry;
+    entry.texture = texture;
+    entry.lastUsedFrame = m_frame;
+    m_entries[texture.get()] = entry;
+    m_residentBytes += texture->getResidentBytes();
+}
+
+void TextureResidencyManager::request(const Texture& texture, int level) {
+    auto it = m_entries.find(&texture);
+    if (it == m_entries.end()) return;
+
+    Entry& entry = it->second;
+    level = std::clamp(level, 0, getMaxBaseLevel(texture));
+    entry.requestedLevel = entry.used ? std::min(entry.requestedLevel, level) : level;
+    entry.used = true;
+    entry.lastUsedFrame = m_frame;
+}
+
+void TextureResidencyManager::evictToTail(Texture& texture) {
+    setBaseLevel(texture, getMaxBaseLevel(texture));
+}
+
+void TextureResidencyManager::restore(Texture& texture) {
+    setBaseLevel(texture, 0);
+}
+
+int TextureResidencyManager::getMaxBaseLevel(const Texture& texture) {
+    if (!texture.isEvictable()) {
+        return 0;
+    }
+    int level = 0;
+    int size = std::max(texture.getWidth(), texture.getHeight());
+    while (level + 1 < texture.getLevelCount() && (size >> level) > MIN_RESIDENT_SIZE) {
+        level++;
+    }
+    return level;
+}
+
+void TextureResidencyManager::setBaseLevel(Texture& texture, int level) {
+    size_t before = texture.getResidentBytes();
+    int previous = texture.getBaseLevel();
+    texture.setBaseLevel(level);
+    size_t after = texture.getResidentBytes();
+    m_residentBytes = m_residentBytes - before + after;
+
+    if (texture.getBaseLevel() > previous) {
+        m_stats.evictedLevels += texture.getBaseLevel() - previous;
+        m_stats.evictedBytes += before - after;
+    } else if (texture.getBaseLevel() < previous) {
+        m_stats.restoredLevels += previous - texture.getBaseLevel();
+        m_stats.restoredBytes += after - before;
+    }
+}
+
+bool TextureResidencyManager::isOverBudget(size_t extraBytes) const {
+    return m_budget != 0 && m_residentBytes + extraBytes > m_budget;
+}
+
+void TextureResidencyManager::evictUnused(size_t extraBytes) {
+    if (!isOverBudget(extraBytes)) return;
+
+    std::vector<Entry*> unused;
+    for (auto& item : m_entries) {
+        if (!item.second.used && !item.second.texture.lock()->isStreaming()) unused.push_back(&item.second);
+    }
+    std::sort(unused.begin(), unused.end(), [](const Entry* a, const Entry* b) {
+        return a->lastUsedFrame < b->lastUsedFrame;
+    });
+
+    for (Entry* entry : unused) {
+        std::shared_ptr<Texture> texture = entry->texture.lock();
+        int maxLevel = getMaxBaseLevel(*texture);
+        while (isOverBudget(extraBytes) && texture->getBaseLevel() < maxLevel) {
+            setBaseLevel(*texture, texture->getBaseLevel() + 1);
+        }
+        if (!isOverBudget(extraBytes)) return;
+    }
+}
+
+void TextureResidencyManager::update() {
+    // Forget destroyed textures; their memory is already gone
+    m_residentBytes = 0;
+    m_stats.fullBytes = 0;
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        std::shared_ptr<Texture> texture = it->second.texture.lock();
+        if (!texture || !texture->isValid()) {
+            it = m_entries.erase(it);
+            continue;
+        }
+        m_residentBytes += texture->getResidentBytes();
+        m_stats.fullBytes += texture->getMemoryBytes();
+        ++it;
+    }
+
+    // Drawn textures get one level back per frame, largest deficit first; streaming ones are left alone
+    std::vector<Entry*> used;
+    for (auto& item : m_entries) {
+        if (item.second.used && !item.second.texture.lock()->isStreaming()) used.push_back(&item.second);
+    }
+    std::sort(used.begin(), used.end(), [](const Entry* a, const Entry* b) {
+        int deficitA = a->texture.lock()->getBaseLevel() - a->requestedLevel;
+        int deficitB = b->texture.lock()->getBaseLevel() - b->requestedLevel;
+        return deficitA > deficitB;
+    });
+    for (Entry* entry : used) {
+        std::shared_ptr<Texture> texture = entry->texture.lock();
+        int base = texture->getBaseLevel();
+        if (base <= entry->requestedLevel) continue;
+
+        size_t bytes = texture->getLevelBytes(base - 1);
+        evictUnused(bytes);
+        if (isOverBudget(bytes)) {
+            m_stats.deferredRestores++;
+            continue;
+        }
+        setBaseLevel(*texture, base - 1);
+    }
+
+    if (isOverBudget()) {
+        evictUnused(0);
+
+        // Drop detail finer than requested, most surplus first
+        std::sort(used.begin(), used.end(), [](const Entry* a, const Entry* b) {
+            int surplusA = a->requestedLevel - a->texture.lock()->getBaseLevel();
+            int surplusB = b->requestedLevel - b->texture.lock()->getBaseLevel();
+            return surplusA > surplusB;
+        });
+        for (Entry* entry : used) {
+            std::shared_ptr<Texture> texture = entry->texture.lock();
+            while (isOverBudget() && texture->getBaseLevel() < entry->requestedLevel) {
+                setBaseLevel(*texture, texture->getBaseLevel() + 1);
+            }
+        }
+
+        // Still over: degrade every drawn texture one level at a time, largest first
+        bool evicted = true;
+        while (isOverBudget() && evicted) {
+            evicted = false;
+            std::sort(used.begin(), used.end(), [](const Entry* a, const Entry* b) {
+                return a->texture.lock()->getResidentBytes() > b->texture.lock()->getResidentBytes();
+            });
+            for (Entry* entry : used) {
+                std::shared_ptr<Texture> texture = entry->texture.lock();
+                if (!isOverBudget()) break;
+                if (texture->getBaseLevel() < getMaxBaseLevel(*texture)) {
+                    setBaseLevel(*texture, texture->getBaseLevel() + 1);
+                    evicted = true;
+                }
+            }
+        }
+        if (isOverBudget()) {
+            m_stats.overBudgetFrames++;
+        }
+    }
+
+    for (auto& item : m_entries) {
+        item.second.used = false;
+    }
+    m_frame++;
+
+    m_stats.textureCount = m_entries.size();
+    m_stats.budgetBytes = m_budget;
+    m_stats.residentBytes = m_residentBytes;
+}
@@ -0,0 +1,281 @@
+#include "core/TextureStreamer.hpp"
+#include "core/StagingRing.hpp"
+#include "core/Texture.hpp"
+#include "core/ThreadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+// Reads one byte per page so mapped levels are resident before the upload touches them
+void touchPages(const unsigned char* data, size_t bytes) {
+    const size_t PAGE_SIZE = 4096;
+    volatile unsigned char sink = 0;
+    for (size_t offset = 0; offset < bytes; offset += PAGE_SIZE) {
+        sink = sink + data[offset];
+    }
+    if (bytes > 0) {
+        sink = sink + data[bytes - 1];
+    }
+}
+
+} // namespace
+
+TextureStreamer::TextureStreamer(ThreadPool& pool) : m_pool(pool), m_staging(nullptr), m_next(0) {
+}
+
+TextureStreamer::~TextureStreamer() {
+    for (const StagedBand& band : m_staged) {
+        band.copy.wait();
+    }
+    for (const auto& state : m_streams) {
+        state->cancelled = true;
+    }
+    for (const auto& state : m_streams) {
+        if (state->task.valid()) {
+            state->task.wait();
+        }
+    }
+}
+
+TextureStreamer& TextureStreamer::shared() {
+    static TextureStreamer streamer(ThreadPool::shared());
+    return streamer;
+}
+
+void TextureStreamer::stream(const std::shared_ptr<Texture>& texture) {
+    if (!texture || !texture->isStreaming()) return;
+    for (const auto& state : m_streams) {
+        if (state->texture.lock() == texture) return;
+    }
+
+    auto state = std::make_shared<StreamState>();
+    state->texture = texture;
+    state->readyLevel = texture->getBaseLevel();
+    std::shared_ptr<const TextureImage> image = texture->getStreamImage();
+    int firstLevel = texture->getBaseLevel();
+
+    // A weak reference: the task's shared state must not keep its own state alive
+    std::weak_ptr<StreamState> weakState = state;
+    state->task = m_pool.submit([weakState, image, firstLevel]() {
+        std::shared_ptr<StreamState> state = weakState.lock();
+        for (int level = firstLevel - 1; state && level >= 0 && !state->cancelled; level--) {
+            size_t bytes = 0;
+            const unsigned char* data = image->getLevel(level, bytes);
+            touchPages(data, bytes);
+            state->readyLevel = level;
+        }
+    });
+    m_streams.push_back(state);
+}
+
+void TextureStreamer::streamFile(const std::shared_ptr<Texture>& texture, const std::string& path) {
+    if (!texture) return;
+    for (const auto& state : m_streams) {
+        if (state->texture.lock() == texture) return;
+    }
+
+    auto state = std::make_shared<StreamState>();
+    state->texture = texture;
+    state->decodeImage = std::make_shared<TextureImage>();
+    state->decodeStatus = DECODE_PENDING;
+    std::shared_ptr<TextureImage> image = state->decodeImage;
+
+    // Decoding reads every level, so the finer ones are resident once the coarse tail is uploaded
+    std::weak_ptr<StreamState> weakState = state;
+    state->task = m_pool.submit([weakState, image, path]() {
+        std::shared_ptr<StreamState> state = weakState.lock();
+        if (!state || state->cancelled) return;
+        if (!Texture::decodeFile(path, *image)) {
+            state->decodeStatus = DECODE_FAILED;
+            return;
+        }
+        for (int level = image->getLevelCount() - 1; level >= 0 && !state->cancelled; level--) {
+            size_t bytes = 0;
+            touchPages(image->getLevel(level, bytes), bytes);
+        }
+        state->readyLevel = 0;
+        state->decodeStatus = DECODE_DONE;
+    });
+    m_streams.push_back(state);
+}
+
+void TextureStreamer::finishDecodes() {
+    for (const auto& state : m_streams) {
+        int status = state->decodeStatus;
+        if (status != DECODE_DONE && status != DECODE_FAILED) continue;
+
+        // The texture streams from the image like any progressive upload from here on
+        std::shared_ptr<Texture> texture = state->texture.lock();
+        if (texture && status == DECODE_DONE) {
+            texture->uploadProgressive(state->decodeImage);
+        }
+        state->decodeImage.reset();
+        state->decodeStatus = DECODE_NONE;
+    }
+}
+
+size_t TextureStreamer::update(size_t budgetBytes, StagingRing* staging) {
+    if (staging && !staging->isValid()) {
+        staging = nullptr;
+    }
+    if (staging != m_staging) {
+        releaseStaging();
+        m_staging = staging;
+    }
+
+    finishDecodes();
+    size_t uploaded = 0;
+    if (staging) {
+        uploaded = uploadStaged(*staging);
+        uploaded += stageBands(budgetBytes, *staging);
+    } else {
+        uploaded = uploadDirect(budgetBytes);
+    }
+
+    // Drop finished and destroyed textures; their decode or read-ahead is done or cancelled
+    for (auto it = m_streams.begin(); it != m_streams.end();) {
+        std::shared_ptr<Texture> texture = (*it)->texture.lock();
+        if (texture && (texture->isStreaming() || (*it)->decodeStatus != DECODE_NONE)) {
+            ++it;
+            continue;
+        }
+        (*it)->cancelled = true;
+        if ((*it)->task.valid()) {
+            (*it)->task.wait();
+        }
+        it = m_streams.erase(it);
+    }
+    return uploaded;
+}
+
+size_t TextureStreamer::uploadDirect(size_t budgetBytes) {
+    size_t uploaded = 0;
+    size_t levels = 0;
+    bool progress = true;
+
+    while (progress && !m_streams.empty()) {
+        progress = false;
+        for (size_t i = 0; i < m_streams.size(); i++) {
+            // Round-robin so no texture starves the others
+            StreamState& state = *m_streams[(m_next + i) % m_streams.size()];
+            std::shared_ptr<Texture> texture = state.texture.lock();
+            if (!texture || !texture->isStreaming()) continue;
+
+            int level = texture->getBaseLevel() - 1;
+            if (state.readyLevel > level) continue;
+            if (levels > 0 && uploaded + texture->getLevelBytes(level) > budgetBytes) continue;
+
+            uploaded += texture->streamNextLevel();
+            levels++;
+            progress = true;
+        }
+        m_next++;
+    }
+    return uploaded;
+}
+
+size_t TextureStreamer::uploadStaged(StagingRing& staging) {
+    // In staging order, so each texture's bands arrive in sequence
+    size_t uploaded = 0;
+    while (!m_staged.empty()) {
+        StagedBand& band = m_staged.front();
+        if (band.copy.wait_for(std::chrono::seconds(0)) != std::future_status::ready) break;
+
+        // A texture uploaded again since has a new image, and restarts from its own tail
+        std::shared_ptr<Texture> texture = band.state->texture.lock();
+        if (texture && texture->getStreamImage() == band.image) {
+            GLuint buffer = staging.beginTransfer(band.slot);
+            uploaded += texture->streamLevelRows(band.level, band.firstRow, band.rowCount, buffer);
+            staging.endTransfer(band.slot);
+        } else {
+            staging.release(band.slot);
+        }
+        band.state->stagedBands--;
+        m_staged.pop_front();
+    }
+    return uploaded;
+}
+
+size_t TextureStreamer::stageBands(size_t budgetBytes, StagingRing& staging) {
+    size_t uploaded = 0;
+    size_t staged = 0;
+    size_t bands = 0;
+    bool progress = true;
+
+    while (progress && !m_streams.empty()) {
+        progress = false;
+        for (size_t i = 0; i < m_streams.size(); i++) {
+            StreamState& state = *m_streams[(m_next + i) % m_streams.size()];
+            std::shared_ptr<Texture> texture = state.texture.lock();
+            if (!texture || !texture->isStreaming()) continue;
+            if (state.stageLevel < 0 && state.stagedBands == 0) {
+                state.stageLevel = texture->getBaseLevel() - 1;
+                state.stageRow = 0;
+            }
+            if (state.stageLevel < 0) continue;
+
+            size_t rowBytes = 0;
+            int rows = texture->getLevelRows(state.stageLevel, rowBytes);
+            int rowCount = std::min(rows - state.stageRow, static_cast<int>(staging.getSlotBytes() / rowBytes));
+            if (rowCount == 0) {
+                // A row wider than a slot goes up from client memory once the earlier bands are in
+                if (state.stagedBands == 0) {
+                    uploaded += texture->streamNextLevel();
+                    state.stageLevel = -1;
+                    progress = true;
+                }
+                continue;
+            }
+            size_t bytes = rowBytes * rowCount;
+            if (bands > 0 && staged + bytes > budgetBytes) continue;
+
+            int slot = staging.acquire(bytes);
+            if (slot < 0) {
+                return uploaded;
+            }
+
+            // The task keeps the image alive; the slot stays acquired until its band is uploaded
+            std::shared_ptr<const TextureImage> image = texture->getStreamImage();
+            size_t levelBytes = 0;
+            const unsigned char* source = image->getLevel(state.stageLevel, levelBytes) + rowBytes * state.stageRow;
+            unsigned char* destination = staging.getPointer(slot);
+            StagedBand band;
+            band.state = m_streams[(m_next + i) % m_streams.size()];
+            band.image = image;
+            band.level = state.stageLevel;
+            band.firstRow = state.stageRow;
+            band.rowCount = rowCount;
+            band.slot = slot;
+            band.copy = m_pool.submit([image, source, destination, bytes]() {
+                std::memcpy(destination, source, bytes);
+            });
+            m_staged.push_back(std::move(band));
+
+            state.stagedBands++;
+            state.stageRow += rowCount;
+            if (state.stageRow >= rows) {
+                state.stageLevel--;
+                state.stageRow = 0;
+            }
+            staged += bytes;
+            bands++;
+            progress = true;
+        }
+        m_next++;
+    }
+    return uploaded;
+}
+
+void TextureStreamer::releaseStaging() {
+    for (StagedBand& band : m_staged) {
+        band.copy.wait();
+        if (m_staging) {
+            m_staging->release(band.slot);
+        }
+        band.state->stageLevel = -1;
+        band.state->stagedBands = 0;
+    }
+    m_staged.clear();
+}
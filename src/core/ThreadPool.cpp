@@ -0,0 +1,92 @@
+#include "core/ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+
+ThreadPool::ThreadPool(size_t threadCount) : m_stopping(false) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    m_workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push(std::move(task));
+    }
+    m_condition.notify_one();
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+            if (m_stopping && m_tasks.empty()) {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+    if (count == 0) return;
+    if (count == 1) {
+        body(0);
+        return;
+    }
+
+    // Shared between the caller and the helpers; helpers that start after all
+    // iterations are claimed simply exit
+    struct State {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto state = std::make_shared<State>();
+
+    auto run = [state, count, &body]() {
+        size_t completed = 0;
+        for (size_t i = state->next++; i < count; i = state->next++) {
+            body(i);
+            completed++;
+        }
+        if (completed > 0 && state->done.fetch_add(completed) + completed == count) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->finished.notify_all();
+        }
+    };
+
+    size_t helpers = std::min(count - 1, m_workers.size());
+    for (size_t i = 0; i < helpers; i++) {
+        enqueue(run);
+    }
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&]() { return state->done.load() == count; });
+}
@@ -0,0 +1,125 @@
+#include "core/UniformRing.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// A frame three frames old is normally long finished; this only bounds a stalled GPU
+const GLuint64 FENCE_TIMEOUT_NS = 1000000000ull;
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+UniformRing::UniformRing() : m_buffer(0), m_frameBytes(0), m_alignment(1), m_frame(0), m_fences() {
+}
+
+UniformRing::~UniformRing() {
+    cleanup();
+}
+
+bool UniformRing::initialize(size_t frameBytes) {
+    cleanup();
+    if (frameBytes == 0) {
+        return false;
+    }
+
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    m_alignment = alignment > 0 ? static_cast<size_t>(alignment) : 256;
+    m_frameBytes = alignUp(frameBytes, m_alignment);
+
+    glGenBuffers(1, &m_buffer);
+    if (m_buffer == 0) {
+        std::cerr << "Failed to create uniform buffer" << std::endl;
+        return false;
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+    glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(m_frameBytes * FRAME_COUNT), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    m_data.reserve(m_frameBytes);
+    return true;
+}
+
+void UniformRing::cleanup() {
+    for (GLsync& fence : m_fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    if (m_buffer != 0) {
+        glDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+    }
+    m_data.clear();
+    m_frameBytes = 0;
+    m_frame = 0;
+}
+
+void UniformRing::beginFrame() {
+    m_frame = (m_frame + 1) % FRAME_COUNT;
+    m_data.clear();
+
+    GLsync& fence = m_fences[m_frame];
+    if (fence) {
+        glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS);
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+}
+
+size_t UniformRing::push(const void* data, size_t bytes) {
+    size_t offset = alignUp(m_data.size(), m_alignment);
+    m_data.resize(offset + bytes);
+    std::memcpy(m_data.data() + offset, data, bytes);
+    return offset;
+}
+
+void UniformRing::upload() {
+    if (m_buffer == 0 || m_data.empty()) return;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+    if (m_data.size() > m_frameBytes) {
+        // Orphaning leaves the old storage to the frames still reading it, so none of the fences apply any more
+        m_frameBytes = alignUp(std::max(m_data.size(), m_frameBytes * 2), m_alignment);
+        glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(m_frameBytes * FRAME_COUNT), nullptr,
+                     GL_DYNAMIC_DRAW);
+        for (GLsync& fence : m_fences) {
+            if (fence) {
+                glDeleteSync(fence);
+                fence = nullptr;
+            }
+        }
+    }
+
+    // The region's fence has passed, so the write needs no synchronization with the GPU
+    GLintptr base = static_cast<GLintptr>(m_frameBytes * m_frame);
+    void* pointer = glMapBufferRange(GL_UNIFORM_BUFFER, base, static_cast<GLsizeiptr>(m_data.size()),
+                                     GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (pointer) {
+        std::memcpy(pointer, m_data.data(), m_data.size());
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+    } else {
+        glBufferSubData(GL_UNIFORM_BUFFER, base, static_cast<GLsizeiptr>(m_data.size()), m_data.data());
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UniformRing::bind(GLuint binding, size_t offset, size_t bytes) const {
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, m_buffer, static_cast<GLintptr>(m_frameBytes * m_frame + offset),
+                      static_cast<GLsizeiptr>(bytes));
+}
+
+void UniformRing::endFrame() {
+    if (m_buffer == 0) return;
+
+    GLsync& fence = m_fences[m_frame];
+    if (fence) {
+        glDeleteSync(fence);
+    }
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
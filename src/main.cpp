@@ -2,9 +2,19 @@
 #include "scene/Scene.hpp"
 #include "core/Controls.hpp"
 #include <GLFW/glfw3.h>
+#include <cstring>
 #include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+    // Scene shaders are read from this directory and reloaded whenever they are saved
+    std::string shaderDir = "shaders";
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--shader-dir") == 0 && i + 1 < argc) {
+            shaderDir = argv[++i];
+        }
+    }
 
-int main() {
     // Create window
     Window window(800, 600, "OpenGL Animation");
 
@@ -23,8 +33,11 @@ int main() {
         return -1;
     }
 
-    // Add mountain model to scene at origin (0,0,0)
-    scene.addObject("models/mountain/mount.blend1.obj", 0.0f, 0.0f, 0.0f);
+    // Falls back to the built-in shader if the files are missing or do not compile
+    scene.loadShaderFiles(shaderDir + "/scene.vert", shaderDir + "/scene.frag");
+
+    // Add mountain model to scene at origin (0,0,0); it appears once loaded in the background
+    scene.addObjectAsync("models/mountain/mount.blend1.obj", 0.0f, 0.0f, 0.0f);
 
     // Create controls for camera
     Controls controls(window, scene.getCamera());
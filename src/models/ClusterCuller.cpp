@@ -0,0 +1,74 @@
+#include "models/ClusterCuller.hpp"
+#include <cmath>
+#include <cstring>
+
+ClusterCuller::ClusterCuller() : m_coneCulling(true), m_mirrored(false) {
+    std::memset(m_planes, 0, sizeof(m_planes));
+    std::memset(m_cameraPosition, 0, sizeof(m_cameraPosition));
+}
+
+void ClusterCuller::setView(const float* model, const float* modelViewProjection, const float* cameraPosition) {
+    const float* clip = modelViewProjection;
+
+    // Gribb-Hartmann: planes are row 3 plus or minus rows 0..2 of the clip matrix
+    for (int i = 0; i < 3; i++) {
+        for (int k = 0; k < 4; k++) {
+            float w = clip[k * 4 + 3];
+            float r = clip[k * 4 + i];
+            m_planes[i * 2][k] = w + r;
+            m_planes[i * 2 + 1][k] = w - r;
+        }
+    }
+    for (auto& plane : m_planes) {
+        float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f) {
+            for (float& value : plane) value /= length;
+        }
+    }
+
+    // Camera position in model space: inverse of the affine model matrix
+    const float* m = model;
+    float cof[9] = {
+        m[5] * m[10] - m[9] * m[6], m[8] * m[6] - m[4] * m[10], m[4] * m[9] - m[8] * m[5],
+        m[9] * m[2] - m[1] * m[10], m[0] * m[10] - m[8] * m[2], m[8] * m[1] - m[0] * m[9],
+        m[1] * m[6] - m[5] * m[2], m[4] * m[2] - m[0] * m[6], m[0] * m[5] - m[4] * m[1],
+    };
+    float det = m[0] * cof[0] + m[4] * cof[3] + m[8] * cof[6];
+    m_mirrored = det < 0.0f;
+    float p[3] = {cameraPosition[0] - m[12], cameraPosition[1] - m[13], cameraPosition[2] - m[14]};
+    if (det != 0.0f) {
+        for (int row = 0; row < 3; row++) {
+            m_cameraPosition[row] = (cof[row * 3] * p[0] + cof[row * 3 + 1] * p[1] + cof[row * 3 + 2] * p[2]) / det;
+        }
+    }
+}
+
+bool ClusterCuller::isVisible(const Meshlet& meshlet) {
+    m_stats.tested++;
+
+    for (const auto& plane : m_planes) {
+        float distance = plane[0] * meshlet.center[0] + plane[1] * meshlet.center[1] +
+                         plane[2] * meshlet.center[2] + plane[3];
+        if (distance < -meshlet.radius) {
+            m_stats.frustumCulled++;
+            m_stats.culled++;
+            return false;
+        }
+    }
+
+    if (m_coneCulling && !m_mirrored && meshlet.coneCutoff < 1.0f) {
+        float toCenter[3] = {meshlet.center[0] - m_cameraPosition[0], meshlet.center[1] - m_cameraPosition[1],
+                             meshlet.center[2] - m_cameraPosition[2]};
+        float distance = std::sqrt(toCenter[0] * toCenter[0] + toCenter[1] * toCenter[1] + toCenter[2] * toCenter[2]);
+        float facing = toCenter[0] * meshlet.coneAxis[0] + toCenter[1] * meshlet.coneAxis[1] +
+                       toCenter[2] * meshlet.coneAxis[2];
+        if (facing >= meshlet.coneCutoff * distance + meshlet.radius) {
+            m_stats.coneCulled++;
+            m_stats.culled++;
+            return false;
+        }
+    }
+
+    m_stats.drawn++;
+    return true;
+}
@@ -0,0 +1,316 @@
+#include "models/MeshCache.hpp"
+#include "core/FileUtils.hpp"
+#include <cstring>
+
+namespace {
+
+const char MAGIC[8] = {'I', 'A', 'O', 'M', 'E', 'S', 'H', '\0'};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t flags;
+    uint32_t reserved;
+    uint64_t sourceSize;
+    int64_t sourceMtime;
+    uint64_t sourceHash;
+    uint64_t mtlSize;
+    int64_t mtlMtime;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t materialCount;
+    uint32_t stringBytes;
+    uint32_t meshletCount;
+    uint32_t lodCount;
+    uint32_t subMeshCount;
+    float bounds[6];
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint64_t meshletOffset;
+    uint64_t lodOffset;
+    uint64_t subMeshOffset;
+};
+
+// Subtracting instead of adding the offset cannot wrap, so a corrupt header cannot slip past the check
+bool inRange(uint64_t offset, uint64_t count, uint64_t total) {
+    return offset <= total && count <= total - offset;
+}
+
+void appendString(std::vector<char>& out, const std::string& value) {
+    uint32_t length = static_cast<uint32_t>(value.size());
+    const char* lengthBytes = reinterpret_cast<const char*>(&length);
+    out.insert(out.end(), lengthBytes, lengthBytes + sizeof(length));
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+void appendFloats(std::vector<char>& out, const float* values, size_t count) {
+    const char* bytes = reinterpret_cast<const char*>(values);
+    out.insert(out.end(), bytes, bytes + count * sizeof(float));
+}
+
+bool readFloats(const char*& p, const char* end, float* values, size_t count) {
+    if (end - p < static_cast<ptrdiff_t>(count * sizeof(float))) return false;
+    std::memcpy(values, p, count * sizeof(float));
+    p += count * sizeof(float);
+    return true;
+}
+
+bool readString(const char*& p, const char* end, std::string& value) {
+    uint32_t length;
+    if (end - p < static_cast<ptrdiff_t>(sizeof(length))) return false;
+    std::memcpy(&length, p, sizeof(length));
+    p += sizeof(length);
+    if (end - p < static_cast<ptrdiff_t>(length)) return false;
+    value.assign(p, length);
+    p += length;
+    return true;
+}
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+MeshCache::MeshCache()
+    : m_vertices(nullptr), m_vertexCount(0), m_indices(nullptr), m_indexCount(0),
+      m_meshlets(nullptr), m_meshletCount(0), m_lods(nullptr), m_lodCount(0),
+      m_subMeshes(nullptr), m_subMeshCount(0), m_needsRefresh(false) {
+    std::memset(m_bounds, 0, sizeof(m_bounds));
+}
+
+std::string MeshCache::getCachePath(const std::string& sourcePath) {
+    return sourcePath + ".meshcache";
+}
+
+void MeshCache::close() {
+    m_file.close();
+    m_vertices = nullptr;
+    m_vertexCount = 0;
+    m_indices = nullptr;
+    m_indexCount = 0;
+    m_meshlets = nullptr;
+    m_meshletCount = 0;
+    m_lods = nullptr;
+    m_lodCount = 0;
+    m_subMeshes = nullptr;
+    m_subMeshCount = 0;
+    m_materials.clear();
+    m_mtlPath.clear();
+    m_needsRefresh = false;
+}
+
+bool MeshCache::open(const std::string& sourcePath, uint32_t flags) {
+    close();
+
+    FileStamp sourceStamp = FileUtils::getStamp(sourcePath);
+    if (!sourceStamp.valid || !m_file.open(getCachePath(sourcePath))) {
+        return false;
+    }
+
+    const char* data = m_file.data();
+    Header header;
+    if (m_file.size() < sizeof(Header)) {
+        close();
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(Header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.headerSize != sizeof(Header) || header.flags != flags) {
+        close();
+        return false;
+    }
+
+    // Strings: source path, MTL path, then name, diffuse map and Kd/Ks/Ns per material
+    if (!inRange(sizeof(Header), header.stringBytes, m_file.size())) {
+        close();
+        return false;
+    }
+    const char* p = data + sizeof(Header);
+    const char* stringsEnd = p + header.stringBytes;
+    std::string storedSource;
+    if (!readString(p, stringsEnd, storedSource) ||
+        !readString(p, stringsEnd, m_mtlPath) || storedSource != sourcePath) {
+        close();
+        return false;
+    }
+    m_materials.resize(header.materialCount);
+    for (Material& material : m_materials) {
+        if (!readString(p, stringsEnd, material.name) || !readString(p, stringsEnd, material.diffuseMap) ||
+            !readFloats(p, stringsEnd, material.diffuse, 3) || !readFloats(p, stringsEnd, material.specular, 3) ||
+            !readFloats(p, stringsEnd, &material.shininess, 1)) {
+            close();
+            return false;
+        }
+    }
+
+    size_t vertexBytes = static_cast<size_t>(header.vertexCount) * sizeof(Vertex);
+    size_t indexBytes = static_cast<size_t>(header.indexCount) * sizeof(unsigned int);
+    size_t meshletBytes = static_cast<size_t>(header.meshletCount) * sizeof(Meshlet);
+    size_t lodBytes = static_cast<size_t>(header.lodCount) * sizeof(MeshLod);
+    size_t subMeshBytes = static_cast<size_t>(header.subMeshCount) * sizeof(SubMesh);
+    if (!inRange(header.vertexOffset, vertexBytes, m_file.size()) ||
+        !inRange(header.indexOffset, indexBytes, m_file.size()) ||
+        !inRange(header.meshletOffset, meshletBytes, m_file.size()) ||
+        !inRange(header.lodOffset, lodBytes, m_file.size()) ||
+        !inRange(header.subMeshOffset, subMeshBytes, m_file.size()) ||
+        header.vertexOffset % alignof(Vertex) != 0 || header.indexOffset % alignof(unsigned int) != 0 ||
+        header.meshletOffset % alignof(Meshlet) != 0 || header.lodOffset % alignof(MeshLod) != 0 ||
+        header.subMeshOffset % alignof(SubMesh) != 0) {
+        close();
+        return false;
+    }
+
+    // The MTL only contributes the material table, so a stamp check is enough
+    if (!m_mtlPath.empty()) {
+        FileStamp mtlStamp = FileUtils::getStamp(m_mtlPath);
+        if (!mtlStamp.valid || mtlStamp.size != header.mtlSize || mtlStamp.mtimeNs != header.mtlMtime) {
+            close();
+            return false;
+        }
+    }
+
+    // Same size and mtime is trusted; otherwise fall back to the content hash
+    if (sourceStamp.size != header.sourceSize || sourceStamp.mtimeNs != header.sourceMtime) {
+        uint64_t hash = 0;
+        if (sourceStamp.size != header.sourceSize || !FileUtils::hashFile(sourcePath, hash) ||
+            hash != header.sourceHash) {
+            close();
+            return false;
+        }
+        m_needsRefresh = true;
+    }
+
+    // An index past the vertex array would make the GPU read beyond the vertex buffer
+    const unsigned int* indices = reinterpret_cast<const unsigned int*>(data + header.indexOffset);
+    for (size_t i = 0; i < header.indexCount; i++) {
+        if (indices[i] >= header.vertexCount) {
+            close();
+            return false;
+        }
+    }
+
+    // Model indexes its tables with these ranges unchecked, so any that points outside them rejects the file
+    const Meshlet* meshlets = reinterpret_cast<const Meshlet*>(data + header.meshletOffset);
+    for (size_t i = 0; i < header.meshletCount; i++) {
+        if (!inRange(meshlets[i].indexOffset, meshlets[i].indexCount, header.indexCount)) {
+            close();
+            return false;
+        }
+    }
+    const MeshLod* lods = reinterpret_cast<const MeshLod*>(data + header.lodOffset);
+    for (size_t i = 0; i < header.lodCount; i++) {
+        if (!inRange(lods[i].indexOffset, lods[i].indexCount, header.indexCount) ||
+            !inRange(lods[i].firstSubMesh, lods[i].subMeshCount, header.subMeshCount)) {
+            close();
+            return false;
+        }
+    }
+    const SubMesh* subMeshes = reinterpret_cast<const SubMesh*>(data + header.subMeshOffset);
+    for (size_t i = 0; i < header.subMeshCount; i++) {
+        if (!inRange(subMeshes[i].indexOffset, subMeshes[i].indexCount, header.indexCount) ||
+            subMeshes[i].material >= header.materialCount ||
+            !inRange(subMeshes[i].meshletOffset, subMeshes[i].meshletCount, header.meshletCount)) {
+            close();
+            return false;
+        }
+    }
+
+    m_vertices = reinterpret_cast<const Vertex*>(data + header.vertexOffset);
+    m_vertexCount = header.vertexCount;
+    m_indices = indices;
+    m_indexCount = header.indexCount;
+    if (header.meshletCount > 0) {
+        m_meshlets = meshlets;
+        m_meshletCount = header.meshletCount;
+    }
+    if (header.lodCount > 0) {
+        m_lods = lods;
+        m_lodCount = header.lodCount;
+    }
+    if (header.subMeshCount > 0) {
+        m_subMeshes = subMeshes;
+        m_subMeshCount = header.subMeshCount;
+    }
+    std::memcpy(m_bounds, header.bounds, sizeof(m_bounds));
+    return true;
+}
+
+bool MeshCache::write(const std::string& sourcePath, const Contents& contents) {
+    if (!contents.vertices || !contents.indices || !contents.materials) {
+        return false;
+    }
+
+    FileStamp sourceStamp = FileUtils::getStamp(sourcePath);
+    uint64_t sourceHash = 0;
+    if (!sourceStamp.valid || !FileUtils::hashFile(sourcePath, sourceHash)) {
+        return false;
+    }
+    FileStamp mtlStamp;
+    if (!contents.mtlPath.empty()) {
+        mtlStamp = FileUtils::getStamp(contents.mtlPath);
+    }
+
+    std::vector<char> strings;
+    appendString(strings, sourcePath);
+    appendString(strings, contents.mtlPath);
+    for (const Material& material : *contents.materials) {
+        appendString(strings, material.name);
+        appendString(strings, material.diffuseMap);
+        appendFloats(strings, material.diffuse, 3);
+        appendFloats(strings, material.specular, 3);
+        appendFloats(strings, &material.shininess, 1);
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.headerSize = sizeof(Header);
+    header.flags = contents.flags;
+    header.sourceSize = sourceStamp.size;
+    header.sourceMtime = sourceStamp.mtimeNs;
+    header.sourceHash = sourceHash;
+    header.mtlSize = mtlStamp.size;
+    header.mtlMtime = mtlStamp.mtimeNs;
+    header.vertexCount = static_cast<uint32_t>(contents.vertices->size());
+    header.indexCount = static_cast<uint32_t>(contents.indices->size());
+    header.materialCount = static_cast<uint32_t>(contents.materials->size());
+    header.stringBytes = static_cast<uint32_t>(strings.size());
+    header.meshletCount = contents.meshlets ? static_cast<uint32_t>(contents.meshlets->size()) : 0;
+    header.lodCount = contents.lods ? static_cast<uint32_t>(contents.lods->size()) : 0;
+    header.subMeshCount = contents.subMeshes ? static_cast<uint32_t>(contents.subMeshes->size()) : 0;
+    std::memcpy(header.bounds, contents.bounds, sizeof(header.bounds));
+
+    size_t vertexBytes = contents.vertices->size() * sizeof(Vertex);
+    size_t indexBytes = contents.indices->size() * sizeof(unsigned int);
+    header.vertexOffset = alignUp(sizeof(Header) + strings.size(), 16);
+    size_t meshletBytes = header.meshletCount * sizeof(Meshlet);
+    size_t lodBytes = header.lodCount * sizeof(MeshLod);
+    size_t subMeshBytes = header.subMeshCount * sizeof(SubMesh);
+    header.indexOffset = alignUp(header.vertexOffset + vertexBytes, 16);
+    header.meshletOffset = alignUp(header.indexOffset + indexBytes, 16);
+    header.lodOffset = alignUp(header.meshletOffset + meshletBytes, 16);
+    header.subMeshOffset = alignUp(header.lodOffset + lodBytes, 16);
+
+    std::vector<char> buffer(header.subMeshOffset + subMeshBytes, 0);
+    std::memcpy(buffer.data(), &header, sizeof(Header));
+    std::memcpy(buffer.data() + sizeof(Header), strings.data(), strings.size());
+    if (vertexBytes > 0) {
+        std::memcpy(buffer.data() + header.vertexOffset, contents.vertices->data(), vertexBytes);
+    }
+    if (indexBytes > 0) {
+        std::memcpy(buffer.data() + header.indexOffset, contents.indices->data(), indexBytes);
+    }
+    if (meshletBytes > 0) {
+        std::memcpy(buffer.data() + header.meshletOffset, contents.meshlets->data(), meshletBytes);
+    }
+    if (lodBytes > 0) {
+        std::memcpy(buffer.data() + header.lodOffset, contents.lods->data(), lodBytes);
+    }
+    if (subMeshBytes > 0) {
+        std::memcpy(buffer.data() + header.subMeshOffset, contents.subMeshes->data(), subMeshBytes);
+    }
+
+    return FileUtils::writeAtomic(getCachePath(sourcePath), buffer.data(), buffer.size());
+}
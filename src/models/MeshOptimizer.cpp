@@ -0,0 +1,338 @@
+#include "models/MeshOptimizer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+
+namespace {
+
+// Forsyth's scoring parameters
+constexpr int FORSYTH_CACHE_SIZE = 32;
+constexpr float CACHE_DECAY_POWER = 1.5f;
+constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+constexpr float VALENCE_BOOST_SCALE = 2.0f;
+constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+float vertexScore(int cachePosition, unsigned int remainingTriangles) {
+    if (remainingTriangles == 0) {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            // The vertices of the last triangle get a fixed score so that
+            // immediately reusing them is not favoured over the rest of the cache
+            score = LAST_TRIANGLE_SCORE;
+        } else {
+            float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+            score = std::pow(1.0f - (cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+        }
+    }
+
+    // Boost vertices with few triangles left so they get finished off
+    score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+    return score;
+}
+
+void triangleCentroidAndNormal(const std::vector<Vertex>& vertices, const unsigned int* tri,
+                               float* centroid, float* normal, float& area) {
+    const float* a = vertices[tri[0]].position;
+    const float* b = vertices[tri[1]].position;
+    const float* c = vertices[tri[2]].position;
+
+    float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+    area = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+    for (int i = 0; i < 3; i++) {
+        centroid[i] = (a[i] + b[i] + c[i]) / 3.0f;
+    }
+}
+
+} // namespace
+
+VertexCacheStats MeshOptimizer::analyzeVertexCache(const std::vector<unsigned int>& indices,
+                                                   size_t vertexCount, unsigned int cacheSize) {
+    VertexCacheStats stats;
+    if (indices.empty() || vertexCount == 0) {
+        return stats;
+    }
+
+    // FIFO cache: a vertex is a hit if it entered the cache less than cacheSize misses ago
+    std::vector<size_t> entryTime(vertexCount, 0);
+    size_t time = cacheSize + 1;
+    for (unsigned int index : indices) {
+        if (time - entryTime[index] > cacheSize) {
+            entryTime[index] = time++;
+            stats.transformedVertices++;
+        }
+    }
+
+    stats.acmr = static_cast<float>(stats.transformedVertices) / (indices.size() / 3);
+    stats.atvr = static_cast<float>(stats.transformedVertices) / vertexCount;
+    return stats;
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // Vertex -> triangle adjacency in compressed rows; the live part of each
+    // row shrinks as triangles are emitted
+    std::vector<unsigned int> remaining(vertexCount, 0);
+    for (unsigned int index : indices) {
+        remaining[index]++;
+    }
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++) {
+        offsets[v + 1] = offsets[v] + remaining[v];
+    }
+    std::vector<unsigned int> adjacency(indices.size());
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t t = 0; t < triangleCount; t++) {
+        for (int k = 0; k < 3; k++) {
+            unsigned int v = indices[t * 3 + k];
+            adjacency[fill[v]++] = static_cast<unsigned int>(t);
+        }
+    }
+
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        vertexScores[v] = vertexScore(-1, remaining[v]);
+    }
+
+    std::vector<float> triangleScores(triangleCount);
+    for (size_t t = 0; t < triangleCount; t++) {
+        triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] +
+                            vertexScores[indices[t * 3 + 2]];
+    }
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+
+    unsigned int cache[FORSYTH_CACHE_SIZE + 3];
+    unsigned int newCache[FORSYTH_CACHE_SIZE + 3];
+    int cacheCount = 0;
+
+    size_t bestTriangle = static_cast<size_t>(
+        std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin());
+    size_t fallbackCursor = 0;
+
+    for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+        if (bestTriangle == SIZE_MAX) {
+            // Nothing useful in the cache; continue with the next triangle in input order
+            while (emitted[fallbackCursor]) fallbackCursor++;
+            bestTriangle = fallbackCursor;
+        }
+
+        const unsigned int* tri = &indices[bestTriangle * 3];
+        output.insert(output.end(), tri, tri + 3);
+        emitted[bestTriangle] = true;
+
+        // Remove the triangle from its vertices' adjacency rows
+        for (int k = 0; k < 3; k++) {
+            unsigned int v = tri[k];
+            unsigned int* row = &adjacency[offsets[v]];
+            for (unsigned int i = 0; i < remaining[v]; i++) {
+                if (row[i] == bestTriangle) {
+                    std::swap(row[i], row[remaining[v] - 1]);
+                    break;
+                }
+            }
+            remaining[v]--;
+        }
+
+        // Move the triangle's vertices to the front of the LRU cache
+        int newCount = 0;
+        for (int k = 0; k < 3; k++) {
+            newCache[newCount++] = tri[k];
+        }
+        for (int i = 0; i < cacheCount; i++) {
+            unsigned int v = cache[i];
+            if (v != tri[0] && v != tri[1] && v != tri[2]) {
+                newCache[newCount++] = v;
+            }
+        }
+
+        // Rescore everything that is (or just fell out of) the cache
+        for (int i = 0; i < newCount; i++) {
+            unsigned int v = newCache[i];
+            int position = i < FORSYTH_CACHE_SIZE ? i : -1;
+
+            float score = vertexScore(position, remaining[v]);
+            float delta = score - vertexScores[v];
+            vertexScores[v] = score;
+            for (unsigned int j = 0; j < remaining[v]; j++) {
+                triangleScores[adjacency[offsets[v] + j]] += delta;
+            }
+        }
+        cacheCount = std::min(newCount, FORSYTH_CACHE_SIZE);
+        for (int i = 0; i < cacheCount; i++) {
+            cache[i] = newCache[i];
+        }
+
+        // The next triangle is the best one touching the cache
+        bestTriangle = SIZE_MAX;
+        float bestScore = -1.0f;
+        for (int i = 0; i < cacheCount; i++) {
+            unsigned int v = cache[i];
+            for (unsigned int j = 0; j < remaining[v]; j++) {
+                unsigned int t = adjacency[offsets[v] + j];
+                if (triangleScores[t] > bestScore) {
+                    bestScore = triangleScores[t];
+                    bestTriangle = t;
+                }
+            }
+        }
+    }
+
+    indices.swap(output);
+}
+
+size_t MeshOptimizer::optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices,
+                                       float threshold) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return 0;
+    }
+
+    VertexCacheStats meshStats = analyzeVertexCache(indices, vertices.size());
+
+    // Hard boundaries where the simulated cache misses on all three vertices
+    // (the cache effectively restarts there), plus soft boundaries where the
+    // cluster so far is already within threshold of the mesh's ACMR
+    std::vector<size_t> clusterStarts;
+    std::vector<size_t> entryTime(vertices.size(), 0);
+    size_t time = SIMULATED_CACHE_SIZE + 1;
+    size_t clusterMisses = 0;
+    size_t clusterStart = 0;
+    for (size_t t = 0; t < triangleCount; t++) {
+        int misses = 0;
+        for (int k = 0; k < 3; k++) {
+            unsigned int v = indices[t * 3 + k];
+            if (time - entryTime[v] > SIMULATED_CACHE_SIZE) {
+                entryTime[v] = time++;
+                misses++;
+            }
+        }
+
+        bool hardBoundary = misses == 3;
+        bool softBoundary = false;
+        if (t > clusterStart && misses >= 2) {
+            float clusterACMR = static_cast<float>(clusterMisses) / (t - clusterStart);
+            softBoundary = clusterACMR <= threshold * meshStats.acmr;
+        }
+        if (t == 0 || hardBoundary || softBoundary) {
+            clusterStarts.push_back(t);
+            clusterStart = t;
+            clusterMisses = 0;
+        }
+        clusterMisses += misses;
+    }
+    clusterStarts.push_back(triangleCount);
+    const size_t clusterCount = clusterStarts.size() - 1;
+
+    // Area-weighted centroid and normal per cluster and for the whole mesh
+    std::vector<float> clusterData(clusterCount * 6, 0.0f);
+    std::vector<float> clusterArea(clusterCount, 0.0f);
+    float meshCentroid[3] = {0.0f, 0.0f, 0.0f};
+    float meshArea = 0.0f;
+    for (size_t c = 0; c < clusterCount; c++) {
+        float* centroid = &clusterData[c * 6];
+        float* normal = &clusterData[c * 6 + 3];
+        for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++) {
+            float triCentroid[3], triNormal[3], area;
+            triangleCentroidAndNormal(vertices, &indices[t * 3], triCentroid, triNormal, area);
+            for (int i = 0; i < 3; i++) {
+                centroid[i] += triCentroid[i] * area;
+                normal[i] += triNormal[i];
+                meshCentroid[i] += triCentroid[i] * area;
+            }
+            clusterArea[c] += area;
+        }
+        meshArea += clusterArea[c];
+    }
+    if (meshArea > 0.0f) {
+        for (int i = 0; i < 3; i++) meshCentroid[i] /= meshArea;
+    }
+
+    // Clusters that face away from the mesh centre occlude the rest, so draw them first
+    std::vector<float> sortKeys(clusterCount, 0.0f);
+    for (size_t c = 0; c < clusterCount; c++) {
+        float* centroid = &clusterData[c * 6];
+        float* normal = &clusterData[c * 6 + 3];
+        float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (clusterArea[c] <= 0.0f || length <= 0.0f) continue;
+        float key = 0.0f;
+        for (int i = 0; i < 3; i++) {
+            key += (centroid[i] / clusterArea[c] - meshCentroid[i]) * (normal[i] / length);
+        }
+        sortKeys[c] = key;
+    }
+
+    std::vector<size_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&sortKeys](size_t a, size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    for (size_t c : order) {
+        output.insert(output.end(), indices.begin() + clusterStarts[c] * 3,
+                      indices.begin() + clusterStarts[c + 1] * 3);
+    }
+    indices.swap(output);
+    return clusterCount;
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+    const unsigned int unassigned = 0xFFFFFFFFu;
+    std::vector<unsigned int> remap(vertices.size(), unassigned);
+    std::vector<Vertex> reordered;
+    reordered.reserve(vertices.size());
+
+    for (unsigned int& index : indices) {
+        if (remap[index] == unassigned) {
+            remap[index] = static_cast<unsigned int>(reordered.size());
+            reordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(reordered);
+}
+
+MeshOptimizationStats MeshOptimizer::optimize(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+    std::vector<SubMesh> whole(1, {0, static_cast<uint32_t>(indices.size()), 0, 0, 0});
+    return optimize(vertices, indices, whole);
+}
+
+MeshOptimizationStats MeshOptimizer::optimize(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices,
+                                              const std::vector<SubMesh>& subMeshes) {
+    auto start = std::chrono::steady_clock::now();
+
+    MeshOptimizationStats stats;
+    stats.before = analyzeVertexCache(indices, vertices.size());
+
+    std::vector<unsigned int> range;
+    for (const SubMesh& subMesh : subMeshes) {
+        auto first = indices.begin() + subMesh.indexOffset;
+        range.assign(first, first + subMesh.indexCount);
+        optimizeVertexCache(range, vertices.size());
+        stats.clusterCount += optimizeOverdraw(range, vertices);
+        std::copy(range.begin(), range.end(), first);
+    }
+    optimizeVertexFetch(vertices, indices);
+
+    stats.after = analyzeVertexCache(indices, vertices.size());
+    stats.timeMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
@@ -0,0 +1,252 @@
+#include "models/MeshSimplifier.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+constexpr uint32_t INVALID = std::numeric_limits<uint32_t>::max();
+
+// Symmetric 4x4 matrix: xx, xy, xz, xw, yy, yz, yw, zz, zw, ww
+struct Quadric {
+    double m[10] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    double weight = 0.0;
+
+    void addPlane(const double* n, double d, double w) {
+        m[0] += w * n[0] * n[0]; m[1] += w * n[0] * n[1]; m[2] += w * n[0] * n[2]; m[3] += w * n[0] * d;
+        m[4] += w * n[1] * n[1]; m[5] += w * n[1] * n[2]; m[6] += w * n[1] * d;
+        m[7] += w * n[2] * n[2]; m[8] += w * n[2] * d;
+        m[9] += w * d * d;
+        weight += w;
+    }
+
+    void add(const Quadric& other) {
+        for (int i = 0; i < 10; i++) m[i] += other.m[i];
+        weight += other.weight;
+    }
+};
+
+// Area-weighted mean squared distance to the accumulated planes
+double evaluate(const Quadric& a, const Quadric& b, const float* p) {
+    double x = p[0], y = p[1], z = p[2];
+    double m[10];
+    for (int i = 0; i < 10; i++) m[i] = a.m[i] + b.m[i];
+    double error = m[0] * x * x + 2 * m[1] * x * y + 2 * m[2] * x * z + 2 * m[3] * x +
+                   m[4] * y * y + 2 * m[5] * y * z + 2 * m[6] * y +
+                   m[7] * z * z + 2 * m[8] * z + m[9];
+    double weight = a.weight + b.weight;
+    return weight > 0.0 ? std::fabs(error) / weight : 0.0;
+}
+
+void triangleNormal(const float* a, const float* b, const float* c, double* n) {
+    double e1[3] = {double(b[0]) - a[0], double(b[1]) - a[1], double(b[2]) - a[2]};
+    double e2[3] = {double(c[0]) - a[0], double(c[1]) - a[1], double(c[2]) - a[2]};
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+struct Collapse {
+    uint32_t from;
+    uint32_t to;
+    double cost;
+};
+
+} // namespace
+
+float MeshSimplifier::simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                               size_t targetIndexCount, float maxError, std::vector<unsigned int>& out) {
+    out = indices;
+    size_t vertexCount = vertices.size();
+    if (indices.size() <= targetIndexCount || vertexCount == 0) {
+        return 0.0f;
+    }
+
+    // Vertices sharing a position form one topological vertex; more than one means a UV seam
+    std::vector<uint32_t> order(vertexCount);
+    std::iota(order.begin(), order.end(), 0u);
+    auto positionLess = [&](uint32_t a, uint32_t b) {
+        return std::memcmp(vertices[a].position, vertices[b].position, sizeof(vertices[a].position)) < 0;
+    };
+    std::sort(order.begin(), order.end(), positionLess);
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<uint8_t> locked(vertexCount, 0);
+    for (size_t i = 0; i < vertexCount;) {
+        size_t j = i + 1;
+        while (j < vertexCount && !positionLess(order[i], order[j])) j++;
+        for (size_t k = i; k < j; k++) {
+            remap[order[k]] = order[i];
+        }
+        if (j - i > 1) {
+            locked[order[i]] = 1;
+        }
+        i = j;
+    }
+
+    // Border and non-manifold edges lock their endpoints
+    std::vector<uint64_t> edges;
+    edges.reserve(indices.size());
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        for (int k = 0; k < 3; k++) {
+            uint64_t a = remap[indices[i + k]];
+            uint64_t b = remap[indices[i + (k + 1) % 3]];
+            if (a == b) continue;
+            edges.push_back(a < b ? (a << 32 | b) : (b << 32 | a));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    for (size_t i = 0; i < edges.size();) {
+        size_t j = i + 1;
+        while (j < edges.size() && edges[j] == edges[i]) j++;
+        if (j - i != 2) {
+            locked[edges[i] >> 32] = 1;
+            locked[edges[i] & 0xFFFFFFFFu] = 1;
+        }
+        i = j;
+    }
+
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        uint32_t tri[3] = {remap[indices[i]], remap[indices[i + 1]], remap[indices[i + 2]]};
+        double n[3];
+        triangleNormal(vertices[tri[0]].position, vertices[tri[1]].position, vertices[tri[2]].position, n);
+        double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length <= 0.0) continue;
+        for (double& value : n) value /= length;
+        const float* p = vertices[tri[0]].position;
+        double d = -(n[0] * p[0] + n[1] * p[1] + n[2] * p[2]);
+        for (uint32_t v : tri) {
+            quadrics[v].addPlane(n, d, length * 0.5);
+        }
+    }
+
+    double maxCost = double(maxError) * maxError;
+    double resultCost = 0.0;
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> collapseTarget(vertexCount, INVALID);
+    std::vector<uint8_t> touched(vertexCount, 0);
+
+    while (out.size() > targetIndexCount) {
+        size_t triangleCount = out.size() / 3;
+
+        // Topological vertex -> triangle adjacency of the current mesh
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0u);
+        for (unsigned int index : out) {
+            adjacencyOffsets[remap[index] + 1]++;
+        }
+        for (size_t v = 0; v < vertexCount; v++) {
+            adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+        }
+        adjacency.resize(out.size());
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t t = 0; t < triangleCount; t++) {
+            for (int k = 0; k < 3; k++) {
+                adjacency[fill[remap[out[t * 3 + k]]]++] = static_cast<uint32_t>(t);
+            }
+        }
+
+        // Cheapest allowed direction of every edge
+        collapses.clear();
+        for (size_t t = 0; t < triangleCount; t++) {
+            for (int k = 0; k < 3; k++) {
+                uint32_t a = remap[out[t * 3 + k]];
+                uint32_t b = remap[out[t * 3 + (k + 1) % 3]];
+                if (a > b) continue;
+                Collapse best = {INVALID, INVALID, 0.0};
+                if (!locked[a]) {
+                    best = {a, b, evaluate(quadrics[a], quadrics[b], vertices[b].position)};
+                }
+                if (!locked[b]) {
+                    double cost = evaluate(quadrics[a], quadrics[b], vertices[a].position);
+                    if (best.from == INVALID || cost < best.cost) best = {b, a, cost};
+                }
+                if (best.from != INVALID && best.cost <= maxCost) {
+                    collapses.push_back(best);
+                }
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+        // Apply an independent set of collapses that keeps every triangle facing the same way
+        std::fill(touched.begin(), touched.end(), 0);
+        size_t trianglesToRemove = (out.size() - targetIndexCount) / 3 + 1;
+        size_t removed = 0;
+        size_t applied = 0;
+        for (const Collapse& collapse : collapses) {
+            if (removed >= trianglesToRemove) break;
+            if (touched[collapse.from] || touched[collapse.to]) continue;
+
+            bool valid = true;
+            uint32_t wedge = INVALID;
+            size_t degenerate = 0;
+            const float* target = vertices[collapse.to].position;
+            for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1] && valid; a++) {
+                const unsigned int* tri = &out[adjacency[a] * 3];
+                bool containsTarget = false;
+                for (int k = 0; k < 3; k++) {
+                    if (remap[tri[k]] == collapse.to) {
+                        containsTarget = true;
+                        wedge = tri[k];
+                    }
+                }
+                if (containsTarget) {
+                    degenerate++;
+                    continue;
+                }
+
+                const float* before[3];
+                const float* after[3];
+                for (int k = 0; k < 3; k++) {
+                    before[k] = vertices[remap[tri[k]]].position;
+                    after[k] = remap[tri[k]] == collapse.from ? target : before[k];
+                }
+                double n0[3], n1[3];
+                triangleNormal(before[0], before[1], before[2], n0);
+                triangleNormal(after[0], after[1], after[2], n1);
+                if (n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2] <= 0.0) {
+                    valid = false;
+                }
+            }
+            if (!valid || wedge == INVALID) continue;
+
+            collapseTarget[collapse.from] = wedge;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            resultCost = std::max(resultCost, collapse.cost);
+            removed += degenerate;
+            applied++;
+
+            // Lock the neighbourhood for the rest of the pass so the flip checks stay valid
+            touched[collapse.to] = 1;
+            for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1]; a++) {
+                const unsigned int* tri = &out[adjacency[a] * 3];
+                for (int k = 0; k < 3; k++) touched[remap[tri[k]]] = 1;
+            }
+        }
+        if (applied == 0) break;
+
+        // Rewrite the triangles and drop the ones that collapsed to a line
+        size_t write = 0;
+        for (size_t t = 0; t < triangleCount; t++) {
+            unsigned int tri[3];
+            for (int k = 0; k < 3; k++) {
+                unsigned int index = out[t * 3 + k];
+                uint32_t redirected = collapseTarget[remap[index]];
+                tri[k] = redirected != INVALID ? redirected : index;
+            }
+            if (remap[tri[0]] == remap[tri[1]] || remap[tri[1]] == remap[tri[2]] || remap[tri[0]] == remap[tri[2]]) {
+                continue;
+            }
+            for (int k = 0; k < 3; k++) out[write++] = tri[k];
+        }
+        out.resize(write);
+        std::fill(collapseTarget.begin(), collapseTarget.end(), INVALID);
+    }
+
+    return static_cast<float>(std::sqrt(resultCost));
+}
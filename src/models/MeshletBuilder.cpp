@@ -0,0 +1,226 @@
+#include "models/MeshletBuilder.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr uint32_t INVALID = std::numeric_limits<uint32_t>::max();
+
+// Normal cones wider than this (dot with the axis) cannot reject anything useful
+constexpr float MIN_CONE_DOT = 0.1f;
+
+float distanceSquared(const float* a, const float* b) {
+    float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+    return dx * dx + dy * dy + dz * dz;
+}
+
+} // namespace
+
+void MeshletBuilder::build(const std::vector<Vertex>& vertices, std::vector<unsigned int>& indices,
+                           std::vector<Meshlet>& meshlets, size_t maxVertices, size_t maxTriangles) {
+    meshlets.clear();
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || maxVertices < 3 || maxTriangles == 0) {
+        return;
+    }
+
+    // Vertex -> triangle adjacency in compressed rows
+    std::vector<uint32_t> adjacencyOffsets(vertices.size() + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++) {
+        adjacencyOffsets[indices[i] + 1]++;
+    }
+    for (size_t v = 0; v < vertices.size(); v++) {
+        adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+    }
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t t = 0; t < triangleCount; t++) {
+        for (int k = 0; k < 3; k++) {
+            adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+        }
+    }
+
+    std::vector<unsigned int> reordered;
+    reordered.reserve(triangleCount * 3);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> vertexMeshlet(vertices.size(), INVALID);
+    std::vector<uint32_t> meshletVertices;
+    meshletVertices.reserve(maxVertices);
+
+    uint32_t meshletId = 0;
+    size_t meshletStart = 0;
+    size_t meshletTriangles = 0;
+    size_t seed = 0;
+    uint32_t lastTriangle = INVALID;
+
+    auto newVertexCount = [&](uint32_t t) {
+        size_t count = 0;
+        for (int k = 0; k < 3; k++) {
+            if (vertexMeshlet[indices[t * 3 + k]] != meshletId) count++;
+        }
+        return count;
+    };
+
+    // Best unemitted neighbour of the given vertices: fewest new vertices, then earliest
+    auto pickNeighbour = [&](const uint32_t* candidates, size_t candidateCount, size_t& bestCost) {
+        uint32_t best = INVALID;
+        for (size_t i = 0; i < candidateCount; i++) {
+            uint32_t v = candidates[i];
+            for (uint32_t a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1]; a++) {
+                uint32_t t = adjacency[a];
+                if (emitted[t]) continue;
+                size_t cost = newVertexCount(t);
+                if (best == INVALID || cost < bestCost || (cost == bestCost && t < best)) {
+                    best = t;
+                    bestCost = cost;
+                }
+            }
+        }
+        return best;
+    };
+
+    auto finishMeshlet = [&]() {
+        Meshlet meshlet = {};
+        meshlet.indexOffset = static_cast<uint32_t>(meshletStart);
+        meshlet.indexCount = static_cast<uint32_t>(reordered.size() - meshletStart);
+        meshlet.vertexCount = static_cast<uint32_t>(meshletVertices.size());
+        meshlets.push_back(meshlet);
+
+        meshletStart = reordered.size();
+        meshletTriangles = 0;
+        meshletVertices.clear();
+        lastTriangle = INVALID;
+        meshletId++;
+    };
+
+    for (size_t done = 0; done < triangleCount;) {
+        size_t cost = 0;
+        uint32_t next = INVALID;
+        if (lastTriangle != INVALID) {
+            uint32_t lastVertices[3] = {indices[lastTriangle * 3], indices[lastTriangle * 3 + 1],
+                                        indices[lastTriangle * 3 + 2]};
+            next = pickNeighbour(lastVertices, 3, cost);
+            if (next == INVALID) {
+                next = pickNeighbour(meshletVertices.data(), meshletVertices.size(), cost);
+            }
+        }
+        if (next == INVALID) {
+            while (emitted[seed]) seed++;
+            next = static_cast<uint32_t>(seed);
+            cost = newVertexCount(next);
+        }
+
+        if (meshletTriangles > 0 &&
+            (meshletTriangles == maxTriangles || meshletVertices.size() + cost > maxVertices)) {
+            finishMeshlet();
+            continue;
+        }
+
+        for (int k = 0; k < 3; k++) {
+            unsigned int v = indices[next * 3 + k];
+            if (vertexMeshlet[v] != meshletId) {
+                vertexMeshlet[v] = meshletId;
+                meshletVertices.push_back(v);
+            }
+            reordered.push_back(v);
+        }
+        emitted[next] = 1;
+        lastTriangle = next;
+        meshletTriangles++;
+        done++;
+    }
+    if (meshletTriangles > 0) {
+        finishMeshlet();
+    }
+
+    indices.swap(reordered);
+    for (Meshlet& meshlet : meshlets) {
+        computeBounds(vertices, indices, meshlet);
+    }
+}
+
+void MeshletBuilder::computeBounds(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                                   Meshlet& meshlet) {
+    const unsigned int* first = indices.data() + meshlet.indexOffset;
+    size_t count = meshlet.indexCount;
+    if (count == 0) {
+        return;
+    }
+
+    // Ritter's bounding sphere: start from two far-apart points, then grow
+    const float* a = vertices[first[0]].position;
+    const float* b = a;
+    float maxDistance = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        const float* p = vertices[first[i]].position;
+        float d = distanceSquared(a, p);
+        if (d > maxDistance) {
+            maxDistance = d;
+            b = p;
+        }
+    }
+    const float* c = b;
+    maxDistance = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        const float* p = vertices[first[i]].position;
+        float d = distanceSquared(b, p);
+        if (d > maxDistance) {
+            maxDistance = d;
+            c = p;
+        }
+    }
+
+    float center[3] = {(b[0] + c[0]) * 0.5f, (b[1] + c[1]) * 0.5f, (b[2] + c[2]) * 0.5f};
+    float radius = std::sqrt(maxDistance) * 0.5f;
+    for (size_t i = 0; i < count; i++) {
+        const float* p = vertices[first[i]].position;
+        float d = std::sqrt(distanceSquared(center, p));
+        if (d > radius) {
+            float newRadius = (radius + d) * 0.5f;
+            float shift = (newRadius - radius) / d;
+            for (int axis = 0; axis < 3; axis++) {
+                center[axis] += (p[axis] - center[axis]) * shift;
+            }
+            radius = newRadius;
+        }
+    }
+
+    // Normal cone: average of the unit triangle normals, widened to cover all of them
+    std::vector<float> normals;
+    normals.reserve(count);
+    float axis[3] = {0.0f, 0.0f, 0.0f};
+    for (size_t i = 0; i + 2 < count; i += 3) {
+        const float* p0 = vertices[first[i]].position;
+        const float* p1 = vertices[first[i + 1]].position;
+        const float* p2 = vertices[first[i + 2]].position;
+        float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+        float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+        float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+        float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length <= 0.0f) continue;
+        for (int k = 0; k < 3; k++) {
+            n[k] /= length;
+            axis[k] += n[k];
+            normals.push_back(n[k]);
+        }
+    }
+
+    float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    float minDot = -1.0f;
+    if (axisLength > 0.0f) {
+        minDot = 1.0f;
+        for (int k = 0; k < 3; k++) axis[k] /= axisLength;
+        for (size_t i = 0; i < normals.size(); i += 3) {
+            float d = normals[i] * axis[0] + normals[i + 1] * axis[1] + normals[i + 2] * axis[2];
+            minDot = std::min(minDot, d);
+        }
+    }
+
+    for (int k = 0; k < 3; k++) {
+        meshlet.center[k] = center[k];
+        meshlet.coneAxis[k] = axis[k];
+    }
+    meshlet.radius = radius;
+    meshlet.coneCutoff = minDot > MIN_CONE_DOT ? std::sqrt(1.0f - minDot * minDot) : 1.0f;
+}
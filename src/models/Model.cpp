@@ -1,11 +1,40 @@
 #include "models/Model.hpp"
+#include "models/MeshCache.hpp"
+#include "models/ObjParser.hpp"
+#include "core/AssetCache.hpp"
+#include "core/FileUtils.hpp"
+#include "core/TextureResidencyManager.hpp"
+#include "core/TextureStreamer.hpp"
+#include "core/ThreadPool.hpp"
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstring>
+#include <limits>
+#include <unordered_map>
 
-Model::Model() : m_VAO(0), m_VBO(0), m_EBO(0), m_initialized(false), m_hasTexture(false) {
+namespace {
+
+// Triangle ratios of the generated levels of detail, relative to the full mesh
+const float LOD_RATIOS[] = {0.5f, 0.25f, 0.1f, 0.03f};
+
+// Uniforms set for every sub-mesh, hashed at compile time
+constexpr UniformName UNIFORM_TEXTURE_LAYER("textureLayer");
+constexpr UniformName UNIFORM_LAYER_TRANSFORM("layerTransform");
+constexpr UniformName UNIFORM_MATERIAL_DIFFUSE("materialDiffuse");
+constexpr UniformName UNIFORM_MATERIAL_SPECULAR("materialSpecular");
+constexpr UniformName UNIFORM_MATERIAL_SHININESS("materialShininess");
+
+} // namespace
+
+Model::Model() : m_VAO(0), m_VBO(0), m_EBO(0), m_indexType(GL_UNSIGNED_INT),
+                 m_initialized(false), m_hasTexture(false), m_optimizeOnLoad(true), m_loadTimeMs(0.0),
+                 m_loadedFromCache(false), m_compactVertices(false), m_compact(false),
+                 m_buildMeshlets(false), m_buildLods(true), m_texCoordSpan(0.0f) {
+    std::memset(m_bounds, 0, sizeof(m_bounds));
 }
 
 Model::~Model() {
@@ -29,188 +58,465 @@ void Model::cleanup() {
 }
 
 bool Model::loadFromOBJ(const std::string& filepath) {
+    if (!loadMesh(filepath)) {
+        return false;
+    }
+    upload();
+    return true;
+}
+
+bool Model::loadMesh(const std::string& filepath, const std::atomic<bool>* cancelled) {
+    auto start = std::chrono::steady_clock::now();
+    auto isCancelled = [cancelled]() { return cancelled && cancelled->load(); };
+    
     m_vertices.clear();
     m_indices.clear();
-    m_hasTexture = false;
+    m_meshCache.close();
+    m_meshlets.clear();
+    m_lods.clear();
+    m_materials.clear();
+    m_subMeshes.clear();
+    m_mtlPath.clear();
+    m_decodedImages.clear();
+    m_weldStats = WeldStats();
+    m_optimizationStats = MeshOptimizationStats();
+    m_loadedFromCache = false;
     
-    std::string objDir = extractDirectory(filepath);
-    parseOBJ(filepath);
+    if (loadFromCache(filepath)) {
+        m_loadedFromCache = true;
+    } else {
+        parseOBJ(filepath, cancelled);
+        if (isCancelled()) return false;
+        
+        if (m_vertices.empty()) {
+            std::cerr << "Failed to load model: " << filepath << std::endl;
+            return false;
+        }
+        
+        if (m_buildMeshlets) {
+            buildMeshlets();
+            if (isCancelled()) return false;
+        }
+        buildLods(cancelled);
+        // A cancelled load must not leave a cache for a mesh that was never finished
+        if (isCancelled()) return false;
+        computeBounds();
+        writeCache(filepath);
+    }
+    if (m_meshCache.isOpen()) {
+        computeTexCoordSpan(m_meshCache.getVertices(), m_meshCache.getVertexCount());
+    } else {
+        computeTexCoordSpan(m_vertices.data(), m_vertices.size());
+    }
     
-    if (m_vertices.empty()) {
-        std::cerr << "Failed to load model: " << filepath << std::endl;
+    m_loadTimeMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    std::cout << "Loaded model " << filepath << (m_loadedFromCache ? " from cache" : " from OBJ (cold)")
+              << " in " << m_loadTimeMs << " ms" << std::endl;
+    return true;
+}
+
+void Model::decodeTextures() {
+    // Streamed textures are decoded by TextureStreamer, so the model can be drawn before they are
+    if (Texture::isStreamingEnabled()) return;
+    std::vector<std::string> paths;
+    for (const Material& material : m_materials) {
+        const std::string& path = material.diffuseMap;
+        if (!path.empty() && !m_decodedImages.count(path) &&
+            std::find(paths.begin(), paths.end(), path) == paths.end()) {
+            paths.push_back(path);
+        }
+    }
+    
+    // One image per task; each image also spreads its mip levels over the pool
+    std::vector<TextureImage> images(paths.size());
+    std::vector<char> decoded(paths.size(), 0);
+    ThreadPool::shared().parallelFor(paths.size(), [&](size_t i) {
+        decoded[i] = Texture::decodeFile(paths[i], images[i]);
+    });
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (decoded[i]) {
+            m_decodedImages.emplace(paths[i], std::move(images[i]));
+        }
+    }
+}
+
+void Model::upload() {
+    m_textures.clear();
+    m_materialTextures.clear();
+    m_atlasRegions.clear();
+    m_hasTexture = false;
+    if (m_meshCache.isOpen()) {
+        setupBuffers(m_meshCache.getVertices(), m_meshCache.getVertexCount(), m_meshCache.getIndices(),
+                     m_meshCache.getIndexCount());
+        m_meshCache.close();
+    } else {
+        setupBuffers(m_vertices.data(), m_vertices.size(), m_indices.data(), m_indices.size());
+    }
+    loadTextures();
+}
+
+bool Model::loadFromCache(const std::string& filepath) {
+    MeshCache& cache = m_meshCache;
+    if (!cache.open(filepath, getCacheFlags())) {
+        return false;
+    }
+    
+    // The vertex and index arrays stay in the mapping until upload() hands them to glBufferData;
+    // the small tables are copied because drawing reads them every frame
+    std::memcpy(m_bounds, cache.getBounds(), sizeof(m_bounds));
+    m_meshlets.assign(cache.getMeshlets(), cache.getMeshlets() + cache.getMeshletCount());
+    m_lods.assign(cache.getLods(), cache.getLods() + cache.getLodCount());
+    m_subMeshes.assign(cache.getSubMeshes(), cache.getSubMeshes() + cache.getSubMeshCount());
+    m_materials = cache.getMaterials();
+    if (cache.getVertexCount() == 0 || m_lods.empty() || m_subMeshes.empty() || m_materials.empty()) {
+        cache.close();
+        m_meshlets.clear();
+        m_lods.clear();
+        m_subMeshes.clear();
+        m_materials.clear();
         return false;
     }
+    m_mtlPath = cache.getMtlPath();
     
-    setupBuffers();
+    if (cache.needsRefresh()) {
+        // Rewriting takes the arrays as vectors; this only happens once after the OBJ was touched
+        m_vertices.assign(cache.getVertices(), cache.getVertices() + cache.getVertexCount());
+        m_indices.assign(cache.getIndices(), cache.getIndices() + cache.getIndexCount());
+        cache.close();
+        writeCache(filepath);
+    }
     return true;
 }
 
-void Model::parseOBJ(const std::string& filepath) {
-    std::ifstream file(filepath);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open OBJ file: " << filepath << std::endl;
-        return;
+void Model::writeCache(const std::string& filepath) const {
+    MeshCache::Contents contents;
+    contents.vertices = &m_vertices;
+    contents.indices = &m_indices;
+    contents.materials = &m_materials;
+    contents.meshlets = &m_meshlets;
+    contents.lods = &m_lods;
+    contents.subMeshes = &m_subMeshes;
+    contents.mtlPath = m_mtlPath;
+    contents.flags = getCacheFlags();
+    std::memcpy(contents.bounds, m_bounds, sizeof(m_bounds));
+    
+    if (!MeshCache::write(filepath, contents)) {
+        std::cerr << "Could not write mesh cache: " << MeshCache::getCachePath(filepath) << std::endl;
+    }
+}
+
+uint32_t Model::getCacheFlags() const {
+    uint32_t flags = 0;
+    if (m_optimizeOnLoad) flags |= MeshCache::FLAG_OPTIMIZED;
+    if (m_buildMeshlets) flags |= MeshCache::FLAG_MESHLETS;
+    if (m_buildLods) flags |= MeshCache::FLAG_LODS;
+    return flags;
+}
+
+void Model::groupByMaterial(const ObjData& obj) {
+    // Resolve "usemtl" names against the MTL; unknown names keep the default look
+    std::vector<uint32_t> objMaterials(obj.materialNames.size());
+    for (size_t i = 0; i < obj.materialNames.size(); i++) {
+        auto it = std::find_if(m_materials.begin(), m_materials.end(),
+                               [&](const Material& material) { return material.name == obj.materialNames[i]; });
+        if (it == m_materials.end()) {
+            Material material;
+            material.name = obj.materialNames[i];
+            it = m_materials.insert(m_materials.end(), material);
+        }
+        objMaterials[i] = static_cast<uint32_t>(it - m_materials.begin());
     }
     
-    std::vector<float> positions;
-    std::vector<float> normals;
-    std::vector<float> texCoords;
-    std::vector<std::string> faces;
-    std::string mtlPath;
-    std::string objDir = extractDirectory(filepath);
+    // Triangles before the first "usemtl" get a default material
+    size_t triangleCount = m_indices.size() / 3;
+    bool needsDefault = obj.materialRuns.empty() || (triangleCount > 0 && obj.materialRuns[0].firstCorner > 0);
+    uint32_t defaultMaterial = static_cast<uint32_t>(m_materials.size());
+    if (needsDefault) {
+        m_materials.push_back(Material());
+    }
     
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty() || line[0] == '#') continue;
-        
-        std::istringstream iss(line);
-        std::string type;
-        iss >> type;
+    std::vector<uint32_t> triangleMaterials(triangleCount);
+    std::vector<uint32_t> counts(m_materials.size(), 0);
+    size_t run = 0;
+    uint32_t material = defaultMaterial;
+    for (size_t t = 0; t < triangleCount; t++) {
+        while (run < obj.materialRuns.size() && obj.materialRuns[run].firstCorner <= t * 3) {
+            material = objMaterials[obj.materialRuns[run].material];
+            run++;
+        }
+        triangleMaterials[t] = material;
+        counts[material]++;
+    }
+    
+    // One range per used material, ordered so materials sharing a texture are adjacent
+    std::vector<uint32_t> order;
+    for (uint32_t i = 0; i < m_materials.size(); i++) {
+        if (counts[i] > 0) order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return m_materials[a].diffuseMap < m_materials[b].diffuseMap;
+    });
+    
+    std::vector<uint32_t> writeOffsets(m_materials.size(), 0);
+    uint32_t offset = 0;
+    m_subMeshes.clear();
+    for (uint32_t i : order) {
+        m_subMeshes.push_back({offset, counts[i] * 3, i, 0, 0});
+        writeOffsets[i] = offset;
+        offset += counts[i] * 3;
+    }
+    
+    std::vector<unsigned int> grouped(m_indices.size());
+    for (size_t t = 0; t < triangleCount; t++) {
+        uint32_t& write = writeOffsets[triangleMaterials[t]];
+        std::copy(m_indices.begin() + t * 3, m_indices.begin() + t * 3 + 3, grouped.begin() + write);
+        write += 3;
+    }
+    m_indices.swap(grouped);
+}
+
+void Model::buildMeshlets() {
+    auto start = std::chrono::steady_clock::now();
+    
+    // Meshlets never span materials, so each sub-mesh is partitioned on its own
+    m_meshlets.clear();
+    std::vector<unsigned int> range;
+    std::vector<Meshlet> local;
+    for (SubMesh& subMesh : m_subMeshes) {
+        auto first = m_indices.begin() + subMesh.indexOffset;
+        range.assign(first, first + subMesh.indexCount);
+        MeshletBuilder::build(m_vertices, range, local);
+        std::copy(range.begin(), range.end(), first);
         
-        if (type == "mtllib") {
-            std::string mtlFile;
-            iss >> mtlFile;
-            mtlPath = objDir + "/" + mtlFile;
-        } else if (type == "v") {
-            float x, y, z;
-            if (iss >> x >> y >> z) {
-                positions.push_back(x);
-                positions.push_back(y);
-                positions.push_back(z);
-            }
-        } else if (type == "vn") {
-            float x, y, z;
-            if (iss >> x >> y >> z) {
-                normals.push_back(x);
-                normals.push_back(y);
-                normals.push_back(z);
-            }
-        } else if (type == "vt") {
-            float u, v;
-            if (iss >> u >> v) {
-                texCoords.push_back(u);
-                texCoords.push_back(v);
-            }
-        } else if (type == "f") {
-            faces.push_back(line);
+        subMesh.meshletOffset = static_cast<uint32_t>(m_meshlets.size());
+        subMesh.meshletCount = static_cast<uint32_t>(local.size());
+        for (Meshlet meshlet : local) {
+            meshlet.indexOffset += subMesh.indexOffset;
+            m_meshlets.push_back(meshlet);
         }
     }
     
-    // Parse faces and create vertices
-    for (const auto& face : faces) {
-        std::istringstream iss(face);
-        std::string type;
-        iss >> type; // skip "f"
+    // Meshlet order moves triangles around, so restore linear vertex fetch
+    if (m_optimizeOnLoad) {
+        MeshOptimizer::optimizeVertexFetch(m_vertices, m_indices);
+        for (Meshlet& meshlet : m_meshlets) {
+            MeshletBuilder::computeBounds(m_vertices, m_indices, meshlet);
+        }
+    }
+    
+    double timeMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    std::cout << "Built " << m_meshlets.size() << " meshlets in " << timeMs << " ms" << std::endl;
+}
+
+void Model::buildLods(const std::atomic<bool>* cancelled) {
+    // Level 0 is the full mesh; meshlets, if any, only cover this level
+    size_t fullCount = m_indices.size();
+    m_lods.assign(1, {0, static_cast<uint32_t>(fullCount), 0.0f, 0, static_cast<uint32_t>(m_subMeshes.size())});
+    if (!m_buildLods) return;
+    
+    // Each sub-mesh is simplified on its own, so material boundaries stay locked
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SubMesh> fullSubMeshes(m_subMeshes);
+    std::vector<unsigned int> range;
+    std::vector<unsigned int> simplified;
+    std::vector<unsigned int> levelIndices;
+    std::vector<SubMesh> levelSubMeshes;
+    for (float ratio : LOD_RATIOS) {
+        if (cancelled && *cancelled) return;
+        uint32_t levelOffset = static_cast<uint32_t>(m_indices.size());
+        float levelError = 0.0f;
+        levelIndices.clear();
+        levelSubMeshes.clear();
+        for (const SubMesh& subMesh : fullSubMeshes) {
+            auto first = m_indices.begin() + subMesh.indexOffset;
+            range.assign(first, first + subMesh.indexCount);
+            size_t target = std::max<size_t>(static_cast<size_t>(subMesh.indexCount * ratio) / 3 * 3, 3);
+            float error = MeshSimplifier::simplify(m_vertices, range, target, std::numeric_limits<float>::max(),
+                                                   simplified);
+            MeshOptimizer::optimizeVertexCache(simplified, m_vertices.size());
+            
+            levelSubMeshes.push_back({levelOffset + static_cast<uint32_t>(levelIndices.size()),
+                                      static_cast<uint32_t>(simplified.size()), subMesh.material, 0, 0});
+            levelIndices.insert(levelIndices.end(), simplified.begin(), simplified.end());
+            levelError = std::max(levelError, error);
+        }
         
-        std::vector<Vertex> faceVertices;
-        std::string vertex;
+        // Stop once simplification stalls (locked borders and seams)
+        if (levelIndices.size() > m_lods.back().indexCount * 9 / 10) break;
         
-        // Collect all vertices in the face
-        while (iss >> vertex) {
-            unsigned int posIdx = 0, texIdx = 0, normIdx = 0;
-            
-            // Parse vertex format: pos/tex/norm or pos//norm or pos
-            size_t firstSlash = vertex.find('/');
-            if (firstSlash != std::string::npos) {
-                posIdx = std::stoul(vertex.substr(0, firstSlash)) - 1;
-                
-                size_t secondSlash = vertex.find('/', firstSlash + 1);
-                if (secondSlash != std::string::npos) {
-                    if (secondSlash > firstSlash + 1) {
-                        texIdx = std::stoul(vertex.substr(firstSlash + 1, secondSlash - firstSlash - 1)) - 1;
-                    }
-                    normIdx = std::stoul(vertex.substr(secondSlash + 1)) - 1;
-                } else {
-                    texIdx = std::stoul(vertex.substr(firstSlash + 1)) - 1;
-                }
-            } else {
-                posIdx = std::stoul(vertex) - 1;
-            }
-            
-            // Create vertex
-            Vertex v;
-            if (posIdx * 3 + 2 < positions.size()) {
-                v.position[0] = positions[posIdx * 3];
-                v.position[1] = positions[posIdx * 3 + 1];
-                v.position[2] = positions[posIdx * 3 + 2];
-            }
-            
-            if (normIdx * 3 + 2 < normals.size()) {
-                v.normal[0] = normals[normIdx * 3];
-                v.normal[1] = normals[normIdx * 3 + 1];
-                v.normal[2] = normals[normIdx * 3 + 2];
-            } else {
-                v.normal[0] = 0.0f;
-                v.normal[1] = 1.0f;
-                v.normal[2] = 0.0f;
-            }
-            
-            if (texIdx * 2 + 1 < texCoords.size()) {
-                v.texCoord[0] = texCoords[texIdx * 2];
-                v.texCoord[1] = texCoords[texIdx * 2 + 1];
+        m_lods.push_back({levelOffset, static_cast<uint32_t>(levelIndices.size()), levelError,
+                          static_cast<uint32_t>(m_subMeshes.size()), static_cast<uint32_t>(levelSubMeshes.size())});
+        m_subMeshes.insert(m_subMeshes.end(), levelSubMeshes.begin(), levelSubMeshes.end());
+        m_indices.insert(m_indices.end(), levelIndices.begin(), levelIndices.end());
+    }
+    
+    double timeMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    std::cout << "Built " << m_lods.size() - 1 << " LODs in " << timeMs << " ms:";
+    for (const MeshLod& lod : m_lods) {
+        std::cout << " " << lod.indexCount / 3 << " tris (error " << lod.error << ")";
+    }
+    std::cout << std::endl;
+}
+
+size_t Model::getIndexSize() const {
+    return m_indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+}
+
+void Model::computeBounds() {
+    if (m_vertices.empty()) {
+        std::memset(m_bounds, 0, sizeof(m_bounds));
+        return;
+    }
+    
+    for (int axis = 0; axis < 3; axis++) {
+        m_bounds[axis] = m_bounds[axis + 3] = m_vertices[0].position[axis];
+    }
+    for (const auto& vertex : m_vertices) {
+        for (int axis = 0; axis < 3; axis++) {
+            m_bounds[axis] = std::min(m_bounds[axis], vertex.position[axis]);
+            m_bounds[axis + 3] = std::max(m_bounds[axis + 3], vertex.position[axis]);
+        }
+    }
+}
+
+void Model::computeTexCoordSpan(const Vertex* vertices, size_t vertexCount) {
+    if (vertexCount == 0) {
+        m_texCoordSpan = 0.0f;
+        return;
+    }
+    
+    // On a cache hit this also pages the mapped vertices in before upload() reads them on the GL thread
+    float minUV[2] = {vertices[0].texCoord[0], vertices[0].texCoord[1]};
+    float maxUV[2] = {minUV[0], minUV[1]};
+    for (size_t i = 0; i < vertexCount; i++) {
+        const Vertex& vertex = vertices[i];
+        for (int axis = 0; axis < 2; axis++) {
+            minUV[axis] = std::min(minUV[axis], vertex.texCoord[axis]);
+            maxUV[axis] = std::max(maxUV[axis], vertex.texCoord[axis]);
+        }
+    }
+    m_texCoordSpan = std::max(maxUV[0] - minUV[0], maxUV[1] - minUV[1]);
+}
+
+void Model::setAtlasRegions(const std::vector<AtlasRegion>& regions) {
+    // The atlas holds a copy of every level, so the sources only keep their tail while it is in use
+    bool atlased = !regions.empty();
+    if (atlased != !m_atlasRegions.empty()) {
+        TextureResidencyManager& residency = TextureResidencyManager::shared();
+        for (const auto& texture : m_textures) {
+            if (atlased) {
+                residency.evictToTail(*texture);
             } else {
-                v.texCoord[0] = 0.0f;
-                v.texCoord[1] = 0.0f;
+                residency.restore(*texture);
             }
-            
-            faceVertices.push_back(v);
         }
+    }
+    m_atlasRegions = regions;
+}
+
+void Model::requestTextureLevels(TextureResidencyManager& manager, float pixelsPerUnit) const {
+    if (!m_atlasRegions.empty()) return;
+    float extent = std::max({m_bounds[3] - m_bounds[0], m_bounds[4] - m_bounds[1], m_bounds[5] - m_bounds[2]});
+    for (const auto& texture : m_textures) {
+        // Texels covering one model unit, assuming the UVs spread evenly over the longest axis
+        float texelsPerUnit = std::max(texture->getWidth(), texture->getHeight()) * m_texCoordSpan /
+                              std::max(extent, 1e-6f);
+        int level = 0;
+        if (pixelsPerUnit <= 0.0f) {
+            level = texture->getLevelCount() - 1;
+        } else if (texelsPerUnit > pixelsPerUnit) {
+            level = static_cast<int>(std::floor(std::log2(texelsPerUnit / pixelsPerUnit)));
+        }
+        manager.request(*texture, level);
+    }
+}
+
+void Model::loadTextures() {
+    // One texture per distinct diffuse map, shared by the materials using it
+    std::unordered_map<std::string, int> loaded;
+    m_materialTextures.assign(m_materials.size(), -1);
+    for (size_t i = 0; i < m_materials.size(); i++) {
+        const std::string& path = m_materials[i].diffuseMap;
+        if (path.empty()) continue;
         
-        // Handle triangles and quads (split quads into triangles)
-        if (faceVertices.size() >= 3) {
-            // First triangle: 0, 1, 2
-            for (int i = 0; i < 3; i++) {
-                const Vertex& v = faceVertices[i];
-                auto it = std::find_if(m_vertices.begin(), m_vertices.end(),
-                    [&v](const Vertex& existing) {
-                        return std::abs(existing.position[0] - v.position[0]) < 0.0001f &&
-                               std::abs(existing.position[1] - v.position[1]) < 0.0001f &&
-                               std::abs(existing.position[2] - v.position[2]) < 0.0001f &&
-                               std::abs(existing.normal[0] - v.normal[0]) < 0.0001f &&
-                               std::abs(existing.normal[1] - v.normal[1]) < 0.0001f &&
-                               std::abs(existing.normal[2] - v.normal[2]) < 0.0001f;
-                    });
+        auto it = loaded.find(path);
+        if (it == loaded.end()) {
+            // Models referencing the same image share one GL texture
+            int textureIndex = -1;
+            std::shared_ptr<Texture> texture = AssetCache<Texture>::shared().acquire(path, [this, &path](Texture& t) {
+                auto decoded = m_decodedImages.find(path);
+                if (!Texture::isStreamingEnabled()) {
+                    if (decoded == m_decodedImages.end()) {
+                        return t.loadFromFile(path);
+                    }
+                    // Shared so the texture can restore evicted levels from it
+                    return t.upload(std::make_shared<const TextureImage>(std::move(decoded->second)));
+                }
                 
-                if (it != m_vertices.end()) {
-                    m_indices.push_back(std::distance(m_vertices.begin(), it));
-                } else {
-                    m_indices.push_back(m_vertices.size());
-                    m_vertices.push_back(v);
+                // Draw with the coarse levels now and stream the rest over the next frames
+                if (decoded == m_decodedImages.end()) {
+                    // Not decoded yet: a placeholder until TextureStreamer has decoded it on a worker
+                    return t.uploadPlaceholder();
                 }
-            }
-            
-            // If quad, add second triangle: 0, 2, 3
-            if (faceVertices.size() >= 4) {
-                int quadIndices[3] = {0, 2, 3};
-                for (int i = 0; i < 3; i++) {
-                    const Vertex& v = faceVertices[quadIndices[i]];
-                    auto it = std::find_if(m_vertices.begin(), m_vertices.end(),
-                        [&v](const Vertex& existing) {
-                            return std::abs(existing.position[0] - v.position[0]) < 0.0001f &&
-                                   std::abs(existing.position[1] - v.position[1]) < 0.0001f &&
-                                   std::abs(existing.position[2] - v.position[2]) < 0.0001f &&
-                                   std::abs(existing.normal[0] - v.normal[0]) < 0.0001f &&
-                                   std::abs(existing.normal[1] - v.normal[1]) < 0.0001f &&
-                                   std::abs(existing.normal[2] - v.normal[2]) < 0.0001f;
-                        });
-                    
-                    if (it != m_vertices.end()) {
-                        m_indices.push_back(std::distance(m_vertices.begin(), it));
-                    } else {
-                        m_indices.push_back(m_vertices.size());
-                        m_vertices.push_back(v);
-                    }
+                auto image = std::make_shared<TextureImage>(std::move(decoded->second));
+                return t.uploadProgressive(image);
+            });
+            if (texture) {
+                if (texture->isPlaceholder()) {
+                    TextureStreamer::shared().streamFile(texture, path);
+                } else {
+                    TextureStreamer::shared().stream(texture);
                 }
+                TextureResidencyManager::shared().track(texture);
+                textureIndex = static_cast<int>(m_textures.size());
+                m_textures.push_back(std::move(texture));
             }
+            it = loaded.emplace(path, textureIndex).first;
         }
+        m_materialTextures[i] = it->second;
+    }
+    m_hasTexture = !m_textures.empty();
+    m_decodedImages.clear();
+}
+
+void Model::parseOBJ(const std::string& filepath, const std::atomic<bool>* cancelled) {
+    ObjData obj;
+    if (!ObjParser::parseFileParallel(filepath, obj, ThreadPool::shared())) {
+        std::cerr << "Failed to open OBJ file: " << filepath << std::endl;
+        return;
+    }
+    if (cancelled && *cancelled) return;
+    
+    std::cout << "Parsed OBJ: " << obj.bytes / 1024 << " KB in " << obj.parseTimeMs << " ms ("
+              << ObjParser::throughputMBps(obj) << " MB/s)" << std::endl;
+    
+    // Parse MTL file if found
+    std::string objDir = extractDirectory(filepath);
+    if (!obj.mtlLib.empty()) {
+        m_mtlPath = objDir + "/" + obj.mtlLib;
+        parseMTL(m_mtlPath, objDir);
     }
     
+    // Create vertices from the triangulated corners, welding identical ones
+    m_weldStats = ObjParser::buildMesh(obj, m_vertices, m_indices, &ThreadPool::shared());
+    groupByMaterial(obj);
+    
     std::cout << "Loaded model: " << m_vertices.size() << " vertices, " 
               << m_indices.size() << " indices" << std::endl;
+    std::cout << "Welded " << m_weldStats.inputVertices << " corners into "
+              << m_weldStats.uniqueVertices << " vertices (merge ratio "
+              << m_weldStats.mergeRatio << ") in " << m_weldStats.timeMs << " ms" << std::endl;
+    std::cout << "Grouped triangles into " << m_subMeshes.size() << " material ranges" << std::endl;
     
-    // Parse MTL file if found
-    if (!mtlPath.empty()) {
-        parseMTL(mtlPath, objDir);
+    if (m_optimizeOnLoad && !(cancelled && *cancelled)) {
+        m_optimizationStats = MeshOptimizer::optimize(m_vertices, m_indices, m_subMeshes);
+        std::cout << "Optimized mesh in " << m_optimizationStats.timeMs << " ms: ACMR "
+                  << m_optimizationStats.before.acmr << " -> " << m_optimizationStats.after.acmr
+                  << ", ATVR " << m_optimizationStats.before.atvr << " -> " << m_optimizationStats.after.atvr
+                  << ", " << m_optimizationStats.clusterCount << " overdraw clusters" << std::endl;
     }
 }
 
@@ -237,7 +543,11 @@ void Model::parseMTL(const std::string& mtlPath, const std::string& objDir) {
         std::string type;
         iss >> type;
         
-        if (type == "map_Kd") {
+        if (type == "newmtl") {
+            Material material;
+            iss >> material.name;
+            m_materials.push_back(material);
+        } else if (type == "map_Kd" && !m_materials.empty()) {
             std::string texturePath;
             iss >> texturePath;
             
@@ -246,23 +556,23 @@ void Model::parseMTL(const std::string& mtlPath, const std::string& objDir) {
             std::string textureFile = (lastSlash != std::string::npos) ? 
                 texturePath.substr(lastSlash + 1) : texturePath;
             
+            // Prefer the file next to the OBJ, otherwise try the original path
             std::string fullTexturePath = objDir + "/" + textureFile;
-            
-            if (m_texture.loadFromFile(fullTexturePath)) {
-                m_hasTexture = true;
-                std::cout << "Loaded texture: " << fullTexturePath << std::endl;
-            } else {
-                // Try with the original path
-                if (m_texture.loadFromFile(texturePath)) {
-                    m_hasTexture = true;
-                }
-            }
-            break; // Load first texture found
+            m_materials.back().diffuseMap = FileUtils::exists(fullTexturePath) ? fullTexturePath : texturePath;
+        } else if (type == "Kd" && !m_materials.empty()) {
+            float* kd = m_materials.back().diffuse;
+            iss >> kd[0] >> kd[1] >> kd[2];
+        } else if (type == "Ks" && !m_materials.empty()) {
+            float* ks = m_materials.back().specular;
+            iss >> ks[0] >> ks[1] >> ks[2];
+        } else if (type == "Ns" && !m_materials.empty()) {
+            iss >> m_materials.back().shininess;
         }
     }
 }
 
-void Model::setupBuffers() {
+void Model::setupBuffers(const Vertex* vertices, size_t vertexCount,
+                         const unsigned int* indices, size_t indexCount) {
     cleanup();
     
     glGenVertexArrays(1, &m_VAO);
@@ -271,65 +581,193 @@ void Model::setupBuffers() {
     
     glBindVertexArray(m_VAO);
     
+    m_compact = m_compactVertices;
+    m_quantizationError = QuantizationError();
     glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-    glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(Vertex), 
-                 m_vertices.data(), GL_STATIC_DRAW);
-    
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(unsigned int),
-                 m_indices.data(), GL_STATIC_DRAW);
-    
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    glEnableVertexAttribArray(0);
     
-    // Normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
-    glEnableVertexAttribArray(1);
-    
-    // Texture coordinate attribute
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoord));
-    glEnableVertexAttribArray(2);
+    if (m_compact) {
+        std::vector<CompactVertex> compact;
+        VertexQuantizer::quantize(vertices, vertexCount, m_bounds, compact);
+        m_quantizationError = VertexQuantizer::measureError(vertices, compact.data(), vertexCount, m_bounds);
+        glBufferData(GL_ARRAY_BUFFER, compact.size() * sizeof(CompactVertex), compact.data(), GL_STATIC_DRAW);
+        
+        // 16-bit indices whenever every vertex is addressable
+        size_t indexSize = sizeof(unsigned int);
+        if (vertexCount <= 65536) {
+            std::vector<uint16_t> shortIndices(indices, indices + indexCount);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(uint16_t), shortIndices.data(), GL_STATIC_DRAW);
+            m_indexType = GL_UNSIGNED_SHORT;
+            indexSize = sizeof(uint16_t);
+        } else {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), indices, GL_STATIC_DRAW);
+            m_indexType = GL_UNSIGNED_INT;
+        }
+        
+        // Position attribute (unorm16, dequantized in the vertex shader)
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(CompactVertex),
+                              (void*)offsetof(CompactVertex, position));
+        glEnableVertexAttribArray(0);
+        
+        // Normal attribute (octahedral snorm16)
+        glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(CompactVertex), (void*)offsetof(CompactVertex, normal));
+        glEnableVertexAttribArray(1);
+        
+        // Texture coordinate attribute (half float)
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(CompactVertex),
+                              (void*)offsetof(CompactVertex, texCoord));
+        glEnableVertexAttribArray(2);
+        
+        size_t floatBytes = vertexCount * sizeof(Vertex) + indexCount * sizeof(unsigned int);
+        size_t compactBytes = vertexCount * sizeof(CompactVertex) + indexCount * indexSize;
+        std::cout << "Compact vertices: " << sizeof(CompactVertex) << " bytes/vertex, "
+                  << indexSize * 8 << "-bit indices, " << compactBytes / 1024 << " KB (was "
+                  << floatBytes / 1024 << " KB); max error: position " << m_quantizationError.maxPositionError
+                  << ", normal " << m_quantizationError.maxNormalErrorDeg << " deg, uv "
+                  << m_quantizationError.maxTexCoordError << std::endl;
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(Vertex), vertices, GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), indices, GL_STATIC_DRAW);
+        m_indexType = GL_UNSIGNED_INT;
+        
+        // Position attribute
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+        glEnableVertexAttribArray(0);
+        
+        // Normal attribute
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+        glEnableVertexAttribArray(1);
+        
+        // Texture coordinate attribute
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoord));
+        glEnableVertexAttribArray(2);
+    }
     
     glBindVertexArray(0);
     m_initialized = true;
 }
 
-void Model::render() const {
-    if (!m_initialized) return;
+void Model::render(size_t lod) const {
+    draw(nullptr, nullptr, lod, ShaderFeatures::ANY);
+}
+
+void Model::render(const Shader& shader, size_t lod) const {
+    draw(&shader, nullptr, lod, ShaderFeatures::ANY);
+}
+
+void Model::render(const Shader& shader, ClusterCuller& culler, size_t lod, uint32_t features) const {
+    draw(&shader, &culler, lod, features);
+}
+
+uint32_t Model::getSubMeshFeatures(uint32_t subMesh) const {
+    uint32_t features = m_compact ? ShaderFeatures::QUANTIZED_VERTEX : 0;
+    uint32_t materialIndex = m_subMeshes[subMesh].material;
+    int texture = materialIndex < m_materialTextures.size() ? m_materialTextures[materialIndex] : -1;
+    if (texture >= 0) {
+        features |= ShaderFeatures::TEXTURED;
+        if (m_atlasRegions.size() == m_textures.size()) {
+            features |= ShaderFeatures::TEXTURE_LAYERS;
+        }
+    }
     
-    // Bind texture if available
-    if (m_hasTexture && m_texture.isValid()) {
-        m_texture.bind(0);
+    // A black Ks adds nothing, so those materials skip the specular term
+    const Material& material = m_materials[materialIndex];
+    if (material.specular[0] > 0.0f || material.specular[1] > 0.0f || material.specular[2] > 0.0f) {
+        features |= ShaderFeatures::SPECULAR;
+    }
+    return features;
+}
+
+void Model::getLodFeatures(size_t lod, std::vector<uint32_t>& features) const {
+    if (m_lods.empty()) return;
+    const MeshLod& level = m_lods[std::min(lod, m_lods.size() - 1)];
+    for (uint32_t s = level.firstSubMesh; s < level.firstSubMesh + level.subMeshCount; s++) {
+        uint32_t subMeshFeatures = getSubMeshFeatures(s);
+        if (std::find(features.begin(), features.end(), subMeshFeatures) == features.end()) {
+            features.push_back(subMeshFeatures);
+        }
     }
+}
+
+void Model::draw(const Shader* shader, ClusterCuller* culler, size_t lod, uint32_t features) const {
+    if (!m_initialized || m_lods.empty()) return;
+    const MeshLod& level = m_lods[std::min(lod, m_lods.size() - 1)];
+    size_t indexSize = getIndexSize();
+    int boundTexture = -1;
+    bool useAtlas = shader && m_atlasRegions.size() == m_textures.size() && !m_textures.empty();
     
     glBindVertexArray(m_VAO);
-    glDrawElements(GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_INT, 0);
+    for (uint32_t s = level.firstSubMesh; s < level.firstSubMesh + level.subMeshCount; s++) {
+        if (features != ShaderFeatures::ANY && getSubMeshFeatures(s) != features) continue;
+        const SubMesh& subMesh = m_subMeshes[s];
+        
+        // Collect surviving meshlets, merging neighbours into one range
+        m_drawCounts.clear();
+        m_drawOffsets.clear();
+        if (culler && subMesh.meshletCount > 0) {
+            size_t rangeEnd = 0;
+            for (uint32_t m = subMesh.meshletOffset; m < subMesh.meshletOffset + subMesh.meshletCount; m++) {
+                const Meshlet& meshlet = m_meshlets[m];
+                if (!culler->isVisible(meshlet)) continue;
+                
+                if (!m_drawCounts.empty() && rangeEnd == meshlet.indexOffset) {
+                    m_drawCounts.back() += static_cast<GLsizei>(meshlet.indexCount);
+                } else {
+                    m_drawCounts.push_back(static_cast<GLsizei>(meshlet.indexCount));
+                    m_drawOffsets.push_back(reinterpret_cast<const void*>(meshlet.indexOffset * indexSize));
+                }
+                rangeEnd = meshlet.indexOffset + meshlet.indexCount;
+            }
+            culler->addDrawRanges(m_drawCounts.size());
+        } else {
+            m_drawCounts.push_back(static_cast<GLsizei>(subMesh.indexCount));
+            m_drawOffsets.push_back(reinterpret_cast<const void*>(subMesh.indexOffset * indexSize));
+        }
+        if (m_drawCounts.empty()) continue;
+        
+        // Sub-meshes are sorted by texture, so rebinding only happens on a change
+        const Material& material = m_materials[subMesh.material];
+        int texture = subMesh.material < m_materialTextures.size() ? m_materialTextures[subMesh.material] : -1;
+        if (useAtlas && texture >= 0) {
+            const AtlasRegion& region = m_atlasRegions[texture];
+            shader->setFloat(UNIFORM_TEXTURE_LAYER, static_cast<float>(region.layer));
+            shader->setVec4(UNIFORM_LAYER_TRANSFORM, region.uvScale[0], region.uvScale[1],
+                            region.uvOffset[0], region.uvOffset[1]);
+        } else if (texture >= 0 && texture != boundTexture) {
+            m_textures[texture]->bind(0);
+            boundTexture = texture;
+        }
+        if (shader) {
+            shader->setVec3(UNIFORM_MATERIAL_DIFFUSE, material.diffuse[0], material.diffuse[1], material.diffuse[2]);
+            shader->setVec3(UNIFORM_MATERIAL_SPECULAR, material.specular[0], material.specular[1],
+                            material.specular[2]);
+            shader->setFloat(UNIFORM_MATERIAL_SHININESS, material.shininess);
+        }
+        
+        if (m_drawCounts.size() == 1) {
+            glDrawElements(GL_TRIANGLES, m_drawCounts[0], m_indexType, m_drawOffsets[0]);
+        } else {
+            glMultiDrawElements(GL_TRIANGLES, m_drawCounts.data(), m_indexType, m_drawOffsets.data(),
+                                static_cast<GLsizei>(m_drawCounts.size()));
+        }
+    }
     glBindVertexArray(0);
     
-    if (m_hasTexture && m_texture.isValid()) {
-        m_texture.unbind();
+    if (boundTexture >= 0) {
+        m_textures[boundTexture]->unbind();
     }
 }
 
+void Model::getDequantization(float* offset, float* scale) const {
+    VertexQuantizer::getDequantization(m_bounds, offset, scale);
+}
+
 void Model::getBoundingBox(float& minX, float& minY, float& minZ,
                           float& maxX, float& maxY, float& maxZ) const {
-    if (m_vertices.empty()) {
-        minX = minY = minZ = maxX = maxY = maxZ = 0.0f;
-        return;
-    }
-    
-    minX = maxX = m_vertices[0].position[0];
-    minY = maxY = m_vertices[0].position[1];
-    minZ = maxZ = m_vertices[0].position[2];
-    
-    for (const auto& vertex : m_vertices) {
-        minX = std::min(minX, vertex.position[0]);
-        maxX = std::max(maxX, vertex.position[0]);
-        minY = std::min(minY, vertex.position[1]);
-        maxY = std::max(maxY, vertex.position[1]);
-        minZ = std::min(minZ, vertex.position[2]);
-        maxZ = std::max(maxZ, vertex.position[2]);
-    }
+    minX = m_bounds[0];
+    minY = m_bounds[1];
+    minZ = m_bounds[2];
+    maxX = m_bounds[3];
+    maxY = m_bounds[4];
+    maxZ = m_bounds[5];
 }
-
@@ -0,0 +1,97 @@
+#include "models/ModelLoader.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+ModelLoader::ModelLoader(ThreadPool& pool) : m_pool(pool) {
+}
+
+ModelLoader::~ModelLoader() {
+    // Workers push into m_finished, so it must outlive them
+    for (const auto& state : m_pending) {
+        state->cancelled = true;
+    }
+    for (const auto& state : m_pending) {
+        if (state->task.valid()) {
+            state->task.wait();
+        }
+        state->status = LoadStatus::Cancelled;
+    }
+}
+
+ModelLoadHandle ModelLoader::load(const std::shared_ptr<Model>& model, const std::string& filepath) {
+    auto state = std::make_shared<ModelLoadState>();
+    state->path = filepath;
+    state->model = model;
+    m_pending.push_back(state);
+
+    // A weak reference: the task's shared state must not keep its own state alive.
+    // m_pending holds the state until the task has pushed it to m_finished.
+    std::weak_ptr<ModelLoadState> weakState = state;
+    state->task = m_pool.submit([this, weakState]() {
+        std::shared_ptr<ModelLoadState> state = weakState.lock();
+        if (!state) return;
+        runLoad(*state);
+        m_finished.push(state);
+    });
+    return ModelLoadHandle(state);
+}
+
+ModelLoadHandle ModelLoader::find(const std::shared_ptr<Model>& model) const {
+    for (const auto& state : m_pending) {
+        if (state->model == model) {
+            return ModelLoadHandle(state);
+        }
+    }
+
+    auto state = std::make_shared<ModelLoadState>();
+    state->model = model;
+    bool ready = model && model->isReady();
+    state->status = ready ? LoadStatus::Ready : LoadStatus::Failed;
+    state->progress = ready ? 1.0f : 0.0f;
+    return ModelLoadHandle(state);
+}
+
+void ModelLoader::runLoad(ModelLoadState& state) {
+    // Progress is coarse: one step per stage
+    if (state.cancelled) return;
+    state.status = LoadStatus::Loading;
+    state.progress = 0.05f;
+
+    // The flag is also checked between loadMesh's own stages
+    if (!state.model->loadMesh(state.path, &state.cancelled)) return;
+    state.progress = 0.7f;
+    if (state.cancelled) return;
+
+    state.model->decodeTextures();
+    state.progress = 0.9f;
+    state.loaded = true;
+    state.status = LoadStatus::Uploading;
+}
+
+size_t ModelLoader::processUploads(double budgetMs) {
+    auto start = std::chrono::steady_clock::now();
+    size_t finished = 0;
+    std::shared_ptr<ModelLoadState> state;
+
+    while (m_finished.pop(state)) {
+        if (state->cancelled) {
+            state->status = LoadStatus::Cancelled;
+        } else if (!state->loaded) {
+            std::cerr << "Failed to load model: " << state->path << std::endl;
+            state->status = LoadStatus::Failed;
+        } else {
+            state->model->upload();
+            state->progress = 1.0f;
+            state->status = LoadStatus::Ready;
+        }
+        m_pending.erase(std::remove(m_pending.begin(), m_pending.end(), state), m_pending.end());
+        finished++;
+
+        double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (elapsedMs >= budgetMs) {
+            break;
+        }
+    }
+    return finished;
+}
@@ -0,0 +1,427 @@
+#include "models/ObjParser.hpp"
+#include "core/MappedFile.hpp"
+#include "core/ThreadPool.hpp"
+#include "models/VertexWelder.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && isSpace(*p)) ++p;
+    return p;
+}
+
+// Parses a float at p, returning the position after it (or p if nothing was parsed)
+inline const char* parseFloat(const char* p, const char* end, float& value) {
+    p = skipSpaces(p, end);
+    if (p < end && *p == '+') ++p;
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) {
+        value = 0.0f;
+        return p;
+    }
+    return result.ptr;
+}
+
+inline const char* parseInt(const char* p, const char* end, int32_t& value) {
+    if (p < end && *p == '+') ++p;
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) {
+        value = 0;
+        return p;
+    }
+    return result.ptr;
+}
+
+// Converts a 1-based or negative (relative) OBJ index to a 0-based index, -1 if absent
+inline int32_t resolveIndex(int32_t index, size_t count) {
+    if (index > 0) return index - 1;
+    if (index < 0) return static_cast<int32_t>(count) + index;
+    return -1;
+}
+
+inline bool keywordIs(const char* p, const char* end, const char* keyword, size_t length) {
+    return static_cast<size_t>(end - p) >= length && std::memcmp(p, keyword, length) == 0 &&
+           (static_cast<size_t>(end - p) == length || isSpace(p[length]));
+}
+
+// Corners whose indices were relative (negative) and so resolved against a
+// chunk-local count; they get the chunk's global base added after the prefix sum
+struct RelativeFixups {
+    std::vector<uint32_t> positions;
+    std::vector<uint32_t> texCoords;
+    std::vector<uint32_t> normals;
+};
+
+void parseFace(const char* p, const char* end, ObjData& out, RelativeFixups* fixups) {
+    size_t positionCount = out.positions.size() / 3;
+    size_t texCoordCount = out.texCoords.size() / 2;
+    size_t normalCount = out.normals.size() / 3;
+
+    ObjCorner first = {-1, -1, -1};
+    ObjCorner previous = {-1, -1, -1};
+    int cornerCount = 0;
+    bool firstRelative[3] = {false, false, false};
+    bool previousRelative[3] = {false, false, false};
+
+    while (true) {
+        p = skipSpaces(p, end);
+        if (p >= end) break;
+
+        ObjCorner corner = {-1, -1, -1};
+        int32_t index = 0;
+        const char* next = parseInt(p, end, index);
+        if (next == p) break;
+        corner.position = resolveIndex(index, positionCount);
+        bool relativePosition = index < 0;
+        bool relativeTexCoord = false;
+        bool relativeNormal = false;
+        p = next;
+
+        if (p < end && *p == '/') {
+            ++p;
+            if (p < end && *p != '/') {
+                p = parseInt(p, end, index);
+                corner.texCoord = resolveIndex(index, texCoordCount);
+                relativeTexCoord = index < 0;
+            }
+            if (p < end && *p == '/') {
+                ++p;
+                p = parseInt(p, end, index);
+                corner.normal = resolveIndex(index, normalCount);
+                relativeNormal = index < 0;
+            }
+        }
+        // Skip anything unexpected up to the next separator
+        while (p < end && !isSpace(*p)) ++p;
+
+        // Fan triangulation: (0, i - 1, i)
+        if (cornerCount == 0) {
+            first = corner;
+            firstRelative[0] = relativePosition;
+            firstRelative[1] = relativeTexCoord;
+            firstRelative[2] = relativeNormal;
+        } else if (cornerCount >= 2) {
+            if (fixups) {
+                bool relative[3][3] = {
+                    {firstRelative[0], firstRelative[1], firstRelative[2]},
+                    {previousRelative[0], previousRelative[1], previousRelative[2]},
+                    {relativePosition, relativeTexCoord, relativeNormal}
+                };
+                uint32_t base = static_cast<uint32_t>(out.corners.size());
+                for (uint32_t i = 0; i < 3; i++) {
+                    if (relative[i][0]) fixups->positions.push_back(base + i);
+                    if (relative[i][1]) fixups->texCoords.push_back(base + i);
+                    if (relative[i][2]) fixups->normals.push_back(base + i);
+                }
+            }
+            out.corners.push_back(first);
+            out.corners.push_back(previous);
+            out.corners.push_back(corner);
+        }
+        previous = corner;
+        previousRelative[0] = relativePosition;
+        previousRelative[1] = relativeTexCoord;
+        previousRelative[2] = relativeNormal;
+        cornerCount++;
+    }
+}
+
+uint32_t findOrAddMaterial(ObjData& out, const char* name, size_t length) {
+    uint32_t material = 0;
+    while (material < out.materialNames.size() &&
+           out.materialNames[material].compare(0, std::string::npos, name, length) != 0) {
+        material++;
+    }
+    if (material == out.materialNames.size()) {
+        out.materialNames.emplace_back(name, length);
+    }
+    return material;
+}
+
+// Starts a material run at the current corner
+void useMaterial(ObjData& out, const char* name, size_t length) {
+    uint32_t material = findOrAddMaterial(out, name, length);
+    uint32_t firstCorner = static_cast<uint32_t>(out.corners.size());
+    if (!out.materialRuns.empty() && out.materialRuns.back().firstCorner == firstCorner) {
+        out.materialRuns.back().material = material;
+    } else {
+        out.materialRuns.push_back({firstCorner, material});
+    }
+}
+
+void parseRange(const char* data, size_t size, ObjData& out, RelativeFixups* fixups) {
+    const char* p = data;
+    const char* end = data + size;
+
+    while (p < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!lineEnd) lineEnd = end;
+
+        p = skipSpaces(p, lineEnd);
+        if (p < lineEnd && *p != '#') {
+            if (p[0] == 'v' && p + 1 < lineEnd && isSpace(p[1])) {
+                float x, y, z;
+                const char* q = parseFloat(p + 2, lineEnd, x);
+                q = parseFloat(q, lineEnd, y);
+                parseFloat(q, lineEnd, z);
+                out.positions.push_back(x);
+                out.positions.push_back(y);
+                out.positions.push_back(z);
+            } else if (keywordIs(p, lineEnd, "vn", 2)) {
+                float x, y, z;
+                const char* q = parseFloat(p + 3, lineEnd, x);
+                q = parseFloat(q, lineEnd, y);
+                parseFloat(q, lineEnd, z);
+                out.normals.push_back(x);
+                out.normals.push_back(y);
+                out.normals.push_back(z);
+            } else if (keywordIs(p, lineEnd, "vt", 2)) {
+                float u, v;
+                const char* q = parseFloat(p + 3, lineEnd, u);
+                parseFloat(q, lineEnd, v);
+                out.texCoords.push_back(u);
+                out.texCoords.push_back(v);
+            } else if (p[0] == 'f' && p + 1 < lineEnd && isSpace(p[1])) {
+                parseFace(p + 2, lineEnd, out, fixups);
+            } else if (keywordIs(p, lineEnd, "usemtl", 6)) {
+                const char* nameBegin = skipSpaces(p + 6, lineEnd);
+                const char* nameEnd = lineEnd;
+                while (nameEnd > nameBegin && isSpace(nameEnd[-1])) --nameEnd;
+                useMaterial(out, nameBegin, static_cast<size_t>(nameEnd - nameBegin));
+            } else if (out.mtlLib.empty() && keywordIs(p, lineEnd, "mtllib", 6)) {
+                const char* nameBegin = skipSpaces(p + 6, lineEnd);
+                const char* nameEnd = lineEnd;
+                while (nameEnd > nameBegin && isSpace(nameEnd[-1])) --nameEnd;
+                out.mtlLib.assign(nameBegin, nameEnd);
+            }
+        }
+
+        p = lineEnd + 1;
+    }
+}
+
+Vertex makeVertex(const ObjData& data, const ObjCorner& corner) {
+    const size_t positionCount = data.positions.size() / 3;
+    const size_t texCoordCount = data.texCoords.size() / 2;
+    const size_t normalCount = data.normals.size() / 3;
+
+    Vertex v = {};
+    if (corner.position >= 0 && static_cast<size_t>(corner.position) < positionCount) {
+        std::memcpy(v.position, &data.positions[corner.position * 3], 3 * sizeof(float));
+    }
+
+    if (corner.normal >= 0 && static_cast<size_t>(corner.normal) < normalCount) {
+        std::memcpy(v.normal, &data.normals[corner.normal * 3], 3 * sizeof(float));
+    } else {
+        v.normal[1] = 1.0f;
+    }
+
+    if (corner.texCoord >= 0 && static_cast<size_t>(corner.texCoord) < texCoordCount) {
+        std::memcpy(v.texCoord, &data.texCoords[corner.texCoord * 2], 2 * sizeof(float));
+    }
+    return v;
+}
+
+// Chunks smaller than this are not worth a task of their own
+constexpr size_t MIN_CHUNK_BYTES = 1 << 20;
+constexpr size_t MIN_CHUNK_CORNERS = 3 * 16384;
+
+} // namespace
+
+void ObjData::clear() {
+    positions.clear();
+    texCoords.clear();
+    normals.clear();
+    corners.clear();
+    materialNames.clear();
+    materialRuns.clear();
+    mtlLib.clear();
+    bytes = 0;
+    parseTimeMs = 0.0;
+}
+
+void ObjParser::parse(const char* data, size_t size, ObjData& out) {
+    auto start = std::chrono::steady_clock::now();
+    parseRange(data, size, out, nullptr);
+    out.bytes += size;
+    out.parseTimeMs += std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+bool ObjParser::parseFile(const std::string& filepath, ObjData& out) {
+    out.clear();
+
+    MappedFile file;
+    if (!file.open(filepath)) {
+        return false;
+    }
+
+    parse(file.data(), file.size(), out);
+    return true;
+}
+
+bool ObjParser::parseFileParallel(const std::string& filepath, ObjData& out, ThreadPool& pool) {
+    out.clear();
+
+    MappedFile file;
+    if (!file.open(filepath)) {
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    const char* data = file.data();
+    const size_t size = file.size();
+    size_t chunkCount = std::min(pool.getThreadCount() * 4, size / MIN_CHUNK_BYTES);
+    if (chunkCount <= 1) {
+        parse(data, size, out);
+        return true;
+    }
+
+    // Split on line boundaries
+    std::vector<size_t> boundaries(chunkCount + 1, size);
+    boundaries[0] = 0;
+    for (size_t i = 1; i < chunkCount; i++) {
+        size_t target = std::max(boundaries[i - 1], size / chunkCount * i);
+        const char* newline = static_cast<const char*>(std::memchr(data + target, '\n', size - target));
+        boundaries[i] = newline ? static_cast<size_t>(newline - data) + 1 : size;
+    }
+
+    std::vector<ObjData> chunks(chunkCount);
+    std::vector<RelativeFixups> fixups(chunkCount);
+    pool.parallelFor(chunkCount, [&](size_t i) {
+        parseRange(data + boundaries[i], boundaries[i + 1] - boundaries[i], chunks[i], &fixups[i]);
+    });
+
+    // Prefix sums give each chunk its global offsets
+    std::vector<size_t> positionBase(chunkCount + 1, 0);
+    std::vector<size_t> texCoordBase(chunkCount + 1, 0);
+    std::vector<size_t> normalBase(chunkCount + 1, 0);
+    std::vector<size_t> cornerBase(chunkCount + 1, 0);
+    for (size_t i = 0; i < chunkCount; i++) {
+        positionBase[i + 1] = positionBase[i] + chunks[i].positions.size();
+        texCoordBase[i + 1] = texCoordBase[i] + chunks[i].texCoords.size();
+        normalBase[i + 1] = normalBase[i] + chunks[i].normals.size();
+        cornerBase[i + 1] = cornerBase[i] + chunks[i].corners.size();
+        if (out.mtlLib.empty()) {
+            out.mtlLib = chunks[i].mtlLib;
+        }
+
+        // Material names are per chunk; map them into the global table
+        for (const ObjMaterialRun& run : chunks[i].materialRuns) {
+            const std::string& name = chunks[i].materialNames[run.material];
+            uint32_t material = findOrAddMaterial(out, name.data(), name.size());
+            out.materialRuns.push_back({static_cast<uint32_t>(cornerBase[i] + run.firstCorner), material});
+        }
+    }
+
+    out.positions.resize(positionBase[chunkCount]);
+    out.texCoords.resize(texCoordBase[chunkCount]);
+    out.normals.resize(normalBase[chunkCount]);
+    out.corners.resize(cornerBase[chunkCount]);
+
+    pool.parallelFor(chunkCount, [&](size_t i) {
+        ObjData& chunk = chunks[i];
+        std::copy(chunk.positions.begin(), chunk.positions.end(), out.positions.begin() + positionBase[i]);
+        std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), out.texCoords.begin() + texCoordBase[i]);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), out.normals.begin() + normalBase[i]);
+
+        for (uint32_t corner : fixups[i].positions) {
+            chunk.corners[corner].position += static_cast<int32_t>(positionBase[i] / 3);
+        }
+        for (uint32_t corner : fixups[i].texCoords) {
+            chunk.corners[corner].texCoord += static_cast<int32_t>(texCoordBase[i] / 2);
+        }
+        for (uint32_t corner : fixups[i].normals) {
+            chunk.corners[corner].normal += static_cast<int32_t>(normalBase[i] / 3);
+        }
+        std::copy(chunk.corners.begin(), chunk.corners.end(), out.corners.begin() + cornerBase[i]);
+        chunk.clear();
+    });
+
+    out.bytes = size;
+    out.parseTimeMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+WeldStats ObjParser::buildMesh(const ObjData& data, std::vector<Vertex>& vertices,
+                               std::vector<unsigned int>& indices, ThreadPool* pool) {
+    auto start = std::chrono::steady_clock::now();
+
+    const size_t cornerCount = data.corners.size();
+    size_t rangeCount = 1;
+    if (pool) {
+        rangeCount = std::max<size_t>(1, std::min(pool->getThreadCount() * 4, cornerCount / MIN_CHUNK_CORNERS));
+    }
+
+    // Weld each range of triangles locally; ranges are multiples of 3 corners
+    size_t trianglesPerRange = (cornerCount / 3 + rangeCount - 1) / rangeCount;
+    std::vector<std::vector<Vertex>> localVertices(rangeCount);
+    std::vector<std::vector<unsigned int>> localIndices(rangeCount);
+    auto weldRange = [&](size_t r) {
+        size_t begin = std::min(cornerCount, r * trianglesPerRange * 3);
+        size_t end = std::min(cornerCount, begin + trianglesPerRange * 3);
+        VertexWelder welder(localVertices[r]);
+        welder.reserve((end - begin) / 4);
+        localIndices[r].reserve(end - begin);
+        for (size_t c = begin; c < end; c++) {
+            localIndices[r].push_back(welder.insert(makeVertex(data, data.corners[c])));
+        }
+    };
+    if (rangeCount > 1) {
+        pool->parallelFor(rangeCount, weldRange);
+    } else {
+        weldRange(0);
+    }
+
+    // Merge ranges in order; each range's unique vertices are already in
+    // first-use order, so the result matches a single serial weld exactly
+    vertices.clear();
+    indices.resize(cornerCount);
+    VertexWelder welder(vertices);
+    welder.reserve(localVertices[0].size() * rangeCount);
+    std::vector<std::vector<unsigned int>> remap(rangeCount);
+    std::vector<size_t> indexBase(rangeCount + 1, 0);
+    for (size_t r = 0; r < rangeCount; r++) {
+        remap[r].reserve(localVertices[r].size());
+        for (const Vertex& v : localVertices[r]) {
+            remap[r].push_back(welder.insert(v));
+        }
+        localVertices[r].clear();
+        localVertices[r].shrink_to_fit();
+        indexBase[r + 1] = indexBase[r] + localIndices[r].size();
+    }
+
+    auto remapRange = [&](size_t r) {
+        for (size_t i = 0; i < localIndices[r].size(); i++) {
+            indices[indexBase[r] + i] = remap[r][localIndices[r][i]];
+        }
+    };
+    if (rangeCount > 1) {
+        pool->parallelFor(rangeCount, remapRange);
+    } else {
+        remapRange(0);
+    }
+
+    WeldStats stats;
+    stats.inputVertices = cornerCount;
+    stats.uniqueVertices = vertices.size();
+    stats.mergeRatio = vertices.empty() ? 0.0 : static_cast<double>(cornerCount) / vertices.size();
+    stats.timeMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+double ObjParser::throughputMBps(const ObjData& data) {
+    if (data.parseTimeMs <= 0.0) return 0.0;
+    return (data.bytes / (1024.0 * 1024.0)) / (data.parseTimeMs / 1000.0);
+}
@@ -0,0 +1,188 @@
+#include "models/VertexQuantizer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static_assert(sizeof(CompactVertex) == 16, "CompactVertex must stay 16 bytes");
+
+namespace {
+
+float signNotZero(float value) {
+    return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+int16_t toSnorm16(float value) {
+    value = std::max(-1.0f, std::min(1.0f, value));
+    return static_cast<int16_t>(std::lround(value * 32767.0f));
+}
+
+float fromSnorm16(int16_t value) {
+    return std::max(-1.0f, value / 32767.0f);
+}
+
+} // namespace
+
+uint16_t VertexQuantizer::floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t exponent = (bits >> 23) & 0xFFu;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+
+    if (exponent == 0xFFu) {
+        // Infinity or NaN
+        return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+    }
+
+    int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+    if (halfExponent >= 31) {
+        return static_cast<uint16_t>(sign | 0x7C00u);
+    }
+
+    if (halfExponent <= 0) {
+        // Subnormal half (or zero)
+        if (halfExponent < -10) {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x800000u;
+        uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1u);
+        uint32_t midpoint = 1u << (shift - 1u);
+        if (remainder > midpoint || (remainder == midpoint && (half & 1u))) {
+            half++;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    // A rounding carry out of the mantissa correctly bumps the exponent
+    uint32_t half = sign | (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1FFFu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) {
+        half++;
+    }
+    return static_cast<uint16_t>(half);
+}
+
+float VertexQuantizer::halfToFloat(uint16_t value) {
+    uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+    uint32_t exponent = (value >> 10) & 0x1Fu;
+    uint32_t mantissa = value & 0x3FFu;
+
+    float result;
+    if (exponent == 0) {
+        result = std::ldexp(static_cast<float>(mantissa), -24);
+    } else if (exponent == 31) {
+        result = mantissa ? NAN : INFINITY;
+    } else {
+        result = std::ldexp(static_cast<float>(mantissa | 0x400u), static_cast<int>(exponent) - 25);
+    }
+
+    uint32_t bits;
+    std::memcpy(&bits, &result, sizeof(bits));
+    bits |= sign;
+    std::memcpy(&result, &bits, sizeof(bits));
+    return result;
+}
+
+void VertexQuantizer::encodeOctahedral(const float* normal, int16_t* out) {
+    float sum = std::fabs(normal[0]) + std::fabs(normal[1]) + std::fabs(normal[2]);
+    if (sum <= 0.0f) {
+        out[0] = 0;
+        out[1] = 0;
+        return;
+    }
+
+    float x = normal[0] / sum;
+    float y = normal[1] / sum;
+    if (normal[2] < 0.0f) {
+        // Fold the lower hemisphere over the diagonals
+        float foldedX = (1.0f - std::fabs(y)) * signNotZero(x);
+        float foldedY = (1.0f - std::fabs(x)) * signNotZero(y);
+        x = foldedX;
+        y = foldedY;
+    }
+    out[0] = toSnorm16(x);
+    out[1] = toSnorm16(y);
+}
+
+void VertexQuantizer::decodeOctahedral(const int16_t* encoded, float* normal) {
+    float x = fromSnorm16(encoded[0]);
+    float y = fromSnorm16(encoded[1]);
+    float z = 1.0f - std::fabs(x) - std::fabs(y);
+    float t = std::max(-z, 0.0f);
+    x += x >= 0.0f ? -t : t;
+    y += y >= 0.0f ? -t : t;
+
+    float length = std::sqrt(x * x + y * y + z * z);
+    normal[0] = x / length;
+    normal[1] = y / length;
+    normal[2] = z / length;
+}
+
+void VertexQuantizer::getDequantization(const float bounds[6], float* offset, float* scale) {
+    for (int axis = 0; axis < 3; axis++) {
+        offset[axis] = bounds[axis];
+        scale[axis] = bounds[axis + 3] - bounds[axis];
+    }
+}
+
+void VertexQuantizer::quantize(const Vertex* vertices, size_t count, const float bounds[6],
+                               std::vector<CompactVertex>& out) {
+    float invExtent[3];
+    for (int axis = 0; axis < 3; axis++) {
+        float extent = bounds[axis + 3] - bounds[axis];
+        invExtent[axis] = extent > 0.0f ? 1.0f / extent : 0.0f;
+    }
+
+    out.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        const Vertex& v = vertices[i];
+        CompactVertex& c = out[i];
+
+        for (int axis = 0; axis < 3; axis++) {
+            float t = (v.position[axis] - bounds[axis]) * invExtent[axis];
+            t = std::max(0.0f, std::min(1.0f, t));
+            c.position[axis] = static_cast<uint16_t>(std::lround(t * 65535.0f));
+        }
+        c.position[3] = 0;
+
+        encodeOctahedral(v.normal, c.normal);
+        c.texCoord[0] = floatToHalf(v.texCoord[0]);
+        c.texCoord[1] = floatToHalf(v.texCoord[1]);
+    }
+}
+
+QuantizationError VertexQuantizer::measureError(const Vertex* vertices, const CompactVertex* compact,
+                                                size_t count, const float bounds[6]) {
+    QuantizationError error;
+    float offset[3], scale[3];
+    getDequantization(bounds, offset, scale);
+
+    const float radToDeg = 180.0f / 3.14159265359f;
+    for (size_t i = 0; i < count; i++) {
+        const Vertex& v = vertices[i];
+        const CompactVertex& c = compact[i];
+
+        for (int axis = 0; axis < 3; axis++) {
+            float decoded = offset[axis] + (c.position[axis] / 65535.0f) * scale[axis];
+            error.maxPositionError = std::max(error.maxPositionError, std::fabs(decoded - v.position[axis]));
+        }
+
+        float length = std::sqrt(v.normal[0] * v.normal[0] + v.normal[1] * v.normal[1] + v.normal[2] * v.normal[2]);
+        if (length > 0.0f) {
+            float decoded[3];
+            decodeOctahedral(c.normal, decoded);
+            float cosine = (decoded[0] * v.normal[0] + decoded[1] * v.normal[1] + decoded[2] * v.normal[2]) / length;
+            cosine = std::max(-1.0f, std::min(1.0f, cosine));
+            error.maxNormalErrorDeg = std::max(error.maxNormalErrorDeg, std::acos(cosine) * radToDeg);
+        }
+
+        for (int k = 0; k < 2; k++) {
+            float decoded = halfToFloat(c.texCoord[k]);
+            error.maxTexCoordError = std::max(error.maxTexCoordError, std::fabs(decoded - v.texCoord[k]));
+        }
+    }
+    return error;
+}
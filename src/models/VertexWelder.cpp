@@ -0,0 +1,97 @@
+#include "models/VertexWelder.hpp"
+#include <cmath>
+#include <cstring>
+
+VertexWelder::VertexWelder(std::vector<Vertex>& vertices, float epsilon)
+    : m_vertices(vertices), m_invEpsilon(1.0f / epsilon), m_inputCount(0) {
+    m_slots.assign(1024, Slot{0, EMPTY_SLOT});
+}
+
+void VertexWelder::reserve(size_t count) {
+    // Keep the load factor at or below 0.5
+    size_t capacity = m_slots.size();
+    while (capacity < count * 2) {
+        capacity *= 2;
+    }
+    if (capacity != m_slots.size()) {
+        m_slots.assign(capacity, Slot{0, EMPTY_SLOT});
+        size_t uniqueCount = m_keys.size() / KEY_COMPONENTS;
+        for (size_t i = 0; i < uniqueCount; i++) {
+            uint64_t hash = hashKey(&m_keys[i * KEY_COMPONENTS]);
+            size_t mask = m_slots.size() - 1;
+            size_t slot = hash & mask;
+            while (m_slots[slot].index != EMPTY_SLOT) {
+                slot = (slot + 1) & mask;
+            }
+            m_slots[slot] = Slot{hash, static_cast<uint32_t>(i)};
+        }
+    }
+    m_keys.reserve(count * KEY_COMPONENTS);
+    m_vertices.reserve(m_vertices.size() + count);
+}
+
+void VertexWelder::quantize(const Vertex& vertex, int64_t* key) const {
+    key[0] = static_cast<int64_t>(std::floor(vertex.position[0] * m_invEpsilon + 0.5f));
+    key[1] = static_cast<int64_t>(std::floor(vertex.position[1] * m_invEpsilon + 0.5f));
+    key[2] = static_cast<int64_t>(std::floor(vertex.position[2] * m_invEpsilon + 0.5f));
+    key[3] = static_cast<int64_t>(std::floor(vertex.normal[0] * m_invEpsilon + 0.5f));
+    key[4] = static_cast<int64_t>(std::floor(vertex.normal[1] * m_invEpsilon + 0.5f));
+    key[5] = static_cast<int64_t>(std::floor(vertex.normal[2] * m_invEpsilon + 0.5f));
+    key[6] = static_cast<int64_t>(std::floor(vertex.texCoord[0] * m_invEpsilon + 0.5f));
+    key[7] = static_cast<int64_t>(std::floor(vertex.texCoord[1] * m_invEpsilon + 0.5f));
+}
+
+uint64_t VertexWelder::hashKey(const int64_t* key) {
+    // splitmix64-style mixing of each component
+    uint64_t hash = 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < KEY_COMPONENTS; i++) {
+        uint64_t k = static_cast<uint64_t>(key[i]) + 0x9E3779B97F4A7C15ull * (i + 1);
+        k = (k ^ (k >> 30)) * 0xBF58476D1CE4E5B9ull;
+        k = (k ^ (k >> 27)) * 0x94D049BB133111EBull;
+        k ^= k >> 31;
+        hash = (hash ^ k) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+void VertexWelder::grow() {
+    reserve(m_slots.size());
+}
+
+unsigned int VertexWelder::insert(const Vertex& vertex) {
+    m_inputCount++;
+
+    int64_t key[KEY_COMPONENTS];
+    quantize(vertex, key);
+    uint64_t hash = hashKey(key);
+
+    size_t mask = m_slots.size() - 1;
+    size_t slot = hash & mask;
+    while (m_slots[slot].index != EMPTY_SLOT) {
+        const Slot& candidate = m_slots[slot];
+        if (candidate.hash == hash &&
+            std::memcmp(&m_keys[candidate.index * KEY_COMPONENTS], key, sizeof(key)) == 0) {
+            return static_cast<unsigned int>(m_vertices.size() - m_keys.size() / KEY_COMPONENTS + candidate.index);
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    uint32_t uniqueIndex = static_cast<uint32_t>(m_keys.size() / KEY_COMPONENTS);
+    m_slots[slot] = Slot{hash, uniqueIndex};
+    m_keys.insert(m_keys.end(), key, key + KEY_COMPONENTS);
+    m_vertices.push_back(vertex);
+
+    if ((uniqueIndex + 1) * 2 > m_slots.size()) {
+        grow();
+    }
+    return static_cast<unsigned int>(m_vertices.size() - 1);
+}
+
+WeldStats VertexWelder::getStats() const {
+    WeldStats stats;
+    stats.inputVertices = m_inputCount;
+    stats.uniqueVertices = m_keys.size() / KEY_COMPONENTS;
+    stats.mergeRatio = stats.uniqueVertices > 0 ?
+        static_cast<double>(stats.inputVertices) / stats.uniqueVertices : 0.0;
+    return stats;
+}
@@ -0,0 +1,377 @@
+#include "scene/EntityPool.hpp"
+#include <algorithm>
+#include <cmath>
+
+EntityPool::EntityPool() : m_orderValid(true) {
+}
+
+EntityHandle EntityPool::create(const float* position, const float* rotation, const float* scale,
+                                const EntityBounds& localBounds, uint32_t renderId, EntityHandle parent) {
+    size_t parentIndex = getIndex(parent);
+    EntityHandle handle;
+    if (!m_freeSlots.empty()) {
+        handle.slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    } else {
+        handle.slot = static_cast<uint32_t>(m_slots.size());
+        m_slots.push_back({0, 0});
+    }
+    size_t index = size();
+    Slot& slot = m_slots[handle.slot];
+    slot.index = static_cast<uint32_t>(index);
+    handle.generation = slot.generation;
+
+    m_transforms.add(position, rotation, scale);
+    m_localBounds.push_back(localBounds);
+    m_worldBounds.push_back(localBounds);
+    m_maxScales.push_back(1.0f);
+    m_renderIds.push_back(renderId);
+    m_lods.push_back(0);
+    m_slotOfIndex.push_back(handle.slot);
+    m_parentSlots.push_back(parentIndex != INVALID_INDEX ? parent.slot : EntityHandle::INVALID_SLOT);
+    m_childCounts.push_back(0);
+    m_dirty.push_back(0);
+
+    if (parentIndex != INVALID_INDEX) {
+        m_childCounts[parentIndex]++;
+        m_orderValid = false;
+    } else if (m_orderValid) {
+        // A new root is a subtree of its own at the end of the order
+        uint32_t position = static_cast<uint32_t>(m_order.size());
+        m_order.push_back(static_cast<uint32_t>(index));
+        m_orderPositions.push_back(position);
+        m_subtreeEnds.push_back(position + 1);
+    }
+    markDirty(index);
+    return handle;
+}
+
+bool EntityPool::destroy(EntityHandle handle) {
+    size_t index = getIndex(handle);
+    if (index == INVALID_INDEX) {
+        return false;
+    }
+
+    // Children become roots; their transforms are now relative to the world
+    if (m_childCounts[index] > 0) {
+        for (size_t i = 0; i < size(); i++) {
+            if (m_parentSlots[i] == handle.slot) {
+                m_parentSlots[i] = EntityHandle::INVALID_SLOT;
+                markDirty(i);
+            }
+        }
+    }
+    if (m_parentSlots[index] != EntityHandle::INVALID_SLOT) {
+        m_childCounts[m_slots[m_parentSlots[index]].index]--;
+    }
+
+    // The last entity fills the hole, so the arrays stay packed
+    size_t last = size() - 1;
+    m_transforms.remove(index);
+    m_localBounds[index] = m_localBounds[last];
+    m_worldBounds[index] = m_worldBounds[last];
+    m_maxScales[index] = m_maxScales[last];
+    m_renderIds[index] = m_renderIds[last];
+    m_lods[index] = m_lods[last];
+    m_slotOfIndex[index] = m_slotOfIndex[last];
+    m_parentSlots[index] = m_parentSlots[last];
+    m_childCounts[index] = m_childCounts[last];
+    m_dirty[index] = m_dirty[last];
+    m_slots[m_slotOfIndex[index]].index = static_cast<uint32_t>(index);
+
+    m_localBounds.pop_back();
+    m_worldBounds.pop_back();
+    m_maxScales.pop_back();
+    m_renderIds.pop_back();
+    m_lods.pop_back();
+    m_slotOfIndex.pop_back();
+    m_parentSlots.pop_back();
+    m_childCounts.pop_back();
+    m_dirty.pop_back();
+    m_orderValid = false;
+
+    m_slots[handle.slot].generation++;
+    m_freeSlots.push_back(handle.slot);
+    return true;
+}
+
+void EntityPool::clear() {
+    for (uint32_t slot : m_slotOfIndex) {
+        m_slots[slot].generation++;
+        m_freeSlots.push_back(slot);
+    }
+    m_transforms.clear();
+    m_localBounds.clear();
+    m_worldBounds.clear();
+    m_maxScales.clear();
+    m_renderIds.clear();
+    m_lods.clear();
+    m_slotOfIndex.clear();
+    m_parentSlots.clear();
+    m_childCounts.clear();
+    m_dirty.clear();
+    m_dirtySlots.clear();
+    m_order.clear();
+    m_orderPositions.clear();
+    m_subtreeEnds.clear();
+    m_orderValid = true;
+}
+
+size_t EntityPool::getIndex(EntityHandle handle) const {
+    if (handle.slot >= m_slots.size()) {
+        return INVALID_INDEX;
+    }
+    const Slot& slot = m_slots[handle.slot];
+    bool alive = slot.generation == handle.generation && slot.index < size() &&
+                 m_slotOfIndex[slot.index] == handle.slot;
+    return alive ? slot.index : INVALID_INDEX;
+}
+
+EntityHandle EntityPool::getHandle(size_t index) const {
+    EntityHandle handle;
+    handle.slot = m_slotOfIndex[index];
+    handle.generation = m_slots[handle.slot].generation;
+    return handle;
+}
+
+bool EntityPool::setTransform(EntityHandle handle, const float* position, const float* rotation,
+                              const float* scale) {
+    size_t index = getIndex(handle);
+    if (index == INVALID_INDEX) {
+        return false;
+    }
+    m_transforms.set(index, position, rotation, scale);
+    markDirty(index);
+    return true;
+}
+
+bool EntityPool::getTransform(EntityHandle handle, float* position, float* rotation, float* scale) const {
+    size_t index = getIndex(handle);
+    if (index == INVALID_INDEX) {
+        return false;
+    }
+    m_transforms.getInputs(index, position, rotation, scale);
+    return true;
+}
+
+bool EntityPool::setParent(EntityHandle child, EntityHandle parent) {
+    size_t childIndex = getIndex(child);
+    if (childIndex == INVALID_INDEX) {
+        return false;
+    }
+    size_t parentIndex = INVALID_INDEX;
+    if (parent.isValid()) {
+        parentIndex = getIndex(parent);
+        if (parentIndex == INVALID_INDEX) {
+            return false;
+        }
+        // The new parent must not be inside the child's subtree
+        for (size_t ancestor = parentIndex; ancestor != INVALID_INDEX;) {
+            if (ancestor == childIndex) {
+                return false;
+            }
+            uint32_t ancestorSlot = m_parentSlots[ancestor];
+            ancestor = ancestorSlot != EntityHandle::INVALID_SLOT ? m_slots[ancestorSlot].index : INVALID_INDEX;
+        }
+    }
+
+    uint32_t oldSlot = m_parentSlots[childIndex];
+    uint32_t newSlot = parentIndex != INVALID_INDEX ? parent.slot : EntityHandle::INVALID_SLOT;
+    if (oldSlot == newSlot) {
+        return true;
+    }
+    if (oldSlot != EntityHandle::INVALID_SLOT) {
+        m_childCounts[m_slots[oldSlot].index]--;
+    }
+    if (parentIndex != INVALID_INDEX) {
+        m_childCounts[parentIndex]++;
+    }
+    m_parentSlots[childIndex] = newSlot;
+    m_orderValid = false;
+    markDirty(childIndex);
+    return true;
+}
+
+EntityHandle EntityPool::getParent(EntityHandle handle) const {
+    size_t index = getIndex(handle);
+    if (index == INVALID_INDEX || m_parentSlots[index] == EntityHandle::INVALID_SLOT) {
+        return EntityHandle();
+    }
+    EntityHandle parent;
+    parent.slot = m_parentSlots[index];
+    parent.generation = m_slots[parent.slot].generation;
+    return parent;
+}
+
+size_t EntityPool::updateWorld() {
+    if (m_dirtySlots.empty()) {
+        return 0;
+    }
+    if (!m_orderValid) {
+        rebuildOrder();
+    }
+
+    // Slots of entities destroyed since they were marked no longer map to a dirty entity
+    m_updateScratch.clear();
+    for (uint32_t slotIndex : m_dirtySlots) {
+        const Slot& slot = m_slots[slotIndex];
+        if (slot.index < size() && m_slotOfIndex[slot.index] == slotIndex && m_dirty[slot.index]) {
+            m_dirty[slot.index] = 0;
+            m_updateScratch.push_back(m_orderPositions[slot.index]);
+        }
+    }
+    m_dirtySlots.clear();
+
+    // Each dirty subtree is one range of the order; ranges inside an earlier one are already covered
+    std::sort(m_updateScratch.begin(), m_updateScratch.end());
+    size_t updated = 0;
+    uint32_t end = 0;
+    for (uint32_t start : m_updateScratch) {
+        if (start < end) continue;
+        end = m_subtreeEnds[start];
+        for (uint32_t position = start; position < end; position++) {
+            updateEntity(m_order[position]);
+        }
+        updated += end - start;
+    }
+    return updated;
+}
+
+void EntityPool::updateClipMatrices(const float* viewProjection, const std::vector<uint32_t>& indices) {
+    m_transforms.computeClip(indices.data(), indices.size(), viewProjection);
+}
+
+void EntityPool::cull(const float* viewProjection, std::vector<uint32_t>& visible) const {
+    // Gribb-Hartmann: planes are row 3 plus or minus rows 0..2; no need to normalize for a sign test
+    float planes[6][4];
+    for (int i = 0; i < 3; i++) {
+        for (int k = 0; k < 4; k++) {
+            float w = viewProjection[k * 4 + 3];
+            float r = viewProjection[k * 4 + i];
+            planes[i * 2][k] = w + r;
+            planes[i * 2 + 1][k] = w - r;
+        }
+    }
+
+    visible.clear();
+    for (size_t index = 0; index < m_worldBounds.size(); index++) {
+        const EntityBounds& bounds = m_worldBounds[index];
+        float center[3], extent[3];
+        for (int k = 0; k < 3; k++) {
+            center[k] = (bounds.min[k] + bounds.max[k]) * 0.5f;
+            extent[k] = (bounds.max[k] - bounds.min[k]) * 0.5f;
+        }
+
+        // Outside if even the corner furthest along a plane's normal is behind it
+        bool inside = true;
+        for (const auto& plane : planes) {
+            float distance = plane[0] * center[0] + plane[1] * center[1] + plane[2] * center[2] + plane[3];
+            float radius = std::fabs(plane[0]) * extent[0] + std::fabs(plane[1]) * extent[1] +
+                           std::fabs(plane[2]) * extent[2];
+            if (distance + radius < 0.0f) {
+                inside = false;
+                break;
+            }
+        }
+        if (inside) {
+            visible.push_back(static_cast<uint32_t>(index));
+        }
+    }
+}
+
+void EntityPool::markDirty(size_t index) {
+    if (!m_dirty[index]) {
+        m_dirty[index] = 1;
+        m_dirtySlots.push_back(m_slotOfIndex[index]);
+    }
+}
+
+void EntityPool::rebuildOrder() {
+    size_t count = size();
+    auto parentOf = [this](size_t index) {
+        uint32_t slot = m_parentSlots[index];
+        return slot != EntityHandle::INVALID_SLOT ? m_slots[slot].index : static_cast<uint32_t>(INVALID_INDEX);
+    };
+
+    // Children of each entity, grouped by parent
+    std::vector<uint32_t> childStart(count + 1, 0);
+    std::vector<uint32_t> children(count);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t parent = parentOf(i);
+        if (parent != static_cast<uint32_t>(INVALID_INDEX)) childStart[parent + 1]++;
+    }
+    for (size_t i = 0; i < count; i++) {
+        childStart[i + 1] += childStart[i];
+    }
+    std::vector<uint32_t> cursor(childStart.begin(), childStart.end() - 1);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t parent = parentOf(i);
+        if (parent != static_cast<uint32_t>(INVALID_INDEX)) children[cursor[parent]++] = static_cast<uint32_t>(i);
+    }
+
+    // Depth-first from every root, so each subtree occupies consecutive positions
+    m_order.clear();
+    m_order.reserve(count);
+    std::vector<uint32_t> stack;
+    for (size_t root = 0; root < count; root++) {
+        if (m_parentSlots[root] != EntityHandle::INVALID_SLOT) continue;
+        stack.push_back(static_cast<uint32_t>(root));
+        while (!stack.empty()) {
+            uint32_t index = stack.back();
+            stack.pop_back();
+            m_order.push_back(index);
+            for (uint32_t c = childStart[index + 1]; c > childStart[index]; c--) {
+                stack.push_back(children[c - 1]);
+            }
+        }
+    }
+
+    // Subtree sizes accumulate from the deepest entities up
+    std::vector<uint32_t> subtreeSizes(count, 1);
+    for (size_t position = count; position-- > 0;) {
+        uint32_t parent = parentOf(m_order[position]);
+        if (parent != static_cast<uint32_t>(INVALID_INDEX)) subtreeSizes[parent] += subtreeSizes[m_order[position]];
+    }
+    m_orderPositions.resize(count);
+    m_subtreeEnds.resize(count);
+    for (size_t position = 0; position < count; position++) {
+        m_orderPositions[m_order[position]] = static_cast<uint32_t>(position);
+        m_subtreeEnds[position] = static_cast<uint32_t>(position + subtreeSizes[m_order[position]]);
+    }
+    m_orderValid = true;
+}
+
+void EntityPool::updateEntity(size_t index) {
+    uint32_t parentSlot = m_parentSlots[index];
+    const float* parentWorld =
+        parentSlot != EntityHandle::INVALID_SLOT ? m_transforms.get(m_slots[parentSlot].index).model : nullptr;
+    m_transforms.updateWorld(index, parentWorld);
+    const float* model = m_transforms.get(index).model;
+
+    // Model units to world units: the longest axis of the world matrix
+    float longest = 0.0f;
+    for (int k = 0; k < 3; k++) {
+        const float* axis = model + k * 4;
+        longest = std::max(longest, axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    }
+    m_maxScales[index] = std::sqrt(longest);
+
+    // Each world axis extends by the local extents projected through the absolute rotation-scale
+    const EntityBounds& local = m_localBounds[index];
+    float center[3], extent[3];
+    for (int k = 0; k < 3; k++) {
+        center[k] = (local.min[k] + local.max[k]) * 0.5f;
+        extent[k] = (local.max[k] - local.min[k]) * 0.5f;
+    }
+    EntityBounds& world = m_worldBounds[index];
+    for (int row = 0; row < 3; row++) {
+        float worldCenter = model[12 + row];
+        float worldExtent = 0.0f;
+        for (int k = 0; k < 3; k++) {
+            worldCenter += model[k * 4 + row] * center[k];
+            worldExtent += std::fabs(model[k * 4 + row]) * extent[k];
+        }
+        world.min[row] = worldCenter - worldExtent;
+        world.max[row] = worldCenter + worldExtent;
+    }
+}
@@ -1,9 +1,38 @@
 #include "scene/Scene.hpp"
+#include "core/AssetCache.hpp"
+#include "core/TextureResidencyManager.hpp"
+#include "core/TextureStreamer.hpp"
+#include "scene/UniformBlocks.hpp"
 #include <iostream>
 #include <algorithm>
 
+namespace {
+
+// Room for a few hundred object blocks per frame before the uniform ring grows
+const size_t INITIAL_UNIFORM_BYTES = 64 * 1024;
+
+// Origin that puts the center of an object's local bounds at position once it is scaled and rotated
+void centerOrigin(const EntityBounds& local, const float* position, const float* rotation, const float* scale,
+                  float* origin) {
+    float v[3];
+    for (int k = 0; k < 3; k++) {
+        v[k] = (local.min[k] + local.max[k]) * 0.5f * scale[k];
+    }
+    // v + 2w(q x v) + 2q x (q x v) rotates v by the unit quaternion q = (x, y, z, w)
+    const float* q = rotation;
+    float t[3] = {2.0f * (q[1] * v[2] - q[2] * v[1]), 2.0f * (q[2] * v[0] - q[0] * v[2]),
+                  2.0f * (q[0] * v[1] - q[1] * v[0])};
+    origin[0] = position[0] - (v[0] + q[3] * t[0] + q[1] * t[2] - q[2] * t[1]);
+    origin[1] = position[1] - (v[1] + q[3] * t[1] + q[2] * t[0] - q[0] * t[2]);
+    origin[2] = position[2] - (v[2] + q[3] * t[2] + q[0] * t[1] - q[1] * t[0]);
+}
+
+} // namespace
+
 Scene::Scene(float width, float height) 
-    : m_camera(width, height), m_width(width), m_height(height) {
+    : m_camera(width, height), m_width(width), m_height(height), m_compactVertices(false),
+      m_meshletsEnabled(false), m_lodThreshold(1.0f), m_uploadBudgetMs(2.0f),
+      m_streamingBudget(4 * 1024 * 1024), m_transformUpdateCount(0) {
 }
 
 Scene::~Scene() {
@@ -15,84 +44,62 @@ bool Scene::initialize() {
         return false;
     }
     
+    // Camera, light and object transforms reach the shaders through uniform blocks
+    if (!m_uniformRing.initialize(INITIAL_UNIFORM_BYTES)) {
+        std::cerr << "Failed to create uniform buffer ring" << std::endl;
+        return false;
+    }
+    
+    // Without staging buffers, uploads fall back to client memory
+    if (!m_staging.initialize()) {
+        std::cerr << "Failed to create staging buffers" << std::endl;
+    }
+    
     setupCamera();
     
     return true;
 }
 
 bool Scene::loadShaders() {
-    // Create shader source code
-    const std::string vertexShaderSource = R"(
-#version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
-layout (location = 2) in vec2 aTexCoord;
+    // Optional paths sit in #ifdef blocks; ShaderFeatures picks the permutation compiled for each draw
+    // shaders/scene.vert and shaders/scene.frag are the only copy: the build embeds them as the
+    // fallback for loadShaderFiles, so the built-in shaders match the files as of the last build
+    const std::string vertexShaderSource =
+#include "shaders/scene.vert.inc"
+        ;
+    const std::string fragmentShaderSource =
+#include "shaders/scene.frag.inc"
+        ;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-
-out vec3 FragPos;
-out vec3 Normal;
-out vec2 TexCoord;
-
-void main() {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
-    TexCoord = aTexCoord;
-    gl_Position = projection * view * vec4(FragPos, 1.0);
-}
-)";
-
-    const std::string fragmentShaderSource = R"(
-#version 330 core
-out vec4 FragColor;
-
-in vec3 FragPos;
-in vec3 Normal;
-in vec2 TexCoord;
-
-uniform sampler2D texture_diffuse1;
-uniform bool useTexture;
-uniform vec3 lightPos;
-uniform vec3 lightColor;
-uniform vec3 viewPos;
-
-void main() {
-    vec3 objectColor;
-    if (useTexture) {
-        objectColor = texture(texture_diffuse1, TexCoord).rgb;
-    } else {
-        objectColor = vec3(0.7, 0.7, 0.7);
-    }
-    
-    // Ambient
-    float ambientStrength = 0.3;
-    vec3 ambient = ambientStrength * lightColor;
-    
-    // Diffuse
-    vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(lightPos - FragPos);
-    float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = diff * lightColor;
-    
-    // Specular
-    float specularStrength = 0.5;
-    vec3 viewDir = normalize(viewPos - FragPos);
-    vec3 reflectDir = reflect(-lightDir, norm);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
-    vec3 specular = specularStrength * spec * lightColor;
+    std::vector<std::string> features(ShaderFeatures::NAMES, ShaderFeatures::NAMES + ShaderFeatures::COUNT);
+    m_shaders.setSource(vertexShaderSource, fragmentShaderSource, features);
+    m_shaders.setPrelude(UNIFORM_BLOCKS_GLSL);
+    m_shaders.setLinkCallback([](Shader& shader) {
+        // Texture units never change, so they are set once per variant
+        shader.use();
+        shader.setInt("texture_diffuse1", 0);
+        shader.setInt("textureLayers", 1);
+        return shader.bindUniformBlock("FrameBlock", FRAME_BLOCK_BINDING) &&
+               shader.bindUniformBlock("ObjectBlock", OBJECT_BLOCK_BINDING);
+    });
     
-    vec3 result = (ambient + diffuse + specular) * objectColor;
-    FragColor = vec4(result, 1.0);
+    // Other variants are built the first time a draw needs them
+    return m_shaders.get(0) != nullptr;
 }
-)";
 
-    return m_shader.loadFromSource(vertexShaderSource, fragmentShaderSource);
+bool Scene::loadShaderFiles(const std::string& vertexPath, const std::string& fragmentPath) {
+    std::vector<std::string> features(ShaderFeatures::NAMES, ShaderFeatures::NAMES + ShaderFeatures::COUNT);
+    m_shaderReloader.remove(m_shaders);
+    if (!m_shaders.setSourceFiles(vertexPath, fragmentPath, features) || !m_shaders.get(0)) {
+        std::cerr << "Failed to load scene shaders, using the built-in ones" << std::endl;
+        loadShaders();
+        return false;
+    }
+    return m_shaderReloader.add(m_shaders);
 }
 
 void Scene::setupCamera() {
-    if (m_objects.empty()) {
+    if (m_entities.size() == 0) {
         // Default camera position
         m_camera.setPosition(0.0f, 2.0f, 5.0f);
         m_camera.setTarget(0.0f, 0.0f, 0.0f);
@@ -100,19 +107,18 @@ void Scene::setupCamera() {
     }
     
     // Calculate bounding box of all objects
+    m_entities.updateWorld();
     float minX = 1e9f, minY = 1e9f, minZ = 1e9f;
     float maxX = -1e9f, maxY = -1e9f, maxZ = -1e9f;
     
-    for (const auto& obj : m_objects) {
-        float objMinX, objMinY, objMinZ, objMaxX, objMaxY, objMaxZ;
-        obj->getBoundingBox(objMinX, objMinY, objMinZ, objMaxX, objMaxY, objMaxZ);
-        
-        minX = std::min(minX, objMinX);
-        minY = std::min(minY, objMinY);
-        minZ = std::min(minZ, objMinZ);
-        maxX = std::max(maxX, objMaxX);
-        maxY = std::max(maxY, objMaxY);
-        maxZ = std::max(maxZ, objMaxZ);
+    for (size_t i = 0; i < m_entities.size(); i++) {
+        const EntityBounds& bounds = m_entities.getWorldBounds(i);
+        minX = std::min(minX, bounds.min[0]);
+        minY = std::min(minY, bounds.min[1]);
+        minZ = std::min(minZ, bounds.min[2]);
+        maxX = std::max(maxX, bounds.max[0]);
+        maxY = std::max(maxY, bounds.max[1]);
+        maxZ = std::max(maxZ, bounds.max[2]);
     }
     
     // Calculate center and size
@@ -142,64 +148,310 @@ void Scene::setupCamera() {
               << m_camera.getPositionY() << ", " << m_camera.getPositionZ() << ")" << std::endl;
 }
 
-void Scene::addObject(const std::string& modelPath, float posX, float posY, float posZ,
-                     float scaleX, float scaleY, float scaleZ) {
+EntityHandle Scene::addObject(const std::string& modelPath, float posX, float posY, float posZ,
+                             float scaleX, float scaleY, float scaleZ) {
     auto obj = std::make_unique<SceneObject>(modelPath);
-    obj->setScale(scaleX, scaleY, scaleZ);
+    obj->setCompactVertices(m_compactVertices);
+    obj->setMeshletsEnabled(m_meshletsEnabled);
     
-    if (obj->load()) {
-        // Get the model's raw bounding box (before transformations)
-        float minX, minY, minZ, maxX, maxY, maxZ;
-        obj->getLocalBoundingBox(minX, minY, minZ, maxX, maxY, maxZ);
-        
-        // Calculate local center (raw model space)
-        float localCenterX = (minX + maxX) * 0.5f;
-        float localCenterY = (minY + maxY) * 0.5f;
-        float localCenterZ = (minZ + maxZ) * 0.5f;
-        
-        // Set position to offset the model so its center is at the desired position
-        // After scaling, the center will be at localCenter * scale, so we offset by that
-        obj->setPosition(posX - localCenterX * scaleX, 
-                        posY - localCenterY * scaleY, 
-                        posZ - localCenterZ * scaleZ);
-        
-        m_objects.push_back(std::move(obj));
-        // Update camera after adding object
-        setupCamera();
-    } else {
+    if (!obj->load()) {
         std::cerr << "Failed to load object: " << modelPath << std::endl;
+        return EntityHandle();
+    }
+    
+    if (!obj->isReady()) {
+        // The model is still loading in the background for another object: share that load
+        ModelLoadHandle handle = m_loader.find(obj->getModel());
+        queuePendingObject(std::move(obj), handle, posX, posY, posZ, scaleX, scaleY, scaleZ);
+        return EntityHandle();
+    }
+    
+    EntityHandle entity = placeObject(*obj, posX, posY, posZ, scaleX, scaleY, scaleZ);
+    // Update camera after adding object
+    setupCamera();
+    return entity;
+}
+
+bool Scene::removeObject(EntityHandle handle) {
+    size_t index = m_entities.getIndex(handle);
+    if (index == EntityPool::INVALID_INDEX) {
+        return false;
+    }
+    uint32_t renderId = m_entities.getRenderId(index);
+    m_entities.destroy(handle);
+    
+    // The last user releases the scene's reference; the id is reused by the next new model
+    if (--m_modelUsers[renderId] == 0) {
+        m_models[renderId]->setAtlasRegions(std::vector<AtlasRegion>());
+        m_models[renderId].reset();
+    }
+    return true;
+}
+
+bool Scene::setObjectTransform(EntityHandle handle, const float* position, const float* rotation,
+                               const float* scale) {
+    size_t index = m_entities.getIndex(handle);
+    if (index == EntityPool::INVALID_INDEX) {
+        std::cerr << "Cannot move object: stale handle" << std::endl;
+        return false;
+    }
+    // Centered like addObject, so passing back the position an object was added at leaves it in place
+    float origin[3];
+    centerOrigin(m_entities.getLocalBounds(index), position, rotation, scale, origin);
+    return m_entities.setTransform(handle, origin, rotation, scale);
+}
+
+bool Scene::setObjectParent(EntityHandle child, EntityHandle parent) {
+    if (!m_entities.setParent(child, parent)) {
+        std::cerr << "Cannot attach object: stale handle or the parent is in the object's subtree" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+ModelLoadHandle Scene::addObjectAsync(const std::string& modelPath, float posX, float posY, float posZ,
+                                      float scaleX, float scaleY, float scaleZ) {
+    auto obj = std::make_unique<SceneObject>(modelPath);
+    obj->setCompactVertices(m_compactVertices);
+    obj->setMeshletsEnabled(m_meshletsEnabled);
+    
+    ModelLoadHandle handle = obj->loadAsync(m_loader);
+    queuePendingObject(std::move(obj), handle, posX, posY, posZ, scaleX, scaleY, scaleZ);
+    return handle;
+}
+
+void Scene::queuePendingObject(std::unique_ptr<SceneObject> obj, const ModelLoadHandle& handle,
+                               float posX, float posY, float posZ, float scaleX, float scaleY, float scaleZ) {
+    PendingObject pending;
+    pending.object = std::move(obj);
+    pending.handle = handle;
+    pending.position[0] = posX;
+    pending.position[1] = posY;
+    pending.position[2] = posZ;
+    pending.scale[0] = scaleX;
+    pending.scale[1] = scaleY;
+    pending.scale[2] = scaleZ;
+    m_pendingObjects.push_back(std::move(pending));
+}
+
+EntityHandle Scene::placeObject(const SceneObject& obj, float posX, float posY, float posZ,
+                               float scaleX, float scaleY, float scaleZ) {
+    // Get the model's raw bounding box (before transformations)
+    EntityBounds local;
+    obj.getLocalBoundingBox(local.min[0], local.min[1], local.min[2], local.max[0], local.max[1], local.max[2]);
+    
+    // Offset the model so its center, not its origin, lands at the desired position
+    float center[3] = {posX, posY, posZ};
+    float scale[3] = {scaleX, scaleY, scaleZ};
+    const float rotation[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    float position[3];
+    centerOrigin(local, center, rotation, scale, position);
+    return m_entities.create(position, rotation, scale, local, acquireRenderId(obj.getModel()));
+}
+
+uint32_t Scene::acquireRenderId(const std::shared_ptr<Model>& model) {
+    // Few unique models are placed many times, so a linear search stays short
+    auto it = std::find(m_models.begin(), m_models.end(), model);
+    if (it == m_models.end()) {
+        it = std::find(m_models.begin(), m_models.end(), nullptr);
+        if (it == m_models.end()) {
+            it = m_models.insert(m_models.end(), nullptr);
+            m_modelUsers.push_back(0);
+        }
+        *it = model;
+    }
+    uint32_t renderId = static_cast<uint32_t>(it - m_models.begin());
+    m_modelUsers[renderId]++;
+    return renderId;
+}
+
+void Scene::processPendingObjects() {
+    if (m_loader.getPendingCount() > 0) {
+        m_loader.processUploads(m_uploadBudgetMs);
+    }
+    if (m_pendingObjects.empty()) return;
+    
+    // Objects join the scene only once their model is on the GPU
+    bool added = false;
+    for (auto it = m_pendingObjects.begin(); it != m_pendingObjects.end();) {
+        LoadStatus status = it->handle.getStatus();
+        if (status == LoadStatus::Ready) {
+            placeObject(*it->object, it->position[0], it->position[1], it->position[2],
+                        it->scale[0], it->scale[1], it->scale[2]);
+            added = true;
+        } else if (status == LoadStatus::Failed || status == LoadStatus::Cancelled) {
+            // Let a later request for the same file try again
+            if (it->object->getModel() && !it->object->isReady()) {
+                AssetCache<Model>::shared().erase(it->object->getModel());
+            }
+            if (status == LoadStatus::Failed) {
+                std::cerr << "Failed to load object: " << it->object->getModelPath() << std::endl;
+            }
+        } else {
+            ++it;
+            continue;
+        }
+        it = m_pendingObjects.erase(it);
+    }
+    
+    if (added) {
+        setupCamera();
     }
 }
 
 void Scene::render() {
-    m_shader.use();
+    processPendingObjects();
+    m_shaderReloader.update();
+    if (TextureStreamer::shared().getPendingCount() > 0) {
+        TextureStreamer::shared().update(m_streamingBudget, &m_staging);
+    }
+    
+    m_shaders.resetStats();
     
-    // Set view and projection matrices
-    m_shader.setMat4("view", m_camera.getViewMatrix());
-    m_shader.setMat4("projection", m_camera.getProjectionMatrix());
+    // Camera and lighting, shared by every program through the frame block
+    m_uniformRing.beginFrame();
+    FrameUniforms frame = {};
+    std::copy(m_camera.getViewMatrix(), m_camera.getViewMatrix() + 16, frame.view);
+    std::copy(m_camera.getProjectionMatrix(), m_camera.getProjectionMatrix() + 16, frame.projection);
+    frame.lightPos[0] = frame.lightPos[1] = frame.lightPos[2] = 5.0f;
+    frame.lightColor[0] = frame.lightColor[1] = frame.lightColor[2] = 1.0f;
+    frame.viewPos[0] = m_camera.getPositionX();
+    frame.viewPos[1] = m_camera.getPositionY();
+    frame.viewPos[2] = m_camera.getPositionZ();
+    size_t frameOffset = m_uniformRing.push(&frame, sizeof(frame));
     
-    // Set lighting
-    m_shader.setVec3("lightPos", 5.0f, 5.0f, 5.0f);
-    m_shader.setVec3("lightColor", 1.0f, 1.0f, 1.0f);
-    m_shader.setVec3("viewPos", m_camera.getPositionX(), m_camera.getPositionY(), m_camera.getPositionZ());
+    // The atlas is bound once for every object that samples from it
+    m_atlas.bind(1);
     
-    // Set texture unit
-    m_shader.setInt("texture_diffuse1", 0);
+    // Render all objects at their level of detail, culling meshlets against the camera
+    float cameraPosition[3] = {m_camera.getPositionX(), m_camera.getPositionY(), m_camera.getPositionZ()};
+    float projectionScale = m_camera.getProjectionMatrix()[5] * m_height * 0.5f;
+    TextureResidencyManager& residency = TextureResidencyManager::shared();
+    m_culler.resetStats();
     
-    // Render all objects
-    for (const auto& obj : m_objects) {
-        float modelMatrix[16];
-        obj->getModelMatrix(modelMatrix);
-        m_shader.setMat4("model", modelMatrix);
+    // Only entities that moved since the last frame get new world matrices; only those in the view frustum are drawn
+    float viewProjection[16];
+    m_camera.getViewProjectionMatrix(viewProjection);
+    m_transformUpdateCount = m_entities.updateWorld();
+    m_entities.cull(viewProjection, m_visible);
+    m_entities.updateClipMatrices(viewProjection, m_visible);
+    
+    // Each visible entity's block is written before the first draw, so the frame's blocks go up in one upload
+    m_objectOffsets.clear();
+    m_drawItems.clear();
+    for (size_t v = 0; v < m_visible.size(); v++) {
+        size_t i = m_visible[v];
+        const Model& model = *m_models[m_entities.getRenderId(i)];
+        const EntityBounds& bounds = m_entities.getWorldBounds(i);
+        float pixelsPerUnit = SceneObject::getPixelsPerUnit(bounds.min, bounds.max, m_entities.getMaxScale(i),
+                                                            cameraPosition, projectionScale);
+        size_t lod = SceneObject::selectLod(model, m_entities.getLod(i), pixelsPerUnit, m_lodThreshold);
+        m_entities.setLod(i, static_cast<uint32_t>(lod));
+        if (model.hasTexture()) {
+            model.requestTextureLevels(residency, pixelsPerUnit);
+        }
+        
+        const ObjectTransform& transform = m_entities.getMatrices(i);
+        ObjectUniforms block = {};
+        std::copy(transform.model, transform.model + 16, block.model);
+        std::copy(transform.modelViewProjection, transform.modelViewProjection + 16, block.modelViewProjection);
+        std::copy(transform.normal, transform.normal + 12, block.normalMatrix);
         
-        // Set useTexture uniform based on whether model has texture
-        m_shader.setBool("useTexture", obj->hasTexture());
+        // Compact vertices carry positions relative to the model's bounding box
+        if (model.isCompact()) {
+            model.getDequantization(block.positionOffset, block.positionScale);
+        }
+        m_objectOffsets.push_back(m_uniformRing.push(&block, sizeof(block)));
         
-        obj->render();
+        m_objectFeatures.clear();
+        model.getLodFeatures(lod, m_objectFeatures);
+        for (uint32_t features : m_objectFeatures) {
+            m_drawItems.emplace_back(features, v);
+        }
     }
+    m_uniformRing.upload();
+    m_uniformRing.bind(FRAME_BLOCK_BINDING, frameOffset, sizeof(FrameUniforms));
+    
+    // Draws are grouped by shader permutation, so each variant is made current once per frame
+    std::stable_sort(m_drawItems.begin(), m_drawItems.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    const Shader* shader = nullptr;
+    for (size_t d = 0; d < m_drawItems.size(); d++) {
+        uint32_t features = m_drawItems[d].first;
+        if (d == 0 || features != m_drawItems[d - 1].first) {
+            shader = m_shaders.get(features);
+            if (shader) {
+                shader->use();
+            }
+        }
+        if (!shader) continue;
+        
+        size_t v = m_drawItems[d].second;
+        size_t i = m_visible[v];
+        m_uniformRing.bind(OBJECT_BLOCK_BINDING, m_objectOffsets[v], sizeof(ObjectUniforms));
+        
+        const ObjectTransform& transform = m_entities.getMatrices(i);
+        m_culler.setView(transform.model, transform.modelViewProjection, cameraPosition);
+        m_models[m_entities.getRenderId(i)]->render(*shader, m_culler, m_entities.getLod(i), features);
+    }
+    m_uniformRing.endFrame();
+    
+    // Evictions and restores take effect from the next frame
+    residency.update();
+}
+
+bool Scene::buildTextureAtlas() {
+    std::vector<std::shared_ptr<Model>> models;
+    std::vector<std::shared_ptr<Texture>> textures;
+    for (const auto& model : m_models) {
+        if (!model || !model->isReady()) {
+            continue;
+        }
+        
+        // Textures still being decoded hold a placeholder; their models join the next atlas
+        const auto& modelTextures = model->getTextures();
+        if (std::any_of(modelTextures.begin(), modelTextures.end(),
+                        [](const std::shared_ptr<Texture>& texture) { return texture->isPlaceholder(); })) {
+            continue;
+        }
+        models.push_back(model);
+        textures.insert(textures.end(), model->getTextures().begin(), model->getTextures().end());
+    }
+    
+    bool built = m_atlas.build(textures);
+    for (const auto& model : models) {
+        // A model with any texture left out keeps binding its own
+        std::vector<AtlasRegion> regions;
+        bool complete = built;
+        for (const auto& texture : model->getTextures()) {
+            regions.emplace_back();
+            complete = complete && m_atlas.getRegion(*texture, regions.back());
+        }
+        model->setAtlasRegions(complete ? regions : std::vector<AtlasRegion>());
+    }
+    return built;
 }
 
 void Scene::cleanup() {
-    m_objects.clear();
+    for (auto& pending : m_pendingObjects) {
+        pending.handle.cancel();
+        if (pending.object->getModel()) {
+            AssetCache<Model>::shared().erase(pending.object->getModel());
+        }
+    }
+    m_pendingObjects.clear();
+    for (const auto& model : m_models) {
+        if (model) {
+            model->setAtlasRegions(std::vector<AtlasRegion>());
+        }
+    }
+    m_entities.clear();
+    m_models.clear();
+    m_modelUsers.clear();
+    m_atlas.cleanup();
+    TextureStreamer::shared().releaseStaging();
+    m_staging.cleanup();
+    m_uniformRing.cleanup();
+    m_shaders.cleanup();
 }
 
@@ -1,112 +1,86 @@
 #include "scene/SceneObject.hpp"
+#include "core/AssetCache.hpp"
+#include <algorithm>
 #include <cmath>
-#include <cstring>
 
 SceneObject::SceneObject(const std::string& modelPath) 
-    : m_modelPath(modelPath) {
-    m_position[0] = 0.0f;
-    m_position[1] = 0.0f;
-    m_position[2] = 0.0f;
-    
-    m_scale[0] = 1.0f;
-    m_scale[1] = 1.0f;
-    m_scale[2] = 1.0f;
-    
-    m_rotation[0] = 0.0f; // angle
-    m_rotation[1] = 0.0f; // x
-    m_rotation[2] = 1.0f; // y
-    m_rotation[3] = 0.0f; // z
+    : m_modelPath(modelPath), m_compactVertices(false), m_meshletsEnabled(false) {
 }
 
 SceneObject::~SceneObject() {
 }
 
-bool SceneObject::load() {
-    return m_model.loadFromOBJ(m_modelPath);
-}
-
-void SceneObject::render() const {
-    m_model.render();
-}
-
-void SceneObject::setPosition(float x, float y, float z) {
-    m_position[0] = x;
-    m_position[1] = y;
-    m_position[2] = z;
+std::string SceneObject::getModelVariant() const {
+    // The options change the uploaded buffers, so they are part of the cache key
+    return std::string(m_compactVertices ? "compact" : "float") + (m_meshletsEnabled ? "+meshlets" : "");
 }
 
-void SceneObject::setScale(float x, float y, float z) {
-    m_scale[0] = x;
-    m_scale[1] = y;
-    m_scale[2] = z;
+bool SceneObject::load() {
+    m_model = AssetCache<Model>::shared().acquire(m_modelPath, [this](Model& model) {
+        model.setCompactVertices(m_compactVertices);
+        model.setMeshletsEnabled(m_meshletsEnabled);
+        return model.loadFromOBJ(m_modelPath);
+    }, getModelVariant());
+    return m_model != nullptr;
 }
 
-void SceneObject::setRotation(float angle, float x, float y, float z) {
-    m_rotation[0] = angle;
-    m_rotation[1] = x;
-    m_rotation[2] = y;
-    m_rotation[3] = z;
+ModelLoadHandle SceneObject::loadAsync(ModelLoader& loader) {
+    bool started = false;
+    m_model = AssetCache<Model>::shared().acquire(m_modelPath, [this, &started](Model& model) {
+        model.setCompactVertices(m_compactVertices);
+        model.setMeshletsEnabled(m_meshletsEnabled);
+        started = true;
+        return true;
+    }, getModelVariant());
+    
+    if (!m_model) {
+        return ModelLoadHandle();
+    }
+    // A model already loading for another object shares that object's load
+    return started ? loader.load(m_model, m_modelPath) : loader.find(m_model);
 }
 
-void SceneObject::buildModelMatrix(float* matrix) const {
-    // Initialize as identity matrix
-    memset(matrix, 0, 16 * sizeof(float));
-    matrix[0] = matrix[5] = matrix[10] = matrix[15] = 1.0f;
+size_t SceneObject::selectLod(const Model& model, size_t currentLod, float pixelsPerUnit, float thresholdPixels) {
+    size_t lodCount = model.getLodCount();
+    if (lodCount <= 1) {
+        return 0;
+    }
     
-    // Apply scale
-    matrix[0] *= m_scale[0];
-    matrix[5] *= m_scale[1];
-    matrix[10] *= m_scale[2];
+    auto coarsestWithin = [&](float limit) {
+        size_t lod = 0;
+        while (lod + 1 < lodCount && model.getLod(lod + 1).error * pixelsPerUnit <= limit) lod++;
+        return lod;
+    };
     
-    // Apply rotation (simplified - around Y axis for now)
-    if (m_rotation[0] != 0.0f && m_rotation[2] == 1.0f) {
-        float angle = m_rotation[0] * 3.14159265359f / 180.0f;
-        float cosA = cos(angle);
-        float sinA = sin(angle);
-        
-        float temp[16];
-        memcpy(temp, matrix, 16 * sizeof(float));
-        
-        matrix[0] = temp[0] * cosA - temp[8] * sinA;
-        matrix[2] = temp[0] * sinA + temp[8] * cosA;
-        matrix[8] = temp[2] * cosA - temp[10] * sinA;
-        matrix[10] = temp[2] * sinA + temp[10] * cosA;
+    size_t target = coarsestWithin(thresholdPixels);
+    if (target < currentLod) {
+        // The current level is too coarse: refine right away
+        return target;
+    } else if (target > currentLod) {
+        return std::max(currentLod, coarsestWithin(thresholdPixels * LOD_HYSTERESIS));
     }
-    
-    // Apply translation
-    matrix[12] = m_position[0];
-    matrix[13] = m_position[1];
-    matrix[14] = m_position[2];
+    return currentLod;
 }
 
-void SceneObject::getModelMatrix(float* matrix) const {
-    buildModelMatrix(matrix);
-}
-
-void SceneObject::getBoundingBox(float& minX, float& minY, float& minZ,
-                                float& maxX, float& maxY, float& maxZ) const {
-    m_model.getBoundingBox(minX, minY, minZ, maxX, maxY, maxZ);
-    
-    // Transform bounding box by scale and position
-    float centerX = (minX + maxX) * 0.5f;
-    float centerY = (minY + maxY) * 0.5f;
-    float centerZ = (minZ + maxZ) * 0.5f;
-    
-    float halfSizeX = (maxX - minX) * 0.5f * m_scale[0];
-    float halfSizeY = (maxY - minY) * 0.5f * m_scale[1];
-    float halfSizeZ = (maxZ - minZ) * 0.5f * m_scale[2];
+float SceneObject::getPixelsPerUnit(const float* worldMin, const float* worldMax, float maxScale,
+                                    const float* cameraPosition, float projectionScale) {
+    // Distance from the camera to the nearest point of the bounding sphere
+    float center[3] = {(worldMin[0] + worldMax[0]) * 0.5f, (worldMin[1] + worldMax[1]) * 0.5f,
+                       (worldMin[2] + worldMax[2]) * 0.5f};
+    float extent[3] = {worldMax[0] - worldMin[0], worldMax[1] - worldMin[1], worldMax[2] - worldMin[2]};
+    float radius = 0.5f * std::sqrt(extent[0] * extent[0] + extent[1] * extent[1] + extent[2] * extent[2]);
+    float dx = center[0] - cameraPosition[0];
+    float dy = center[1] - cameraPosition[1];
+    float dz = center[2] - cameraPosition[2];
+    float distance = std::max(std::sqrt(dx * dx + dy * dy + dz * dz) - radius, 1e-3f);
     
-    minX = centerX * m_scale[0] + m_position[0] - halfSizeX;
-    maxX = centerX * m_scale[0] + m_position[0] + halfSizeX;
-    minY = centerY * m_scale[1] + m_position[1] - halfSizeY;
-    maxY = centerY * m_scale[1] + m_position[1] + halfSizeY;
-    minZ = centerZ * m_scale[2] + m_position[2] - halfSizeZ;
-    maxZ = centerZ * m_scale[2] + m_position[2] + halfSizeZ;
+    // Model units are scaled to world units
+    return projectionScale * maxScale / distance;
 }
 
 void SceneObject::getLocalBoundingBox(float& minX, float& minY, float& minZ,
                                       float& maxX, float& maxY, float& maxZ) const {
     // Get the raw model bounding box without transformations
-    m_model.getBoundingBox(minX, minY, minZ, maxX, maxY, maxZ);
+    m_model->getBoundingBox(minX, minY, minZ, maxX, maxY, maxZ);
 }
 
@@ -0,0 +1,297 @@
+#include "scene/TransformBatch.hpp"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TRANSFORMBATCH_SSE2 1
+#endif
+
+namespace {
+
+// Floats of ObjectTransform, written as one run per object
+const size_t OUTPUT_COUNT = 44;
+const size_t NORMAL_OFFSET = 16;
+const size_t MVP_OFFSET = 28;
+
+static_assert(sizeof(ObjectTransform) == OUTPUT_COUNT * sizeof(float), "ObjectTransform must be tightly packed");
+
+// Lane operations, so the scalar and SSE2 paths share one formula and round identically
+inline float add(float a, float b) { return a + b; }
+inline float sub(float a, float b) { return a - b; }
+inline float mul(float a, float b) { return a * b; }
+template <typename V>
+inline V splat(float a);
+template <>
+inline float splat<float>(float a) { return a; }
+inline float reciprocalOrOne(float a) { return a != 0.0f ? 1.0f / a : 1.0f; }
+
+#ifdef TRANSFORMBATCH_SSE2
+inline __m128 add(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+inline __m128 sub(__m128 a, __m128 b) { return _mm_sub_ps(a, b); }
+inline __m128 mul(__m128 a, __m128 b) { return _mm_mul_ps(a, b); }
+template <>
+inline __m128 splat<__m128>(float a) { return _mm_set1_ps(a); }
+inline __m128 reciprocalOrOne(__m128 a) {
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 zero = _mm_cmpeq_ps(a, _mm_setzero_ps());
+    return _mm_or_ps(_mm_and_ps(zero, one), _mm_andnot_ps(zero, _mm_div_ps(one, a)));
+}
+#endif
+
+// Model matrix from position, quaternion and scale: translate * rotate * scale
+template <typename V>
+void composeLanes(const V& px, const V& py, const V& pz, const V& qx, const V& qy, const V& qz, const V& qw,
+                  const V& sx, const V& sy, const V& sz, V* m) {
+    V one = splat<V>(1.0f);
+    V zero = splat<V>(0.0f);
+    V x2 = add(qx, qx), y2 = add(qy, qy), z2 = add(qz, qz);
+    V xx = mul(qx, x2), yy = mul(qy, y2), zz = mul(qz, z2);
+    V xy = mul(qx, y2), xz = mul(qx, z2), yz = mul(qy, z2);
+    V wx = mul(qw, x2), wy = mul(qw, y2), wz = mul(qw, z2);
+
+    m[0] = mul(sub(one, add(yy, zz)), sx);
+    m[1] = mul(add(xy, wz), sx);
+    m[2] = mul(sub(xz, wy), sx);
+    m[3] = zero;
+    m[4] = mul(sub(xy, wz), sy);
+    m[5] = mul(sub(one, add(xx, zz)), sy);
+    m[6] = mul(add(yz, wx), sy);
+    m[7] = zero;
+    m[8] = mul(add(xz, wy), sz);
+    m[9] = mul(sub(yz, wx), sz);
+    m[10] = mul(sub(one, add(xx, yy)), sz);
+    m[11] = zero;
+    m[12] = px;
+    m[13] = py;
+    m[14] = pz;
+    m[15] = one;
+}
+
+// Normal matrix (three vec4 columns) from an affine model matrix m
+template <typename V>
+void normalLanes(const V* m, V* n) {
+    V zero = splat<V>(0.0f);
+
+    // Inverse transpose of the 3x3: its columns are the cross products of the model's columns over the determinant
+    n[0] = sub(mul(m[5], m[10]), mul(m[6], m[9]));
+    n[1] = sub(mul(m[6], m[8]), mul(m[4], m[10]));
+    n[2] = sub(mul(m[4], m[9]), mul(m[5], m[8]));
+    n[4] = sub(mul(m[9], m[2]), mul(m[10], m[1]));
+    n[5] = sub(mul(m[10], m[0]), mul(m[8], m[2]));
+    n[6] = sub(mul(m[8], m[1]), mul(m[9], m[0]));
+    n[8] = sub(mul(m[1], m[6]), mul(m[2], m[5]));
+    n[9] = sub(mul(m[2], m[4]), mul(m[0], m[6]));
+    n[10] = sub(mul(m[0], m[5]), mul(m[1], m[4]));
+
+    // A singular matrix keeps the unscaled cofactors instead of dividing by zero
+    V invDet = reciprocalOrOne(add(add(mul(m[0], n[0]), mul(m[1], n[1])), mul(m[2], n[2])));
+    for (int column = 0; column < 3; column++) {
+        for (int row = 0; row < 3; row++) {
+            n[column * 4 + row] = mul(n[column * 4 + row], invDet);
+        }
+        n[column * 4 + 3] = zero;
+    }
+}
+
+// Model-view-projection from an affine model matrix m
+template <typename V>
+void clipLanes(const float* viewProjection, const V* m, V* mvp) {
+    // The model's bottom row is (0, 0, 0, 1), so each column needs three products
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 4; row++) {
+            V sum = add(add(mul(splat<V>(viewProjection[row]), m[column * 4]),
+                            mul(splat<V>(viewProjection[4 + row]), m[column * 4 + 1])),
+                        mul(splat<V>(viewProjection[8 + row]), m[column * 4 + 2]));
+            mvp[column * 4 + row] = column == 3 ? add(sum, splat<V>(viewProjection[12 + row])) : sum;
+        }
+    }
+}
+
+// Normal matrix and model-view-projection from the model matrix in the first 16 outputs
+template <typename V>
+void deriveLanes(const float* viewProjection, V* out) {
+    normalLanes(out, out + NORMAL_OFFSET);
+    clipLanes(viewProjection, out, out + MVP_OFFSET);
+}
+
+// Column-major product of two affine matrices: out = a * b
+void multiplyAffine(const float* a, const float* b, float* out) {
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 3; row++) {
+            float sum = a[row] * b[column * 4] + a[4 + row] * b[column * 4 + 1] + a[8 + row] * b[column * 4 + 2];
+            out[column * 4 + row] = column == 3 ? sum + a[12 + row] : sum;
+        }
+        out[column * 4 + 3] = column == 3 ? 1.0f : 0.0f;
+    }
+}
+
+} // namespace
+
+TransformBatch::TransformBatch() : m_count(0), m_simdEnabled(true) {
+}
+
+void TransformBatch::clear() {
+    m_count = 0;
+}
+
+size_t TransformBatch::add(const float* position, const float* rotation, const float* scale) {
+    // Inputs always cover this object's whole group; unused lanes are computed and ignored
+    size_t padded = (m_count / LANES + 1) * LANES;
+    const float values[INPUT_COUNT] = {position[0], position[1], position[2], rotation[0], rotation[1],
+                                       rotation[2], rotation[3], scale[0], scale[1], scale[2]};
+    for (int k = 0; k < INPUT_COUNT; k++) {
+        if (m_inputs[k].size() < padded) {
+            m_inputs[k].resize(padded, 0.0f);
+        }
+        m_inputs[k][m_count] = values[k];
+    }
+    if (m_transforms.size() < padded) {
+        m_transforms.resize(padded);
+    }
+    return m_count++;
+}
+
+void TransformBatch::set(size_t index, const float* position, const float* rotation, const float* scale) {
+    const float values[INPUT_COUNT] = {position[0], position[1], position[2], rotation[0], rotation[1],
+                                       rotation[2], rotation[3], scale[0], scale[1], scale[2]};
+    for (int k = 0; k < INPUT_COUNT; k++) {
+        m_inputs[k][index] = values[k];
+    }
+}
+
+void TransformBatch::remove(size_t index) {
+    size_t last = m_count - 1;
+    for (int k = 0; k < INPUT_COUNT; k++) {
+        m_inputs[k][index] = m_inputs[k][last];
+    }
+    m_transforms[index] = m_transforms[last];
+    m_count = last;
+}
+
+void TransformBatch::getInputs(size_t index, float* position, float* rotation, float* scale) const {
+    for (int k = 0; k < 3; k++) {
+        position[k] = m_inputs[PX + k][index];
+        scale[k] = m_inputs[SX + k][index];
+    }
+    for (int k = 0; k < 4; k++) {
+        rotation[k] = m_inputs[QX + k][index];
+    }
+}
+
+bool TransformBatch::isSimdEnabled() const {
+#ifdef TRANSFORMBATCH_SSE2
+    return m_simdEnabled;
+#else
+    return false;
+#endif
+}
+
+void TransformBatch::compute(const float* viewProjection) {
+    size_t groups = (m_count + LANES - 1) / LANES;
+    if (isSimdEnabled()) {
+        for (size_t group = 0; group < groups; group++) {
+            computeGroup(group * LANES, viewProjection);
+        }
+    } else {
+        for (size_t i = 0; i < m_count; i++) {
+            computeScalar(i, viewProjection);
+        }
+    }
+}
+
+void TransformBatch::updateWorld(size_t index, const float* parentWorld) {
+    float position[3], rotation[4], scale[3], local[16];
+    getInputs(index, position, rotation, scale);
+    composeModel(position, rotation, scale, local);
+
+    ObjectTransform& transform = m_transforms[index];
+    if (parentWorld) {
+        multiplyAffine(parentWorld, local, transform.model);
+    } else {
+        std::memcpy(transform.model, local, sizeof(local));
+    }
+    normalLanes(transform.model, transform.normal);
+}
+
+void TransformBatch::computeClip(const uint32_t* indices, size_t count, const float* viewProjection) {
+    size_t i = 0;
+#ifdef TRANSFORMBATCH_SSE2
+    if (m_simdEnabled) {
+        for (; i + LANES <= count; i += LANES) {
+            ObjectTransform* group[LANES];
+            for (size_t lane = 0; lane < LANES; lane++) {
+                group[lane] = &m_transforms[indices[i + lane]];
+            }
+
+            // Gather the four model matrices one element per register, as compute works on them
+            __m128 m[16], mvp[16];
+            for (int k = 0; k < 16; k += 4) {
+                __m128 r0 = _mm_loadu_ps(group[0]->model + k), r1 = _mm_loadu_ps(group[1]->model + k);
+                __m128 r2 = _mm_loadu_ps(group[2]->model + k), r3 = _mm_loadu_ps(group[3]->model + k);
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                m[k] = r0;
+                m[k + 1] = r1;
+                m[k + 2] = r2;
+                m[k + 3] = r3;
+            }
+            clipLanes(viewProjection, m, mvp);
+            for (int k = 0; k < 16; k += 4) {
+                __m128 r0 = mvp[k], r1 = mvp[k + 1], r2 = mvp[k + 2], r3 = mvp[k + 3];
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                _mm_storeu_ps(group[0]->modelViewProjection + k, r0);
+                _mm_storeu_ps(group[1]->modelViewProjection + k, r1);
+                _mm_storeu_ps(group[2]->modelViewProjection + k, r2);
+                _mm_storeu_ps(group[3]->modelViewProjection + k, r3);
+            }
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        ObjectTransform& transform = m_transforms[indices[i]];
+        clipLanes(viewProjection, transform.model, transform.modelViewProjection);
+    }
+}
+
+void TransformBatch::composeModel(const float* position, const float* rotation, const float* scale,
+                                  float* matrix) {
+    composeLanes(position[0], position[1], position[2], rotation[0], rotation[1], rotation[2], rotation[3],
+                 scale[0], scale[1], scale[2], matrix);
+}
+
+void TransformBatch::computeScalar(size_t index, const float* viewProjection) {
+    float in[INPUT_COUNT];
+    for (int k = 0; k < INPUT_COUNT; k++) {
+        in[k] = m_inputs[k][index];
+    }
+    float out[OUTPUT_COUNT];
+    composeLanes(in[PX], in[PY], in[PZ], in[QX], in[QY], in[QZ], in[QW], in[SX], in[SY], in[SZ], out);
+    deriveLanes(viewProjection, out);
+    std::memcpy(&m_transforms[index], out, sizeof(out));
+}
+
+void TransformBatch::computeGroup(size_t first, const float* viewProjection) {
+#ifdef TRANSFORMBATCH_SSE2
+    __m128 in[INPUT_COUNT];
+    for (int k = 0; k < INPUT_COUNT; k++) {
+        in[k] = _mm_loadu_ps(m_inputs[k].data() + first);
+    }
+    __m128 out[OUTPUT_COUNT];
+    composeLanes(in[PX], in[PY], in[PZ], in[QX], in[QY], in[QZ], in[QW], in[SX], in[SY], in[SZ], out);
+    deriveLanes(viewProjection, out);
+
+    // Each register holds one matrix element of four objects; transpose runs of four into per-object order
+    float* base = reinterpret_cast<float*>(&m_transforms[first]);
+    for (size_t k = 0; k < OUTPUT_COUNT; k += 4) {
+        __m128 r0 = out[k], r1 = out[k + 1], r2 = out[k + 2], r3 = out[k + 3];
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        _mm_storeu_ps(base + k, r0);
+        _mm_storeu_ps(base + OUTPUT_COUNT + k, r1);
+        _mm_storeu_ps(base + 2 * OUTPUT_COUNT + k, r2);
+        _mm_storeu_ps(base + 3 * OUTPUT_COUNT + k, r3);
+    }
+#else
+    for (size_t i = first; i < first + LANES && i < m_count; i++) {
+        computeScalar(i, viewProjection);
+    }
+#endif
+}